@@ -0,0 +1,38 @@
+#version 330 core
+
+in vec2 vUV;
+out vec4 FragColor;
+
+// R32F layer counts written by the overdraw pass.
+uniform sampler2D uCounts;
+// Layer count mapped to the hot end of the ramp.
+uniform float uMaxLayers;
+uniform float uOpacity;
+
+vec3 Ramp(float t)
+{
+    // black -> blue -> green -> yellow -> red -> white
+    const vec3 c0 = vec3(0.0, 0.0, 0.0);
+    const vec3 c1 = vec3(0.0, 0.2, 1.0);
+    const vec3 c2 = vec3(0.0, 1.0, 0.2);
+    const vec3 c3 = vec3(1.0, 1.0, 0.0);
+    const vec3 c4 = vec3(1.0, 0.1, 0.0);
+    const vec3 c5 = vec3(1.0, 1.0, 1.0);
+
+    float x = clamp(t, 0.0, 1.0) * 5.0;
+    if (x < 1.0) return mix(c0, c1, x);
+    if (x < 2.0) return mix(c1, c2, x - 1.0);
+    if (x < 3.0) return mix(c2, c3, x - 2.0);
+    if (x < 4.0) return mix(c3, c4, x - 3.0);
+    return mix(c4, c5, x - 4.0);
+}
+
+void main()
+{
+    float layers = texture(uCounts, vUV).r;
+    if (layers < 0.5) {
+        discard;
+    }
+
+    FragColor = vec4(Ramp(layers / max(uMaxLayers, 1.0)), uOpacity);
+}
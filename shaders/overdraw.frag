@@ -0,0 +1,35 @@
+#version 330 core
+
+// Overdraw counting pass: every surviving fragment adds 1.0 to an R32F target
+// (additive blending). Uniforms mirror particle.frag so the same renderer code
+// can drive both programs.
+in vec4 vColor;
+
+out vec4 FragColor;
+
+uniform sampler2D uTexture;
+uniform bool uHasTexture;
+uniform bool uUseMask;
+
+// Fragments whose final alpha is below this threshold are discarded, exactly like
+// the regular pass. Use a negative value for programs that never discard (trails).
+uniform float uAlphaDiscard;
+
+void main()
+{
+    // Same alpha as particle.frag (untextured sprites end up fully transparent there too).
+    vec4 texColor = vec4(1.0, 1.0, 1.0, 0.0);
+    if (uHasTexture) {
+        texColor = texColor + texture(uTexture, gl_PointCoord) * vec4(0.0, 0.0, 0.0, 1.0);
+        if (uUseMask) {
+            texColor.a = texColor.r;
+        }
+    }
+    float alpha = vColor.a * texColor.a;
+
+    if (alpha < uAlphaDiscard) {
+        discard;
+    }
+
+    FragColor = vec4(1.0, 0.0, 0.0, 0.0);
+}
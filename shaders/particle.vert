@@ -6,10 +6,15 @@ layout (location = 2) in float aSize;
 
 out vec4 vColor;
 
+// Shared per-frame camera data (see FrameUniforms.h)
+layout(std140) uniform FrameUniforms
+{
+    mat4 view;
+    mat4 projection;
+    vec4 cameraPos; // xyz
+};
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-uniform vec3 uCameraPos;
 
 void main()
 {
@@ -23,7 +28,7 @@ void main()
     // gl_PointSize = aSize;
     
     // Option 2: Taille adaptée à la distance (décommenter si souhaité)
-    float dist = max(length(aPos - uCameraPos), 0.1); // éviter division par 0
+    float dist = max(length(aPos - cameraPos.xyz), 0.1); // éviter division par 0
     float scaleFactor = 1.0; // ajuster selon vos besoins
     gl_PointSize = aSize * scaleFactor / dist;
 }
@@ -5,9 +5,15 @@ layout(location = 1) in vec4 aColor;
 
 out vec4 vColor;
 
+// Shared per-frame camera data (see FrameUniforms.h)
+layout(std140) uniform FrameUniforms
+{
+    mat4 view;
+    mat4 projection;
+    vec4 cameraPos; // xyz
+};
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
 
 void main()
 {
@@ -1,8 +1,12 @@
 ﻿#include "Application.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
 
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/matrix_inverse.hpp>
@@ -12,6 +16,7 @@
 #include "../fireworks/shapes/ShapeRegistry.h"
 #include "../ui/EditorMode.h"
 #include "../ui/panels/template_editor/TemplatePropertiesPanel.h"
+#include "../serialization/FireworkSerialization.h"
 
 // file-scope pointer
 static ShapeRegistry* g_shapeRegistry = nullptr;
@@ -29,6 +34,13 @@ Application::Application()
     , templateRotationController(nullptr)
     , inputRouter(nullptr)
     , uiManager(nullptr)
+    , profiler(nullptr)
+    , overdrawView(nullptr)
+    , frameUniforms(nullptr)
+    , simulation(nullptr)
+    , previewWorker(nullptr)
+    , previewCache(nullptr)
+    , taskGraph(nullptr)
     , shader(nullptr)
     , trailShader(nullptr)
     , particlePool(nullptr)
@@ -36,13 +48,30 @@ Application::Application()
     , instanceManager(nullptr)
     , scene(nullptr)
     , timeline(nullptr)
+    , eventCopiesSceneVersion(0)
+    , eventCopiesLibraryVersion(0)
     , lastTimelinePlaying(false)
     , scenePreviewKey(0)
     , scenePreviewValid(false)
+    , scenePreviewBakedPosition(0.0f, 0.0f, 0.0f)
+    , scenePreviewContent(0)
     , templatePreviewKey(0)
     , templatePreviewValid(false)
     , templatePreviewVersion(0)
     , templatePreviewBakedRotation(0.0f, 0.0f, 0.0f)
+    , templatePreviewBakedPosition(0.0f, 0.0f, 0.0f)
+    , templatePreviewContent(0)
+    , previewInsertPending(false)
+    , previewInsertContent(0)
+    , previewInsertRotation(0.0f, 0.0f, 0.0f)
+    , previewInsertPosition(0.0f, 0.0f, 0.0f)
+    , previewInsertSince(0.0f)
+    , renderOnDemand(true)
+    , idleFrames(0)
+    , inputEventSerial(0)
+    , lastRenderedPoolVersion(0)
+    , lastRenderedView(1.0f)
+    , lastRenderedModel(1.0f)
 {
 }
 
@@ -94,6 +123,16 @@ bool Application::InitializeShaderAndRenderer()
     trailShader = new Shader("../shaders/trail.vert", "../shaders/trail.frag");
     trailRenderer = new TrailRenderer(trailShader);
 
+    // Camera matrices shared by every program (particles, trails, overdraw counting).
+    frameUniforms = new FrameUniforms();
+    if (!frameUniforms->initialize())
+    {
+        std::cerr << "Failed to initialize frame uniforms\n";
+        return false;
+    }
+    renderer->SetFrameUniforms(frameUniforms);
+    trailRenderer->SetFrameUniforms(frameUniforms);
+
     if (!renderer->initialize())
     {
         std::cerr << "Failed to initialize particle renderer\n";
@@ -112,6 +151,17 @@ bool Application::InitializeShaderAndRenderer()
     }
     trailRenderer->SetAspectRatio(aspectRatio);
 
+    profiler = new Profiler();
+
+    // Debug view only: a failure here must not prevent the editor from starting.
+    overdrawView = new OverdrawView();
+    if (!overdrawView->initialize())
+    {
+        std::cerr << "Warning: overdraw view unavailable\n";
+        delete overdrawView;
+        overdrawView = nullptr;
+    }
+
     if (!g_shapeRegistry) {
         g_shapeRegistry = new ShapeRegistry();
         if (!g_shapeRegistry->Initialize()) {
@@ -140,10 +190,28 @@ void Application::InitializeFireworkTemplates()
     templateLibrary = new TemplateLibrary();
     templateLibrary->SeedPresets();
 
+    taskGraph = new TaskGraph();
+
     instanceManager = new InstanceManager();
+    // Finale cues: the particles of every instance triggering in a step are filled in parallel
+    // by the frame workers (the simulation thread helps while it waits).
+    instanceManager->SetEmissionThreads(taskGraph->GetWorkerCount() + 1);
+    instanceManager->SetEmissionParallelFor([this](size_t count, const std::function<void(size_t, size_t)>& body) {
+        taskGraph->ParallelFor(0, count, 1, body);
+    });
 
     scene = new Scene("Untitled Scene");
     timeline = new Timeline();
+
+    // Started by Run(); until then (and for exports) commands apply immediately.
+    simulation = new SimulationThread(*instanceManager, *particlePool);
+
+    // Template previews are a single firework: a fraction of the main pool is plenty.
+    previewWorker = new PreviewWorker(200000);
+
+    // Missing or from another build: start empty.
+    previewCache = new PreviewCache(kPreviewCacheBytes);
+    previewCache->Load(kPreviewCachePath);
 }
 
 bool Application::InitializeUI()
@@ -160,6 +228,7 @@ bool Application::InitializeUI()
     // Panels
     uiManager->CreateTemplatePanels(templateLibrary);
     uiManager->CreateScenePanels(scene, timeline, templateLibrary);
+    if (particlePool) uiManager->SetPoolCapacity(particlePool->GetCapacity());
 
     // Configurer le callback de test d'explosion
     auto* panel = uiManager->GetTemplatePanel();
@@ -172,17 +241,17 @@ bool Application::InitializeUI()
             }
             // Ensure we don't mix idle preview state with a live test.
             templatePreviewValid = false;
-            if (instanceManager) instanceManager->Clear();
-            if (particlePool) particlePool->ClearAll();
+            previewInsertPending = false;
+            if (previewWorker) previewWorker->Cancel();
             // Immediate start: the template editor's "Test" should be responsive.
-            auto* instance = new FireworkInstance(active, glm::vec3(0.0f, 0.0f, 0.0f), now);
-            instanceManager->AddInstance(instance);
+            simulation->Clear();
+            simulation->Spawn(active, glm::vec3(0.0f, 0.0f, 0.0f), now);
             std::cerr << "[UI] Test explosion triggered (instance added)\n";
             });
 
-        // Any template edit invalidates the idle preview cache.
+        // Any template edit invalidates the idle preview cache. The current preview stays
+        // frozen on screen until the rebuilt one is ready.
         panel->SetOnTemplateChangedCallback([this](const FireworkTemplate&) {
-            templatePreviewValid = false;
             ++templatePreviewVersion;
         });
     }
@@ -220,15 +289,65 @@ void Application::SetupGLStates()
 
 int Application::Run()
 {
+    // On-demand rendering: after kIdleGraceFrames frames without any change, sleep until an
+    // event arrives (or the timeout elapses) instead of redrawing an identical frame.
+    constexpr int kIdleGraceFrames = 3;
+    constexpr double kIdleWaitSeconds = 0.5;
+
     float lastTime = static_cast<float>(glfwGetTime());
 
+    // Frame N+1 is simulated on the worker while this thread renders frame N.
+    simulation->Start();
+
     while (!window.ShouldClose())
     {
+        // Join the step kicked last frame. From here until Kick() the worker is idle, so input
+        // callbacks, UI edits and previews may touch templates, instances and the pool.
+        {
+            Profiler::ScopedSection section(profiler, "sim.wait");
+            simulation->WaitIdle();
+        }
+
+        if (renderOnDemand && idleFrames >= kIdleGraceFrames) {
+            const uint64_t serialBefore = inputEventSerial;
+            const double waitStart = glfwGetTime();
+            window.WaitEvents(kIdleWaitSeconds);
+            const double waited = glfwGetTime() - waitStart;
+
+            // Time spent asleep is not simulation time.
+            lastTime = static_cast<float>(glfwGetTime());
+
+            const bool woken = inputEventSerial != serialBefore
+                || (uiManager && uiManager->HasPendingInput())
+                || waited < kIdleWaitSeconds;
+            if (!woken) continue;
+
+            // Redraw a few frames so ImGui hover / release states settle.
+            idleFrames = 0;
+        }
+        else {
+            window.PollEvents();
+        }
+
+        // No command is queued yet: the instances are exactly those of the last step.
+        ReleaseUnusedEventCopies();
+
         float now = static_cast<float>(glfwGetTime());
         float delta = now - lastTime;
         lastTime = now;
 
-        window.PollEvents();
+        // Anything below that changes what is on screen marks the frame as active.
+        bool frameActive = false;
+
+        if (profiler) profiler->BeginFrame();
+        taskGraph->BeginFrame();
+
+        // Shape textures decode in the background; upload a few per frame.
+        if (g_shapeRegistry) {
+            Profiler::ScopedSection section(profiler, "textures.upload");
+            g_shapeRegistry->PumpUploads();
+            if (profiler) profiler->SetCounter("textures.pending", static_cast<double>(g_shapeRegistry->PendingCount()));
+        }
 
         // Start ImGui frame
         uiManager->NewFrame();
@@ -237,54 +356,61 @@ int Application::Run()
         if (timeline && scene && uiManager && uiManager->GetMode() == EditorMode::Scene) {
             // If we just switched to Play, discard any preview state so playback is deterministic.
             const bool playingNow = timeline->IsPlaying();
-            if (!lastTimelinePlaying && playingNow) {
-                if (instanceManager) instanceManager->Clear();
-                if (particlePool) particlePool->ClearAll();
+            float prev = timeline->GetLastDispatchedTime();
+            // A scrub while playing moves the dispatch point away from where we left it.
+            const bool seeked = lastTimelinePlaying && playingNow && prev != sceneCursor.time;
+            if ((!lastTimelinePlaying && playingNow) || seeked) {
+                simulation->Clear();
+                // Clear() also dropped the simulation's mute / solo state, and the journal only
+                // carries later edits: resend every event's state before reconstructing.
+                playbackEventState.clear();
+                RescanPlaybackEvents();
                 scenePreviewValid = false;
+                ReconstructSceneAt(prev, now, delta);
             }
             lastTimelinePlaying = playingNow;
+            if (playingNow) frameActive = true;
 
-            float prev = timeline->GetLastDispatchedTime();
             float duration = scene->GetDuration();
             timeline->Update(delta, duration);
             float cur = timeline->GetTime();
             if (timeline->IsPlaying()) {
-                const auto& events = scene->GetEvents();
-                for (const auto& e : events) {
-                    if (!e.enabled) continue;
-                    if (e.triggerTime > prev && e.triggerTime <= cur) {
-                        if (instanceManager && templateLibrary) {
-                            FireworkTemplate* t = templateLibrary->Get(e.templateId);
-                            if (t) {
-                                auto* inst = new FireworkInstance(t, e.position, now);
-                                instanceManager->AddInstance(inst);
-                            }
-                        }
-                    }
-                }
+                DispatchSceneEvents(prev, cur, now);
                 timeline->SetLastDispatchedTime(cur);
             }
         }
 
         // --- Paroxysm preview in Scene mode (no need to press Play) ---
-        // Rebuild only when selection/template/position changes.
+        // Rebuild only when the selection or its template changes (moves reuse the snapshot).
         if (uiManager && uiManager->GetMode() == EditorMode::Scene && timeline && !timeline->IsPlaying()) {
             const uint64_t key = ComputeScenePreviewKey();
             if (!scenePreviewValid || key != scenePreviewKey) {
                 scenePreviewKey = key;
-                RebuildSceneParoxysmPreview(now);
+                RequestSceneParoxysmPreview(now);
+                frameActive = true;
+            }
+
+            // Swap the finished preview in (replaces the previous one in a single step).
+            glm::vec3 bakedRotation(0.0f);
+            if (scenePreviewValid && previewWorker->TakeResult(*particlePool, bakedRotation, scenePreviewBakedPosition)) {
+                QueuePreviewInsert(scenePreviewContent, bakedRotation, scenePreviewBakedPosition, now);
+                frameActive = true;
             }
+            SettlePreviewInsert(now, scenePreviewValid);
+            if (previewWorker->IsBusy() || previewInsertPending) frameActive = true;
         }
 
         // --- Idle preview in Template mode (no need to press "Test") ---
-        // Only when nothing is currently happening (no live particles/instances).
+        // Built by previewWorker; requested when nothing is happening (no live particles/instances)
+        // or when the template changes under a frozen preview.
         if (uiManager && uiManager->GetMode() == EditorMode::Template && particlePool && instanceManager) {
             const bool idle = (particlePool->GetActiveCount() == 0 && instanceManager->GetActiveCount() == 0);
-            if (idle) {
+            if (idle || (templatePreviewValid && instanceManager->GetActiveCount() == 0)) {
                 const uint64_t key = ComputeTemplatePreviewKey();
                 if (!templatePreviewValid || key != templatePreviewKey) {
                     templatePreviewKey = key;
-                    RebuildTemplateParoxysmPreview(now);
+                    RequestTemplateParoxysmPreview(now);
+                    frameActive = true;
                 }
             } else {
 				// If particles are present but there are no active instances, this is our frozen
@@ -292,69 +418,494 @@ int Application::Run()
 				// Only invalidate when a live test is running (instances > 0).
 				if (instanceManager->GetActiveCount() > 0) {
 					templatePreviewValid = false;
+					previewWorker->Cancel();
+					previewInsertPending = false;
 				}
             }
+
+            // Swap the finished preview in (replaces the previous one in a single step).
+            if (templatePreviewValid && previewWorker->TakeResult(*particlePool, templatePreviewBakedRotation, templatePreviewBakedPosition)) {
+                QueuePreviewInsert(templatePreviewContent, templatePreviewBakedRotation, templatePreviewBakedPosition, now);
+                frameActive = true;
+            }
+            SettlePreviewInsert(now, templatePreviewValid);
+            // Keep polling while the worker is still building.
+            if (previewWorker->IsBusy() || previewInsertPending) frameActive = true;
+        }
+        else if (previewWorker && !(uiManager && uiManager->GetMode() == EditorMode::Scene && timeline && !timeline->IsPlaying())) {
+            previewWorker->Cancel();
+            previewInsertPending = false;
+        }
+
+        // Widgets run now, while the worker is idle: their edits (and spawn / clear commands)
+        // are picked up by the step kicked below.
+        PublishFrameStats();
+        {
+            Profiler::ScopedSection section(profiler, "ui.build");
+            uiManager->BuildFrame();
+        }
+        // A shared template edited for one scene event moves to that event's copy before
+        // any branch is rebuilt.
+        uiManager->ApplyTemplateCopyOnWrite();
+        // Template edits made by the widgets are coalesced: each template rebuilds its
+        // dirty branch stages at most once per frame, before the worker reads them.
+        if (templateLibrary && templateLibrary->UpdateDirtyBranches() > 0) frameActive = true;
+
+        // Event edits made during playback (delete / disable / mute / solo) reach the
+        // instances already in flight, not only future triggers.
+        if (timeline && timeline->IsPlaying() && uiManager->GetMode() == EditorMode::Scene) {
+            if (SyncPlaybackEvents()) frameActive = true;
         }
 
-        // Update all active firework instances
+        // Update all active firework instances (on the simulation thread)
         // Note: in Scene mode preview (paroxysm), we keep a frozen cache and do not advance simulation.
-        if (instanceManager && particlePool) {
+        {
             const bool inScenePreview = (uiManager && uiManager->GetMode() == EditorMode::Scene && timeline && !timeline->IsPlaying());
             const bool inTemplatePreview = (uiManager && uiManager->GetMode() == EditorMode::Template && templatePreviewValid && particlePool->GetActiveCount() > 0 && instanceManager->GetActiveCount() == 0);
-            if (!inScenePreview && !inTemplatePreview) {
-                instanceManager->Update(now, delta, *particlePool);
-                particlePool->Update(delta);
+            const bool simulate = !inScenePreview && !inTemplatePreview;
+            // Instances may still be waiting to launch with an empty pool.
+            if (simulate && instanceManager->GetActiveCount() > 0) frameActive = true;
+            // The preview transform the pool was baked with is published with its snapshot:
+            // the frame that draws it (next one) offsets it with matching values.
+            if (uiManager && uiManager->GetMode() == EditorMode::Template) {
+                simulation->Kick(now, delta, simulate, templatePreviewBakedRotation, templatePreviewBakedPosition);
+            }
+            else if (inScenePreview) {
+                simulation->Kick(now, delta, simulate, glm::vec3(0.0f), scenePreviewBakedPosition);
+            }
+            else {
+                simulation->Kick(now, delta, simulate);
             }
         }
 
+        // --- Worker running: from here on only the front snapshot is read. ---
+        const ParticlePool& shown = simulation->GetFrontSnapshot();
+        if (profiler) profiler->SetCounter("sim.stepMs", simulation->GetLastStepMs());
+
         // Render 3D
         glClearColor(0.1f, 0.1f, 0.15f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        
-// Global model transform used for frozen previews (so rotation can update in real time without resimulation)
-glm::mat4 modelMat(1.0f);
-if (uiManager && templateLibrary) {
-    const bool inTemplatePreview = (uiManager->GetMode() == EditorMode::Template && particlePool && particlePool->GetActiveCount() > 0 && instanceManager && instanceManager->GetActiveCount() == 0);
-    if (inTemplatePreview) {
-        const FireworkTemplate* t = templateLibrary->GetActive();
-        const glm::vec3 cur = t ? t->worldRotation : glm::vec3(0.0f);
-        const glm::vec3 baked = templatePreviewBakedRotation;
-
-        auto rotMat = [](const glm::vec3& eulerDeg) {
-            glm::mat4 m(1.0f);
-            m = glm::rotate(m, glm::radians(eulerDeg.y), glm::vec3(0.0f, 1.0f, 0.0f)); // Yaw
-            m = glm::rotate(m, glm::radians(eulerDeg.x), glm::vec3(1.0f, 0.0f, 0.0f)); // Pitch
-            m = glm::rotate(m, glm::radians(eulerDeg.z), glm::vec3(0.0f, 0.0f, 1.0f)); // Roll
-            return m;
-        };
-
-        // Apply only the delta between current rotation and the rotation baked into the snapshot.
-        modelMat = rotMat(cur) * glm::inverse(rotMat(baked));
-    }
-}
+        // Global model transform used for frozen previews (so rotation / position can update in real time without resimulation)
+        glm::mat4 modelMat(1.0f);
+        if (uiManager && templateLibrary) {
+            const bool inTemplatePreview = (uiManager->GetMode() == EditorMode::Template && !shown.GetAll().empty() && simulation->GetSnapshotInstanceCount() == 0);
+            if (inTemplatePreview) {
+                const FireworkTemplate* t = templateLibrary->GetActive();
+                const glm::vec3 cur = t ? t->worldRotation : glm::vec3(0.0f);
+                const glm::vec3 baked = simulation->GetSnapshotBakedRotation();
+
+                auto rotMat = [](const glm::vec3& eulerDeg) {
+                    glm::mat4 m(1.0f);
+                    m = glm::rotate(m, glm::radians(eulerDeg.y), glm::vec3(0.0f, 1.0f, 0.0f)); // Yaw
+                    m = glm::rotate(m, glm::radians(eulerDeg.x), glm::vec3(1.0f, 0.0f, 0.0f)); // Pitch
+                    m = glm::rotate(m, glm::radians(eulerDeg.z), glm::vec3(0.0f, 0.0f, 1.0f)); // Roll
+                    return m;
+                };
+
+                // Apply only the delta between current rotation and the rotation baked into the snapshot
+                // (about the point it was simulated at, brought back to the origin).
+                modelMat = rotMat(cur) * glm::inverse(rotMat(baked)) * glm::translate(glm::mat4(1.0f), -simulation->GetSnapshotBakedPosition());
+            }
 
-// Render particles
-        if (trailRenderer) {
-            trailRenderer->Render(*particlePool, camera, modelMat);
+            // Same idea for the frozen scene preview: follow the dragged event by translation.
+            const bool inScenePreview = (uiManager->GetMode() == EditorMode::Scene && scenePreviewValid && timeline && !timeline->IsPlaying());
+            if (inScenePreview && scene) {
+                const int sel = uiManager->GetSelectedSceneEventIndex();
+                const auto& events = scene->GetEvents();
+                if (sel >= 0 && sel < static_cast<int>(events.size())) {
+                    modelMat = glm::translate(glm::mat4(1.0f), events[static_cast<size_t>(sel)].position - simulation->GetSnapshotBakedPosition());
+                }
+            }
+        }
+
+        // CPU side of rendering as a task graph: particle packing and trail ribbons only read
+        // the front snapshot and do not depend on each other, so they overlap (and overlap the
+        // simulation step). GL uploads and draws stay on this thread below.
+        {
+            Profiler::ScopedSection section(profiler, "render.prepare");
+            if (renderer) taskGraph->Add("pack.particles", [this, &shown]() { renderer->Prepare(shown); });
+            if (trailRenderer) taskGraph->Add("build.trails", [this, &shown]() { trailRenderer->Prepare(shown, camera); });
+            taskGraph->Run();
+        }
+
+        // Render particles
+        {
+            Profiler::ScopedSection section(profiler, "render.particles");
+            if (trailRenderer) {
+                trailRenderer->Render(shown, camera, modelMat);
+            }
+            renderer->Render(shown, camera, modelMat);
+        }
+
+        // Overdraw heatmap: replay the particle draws into a count target and composite it.
+        if (overdrawView && trailRenderer && *uiManager->GetShowOverdrawFlag()) {
+            Profiler::ScopedSection section(profiler, "render.overdraw");
+            int fbWidth, fbHeight;
+            glfwGetFramebufferSize(window.GetWindow(), &fbWidth, &fbHeight);
+            overdrawView->RenderCounts(*renderer, *trailRenderer, shown, camera, modelMat, fbWidth, fbHeight);
+            overdrawView->DrawHeatmap(fbWidth, fbHeight);
+            overdrawView->DrawStatsWindow(uiManager->GetShowOverdrawFlag());
         }
-        renderer->Render(particlePool->GetAll(), camera, modelMat);
+
+        if (profiler) profiler->DrawWindow(uiManager->GetShowProfilerFlag());
 
         // Render ImGui
-        uiManager->Render();
+        {
+            Profiler::ScopedSection section(profiler, "render.ui");
+            uiManager->DrawFrame();
+        }
 
         window.SwapBuffers();
+
+        // Pool edits (simulation, previews), camera moves, rotation of a frozen preview.
+        const glm::mat4 view = camera.getViewMatrix();
+        if (shown.GetVersion() != lastRenderedPoolVersion) frameActive = true;
+        if (view != lastRenderedView || modelMat != lastRenderedModel) frameActive = true;
+        if (g_shapeRegistry && g_shapeRegistry->PendingCount() > 0) frameActive = true;
+        if (uiManager->WantsContinuousRedraw()) frameActive = true;
+
+        lastRenderedPoolVersion = shown.GetVersion();
+        lastRenderedView = view;
+        lastRenderedModel = modelMat;
+        idleFrames = frameActive ? 0 : idleFrames + 1;
+    }
+
+    simulation->Stop();
+    return 0;
+}
+
+int Application::RunExport(const std::string& scenePath, const FrameExporter::Settings& settings, float tailSeconds)
+{
+    if (!scene || !particlePool || !instanceManager || !renderer) return 1;
+
+    auto loaded = serialization::LoadScene(scenePath);
+    if (!loaded) {
+        std::cerr << "Export: cannot load scene " << scenePath << "\n";
+        return 1;
+    }
+    *scene = *loaded;
+
+    // Nothing is presented during an export.
+    glfwHideWindow(window.GetWindow());
+
+    instanceManager->Clear();
+    particlePool->ClearAll();
+
+    FrameExporter exporter;
+    if (!exporter.Begin(settings)) return 1;
+
+    const float exportAspect = static_cast<float>(settings.width) / static_cast<float>(settings.height);
+    renderer->SetAspectRatio(exportAspect);
+    if (trailRenderer) trailRenderer->SetAspectRatio(exportAspect);
+
+    const double frameDt = 1.0 / static_cast<double>(settings.fps);
+    const double totalSeconds = static_cast<double>(scene->GetDuration()) + static_cast<double>(std::max(0.0f, tailSeconds));
+    const int frameCount = std::max(1, static_cast<int>(std::ceil(totalSeconds * settings.fps)));
+
+    std::cout << "Exporting " << frameCount << " frames (" << settings.width << "x" << settings.height
+              << " @ " << settings.fps << " fps) to " << settings.outputPath << "\n";
+
+    const auto start = std::chrono::steady_clock::now();
+
+    // Events at exactly t = 0 must fire on the first frame.
+    float prevTime = -1.0f;
+    for (int frame = 0; frame < frameCount; ++frame) {
+        if (profiler) profiler->BeginFrame();
+
+        // Time is derived from the frame index so long exports never drift.
+        const float t = static_cast<float>(frame * frameDt);
+        const float dt = static_cast<float>(frameDt);
+
+        {
+            Profiler::ScopedSection section(profiler, "simulate");
+            DispatchSceneEvents(prevTime, t, t);
+            prevTime = t;
+            instanceManager->Update(t, dt, *particlePool);
+            particlePool->Update(dt);
+        }
+
+        {
+            Profiler::ScopedSection section(profiler, "render.particles");
+            exporter.BindTarget();
+            glClearColor(0.1f, 0.1f, 0.15f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            if (trailRenderer) trailRenderer->Render(*particlePool, camera);
+            renderer->Render(*particlePool, camera);
+        }
+
+        {
+            // Async: maps a frame rendered pboRingSize - 1 frames ago, encoding is off-thread.
+            Profiler::ScopedSection section(profiler, "export.readback");
+            exporter.EndFrame();
+        }
+
+        PublishFrameStats();
+        window.PollEvents();
+
+        if ((frame + 1) % settings.fps == 0 || frame + 1 == frameCount) {
+            std::cout << "  " << (frame + 1) << "/" << frameCount << "\r" << std::flush;
+        }
+    }
+
+    exporter.Finish();
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const FrameExporter::Stats stats = exporter.GetStats();
+    const double throughput = seconds > 0.0 ? stats.framesWritten / seconds : 0.0;
+
+    std::cout << "\nExported " << stats.framesWritten << " frames in " << seconds << " s ("
+              << throughput << " frames/s)\n";
+
+    if (profiler) {
+        profiler->SetCounter("export.framesPerSecond", throughput);
+        profiler->SetCounter("export.readbackStalls", stats.readbackStalls);
+        profiler->SetCounter("export.encoderWaits", stats.encoderWaits);
+        profiler->Dump(std::cout);
     }
 
+    // Back to the window aspect in case the editor keeps running.
+    int fbWidth, fbHeight;
+    glfwGetFramebufferSize(window.GetWindow(), &fbWidth, &fbHeight);
+    const float windowAspect = (fbHeight > 0) ? static_cast<float>(fbWidth) / static_cast<float>(fbHeight) : 16.0f / 9.0f;
+    renderer->SetAspectRatio(windowAspect);
+    if (trailRenderer) trailRenderer->SetAspectRatio(windowAspect);
+
+    if (stats.writeFailed) {
+        std::cerr << "Export: some frames could not be written\n";
+        return 1;
+    }
     return 0;
 }
 
+void Application::DispatchSceneEvents(float fromTime, float toTime, float now)
+{
+    if (!scene || !instanceManager || !templateLibrary) return;
+
+    // Only the events in the range are visited; a jump re-seeks the cursor.
+    const auto& events = scene->GetEvents();
+    scene->GetSchedule().Advance(sceneCursor, fromTime, toTime, [&](size_t index) {
+        const FireworkEvent& e = events[index];
+        if (!e.enabled) return;
+        FireworkTemplate* t = templateLibrary->Get(e.templateId);
+        if (t) {
+            // Queued for the simulation thread (applied immediately when it is not running).
+            simulation->Spawn(t, e.position, now, e.id, e.overrides);
+        }
+    });
+}
+
+void Application::ReconstructSceneAt(float t, float now, float delta)
+{
+    if (!scene || !templateLibrary || !simulation) return;
+    sceneLifetimes.Refresh(*scene, *templateLibrary);
+
+    // Events triggered exactly at t start here: DispatchSceneEvents only fires triggers after t.
+    const auto& events = scene->GetEvents();
+    float earliest = now;
+    sceneLifetimes.ForEachAlive(t, [&](size_t index) {
+        const FireworkEvent& e = events[index];
+        if (!e.enabled) return;
+        FireworkTemplate* tmpl = templateLibrary->Get(e.templateId);
+        if (!tmpl) return;
+        const float triggered = now - (t - e.triggerTime);
+        simulation->Spawn(tmpl, e.position, triggered, e.id, e.overrides);
+        earliest = std::min(earliest, triggered);
+    });
+
+    // The regular step of this frame covers the last `delta` seconds.
+    const float until = now - std::max(0.0f, delta);
+    const float step = std::max(kSeekStepSeconds, (until - earliest) / static_cast<float>(kSeekMaxSteps));
+    simulation->FastForward(earliest, until, step);
+}
+
+void Application::ReleaseUnusedEventCopies()
+{
+    if (!scene || !templateLibrary || !instanceManager) return;
+    if (scene->GetEditVersion() == eventCopiesSceneVersion
+        && templateLibrary->GetEditVersion() == eventCopiesLibraryVersion) {
+        return;
+    }
+
+    std::vector<int> unused;
+    for (int id : templateLibrary->GetIds()) {
+        if (!templateLibrary->IsEventCopy(id) || id == templateLibrary->GetActiveId()) continue;
+        const auto& events = scene->GetEvents();
+        const bool referenced = std::any_of(events.begin(), events.end(), [id](const FireworkEvent& e) {
+            return e.templateId == id;
+        });
+        if (!referenced) unused.push_back(id);
+    }
+
+    bool drawn = false;
+    for (int id : unused) {
+        const FireworkTemplate* t = templateLibrary->Get(id);
+        const auto& live = instanceManager->GetInstances();
+        if (std::any_of(live.begin(), live.end(), [t](const FireworkInstance* inst) { return inst->GetTemplate() == t; })) {
+            drawn = true; // still on screen: retried next frame
+            continue;
+        }
+        templateLibrary->Remove(id);
+    }
+
+    if (drawn) return;
+    eventCopiesSceneVersion = scene->GetEditVersion();
+    eventCopiesLibraryVersion = templateLibrary->GetEditVersion();
+}
+
+bool Application::SyncPlaybackEvents()
+{
+    if (!scene || !simulation) return false;
+
+    // Only the journaled edits are looked at; a frame without edits costs nothing.
+    const bool complete = scene->TakeStateEdits(playbackEdits);
+    bool changed = false;
+
+    for (const Scene::StateEdit& edit : playbackEdits) {
+        auto it = playbackEventState.find(edit.id);
+        const uint8_t previous = (it != playbackEventState.end()) ? it->second : static_cast<uint8_t>(kPlaybackEnabled);
+        if (edit.removed) {
+            simulation->KillSource(edit.id);
+            if (previous & (kPlaybackMuted | kPlaybackSolo)) simulation->SetSourceVisibility(edit.id, false, false);
+            if (it != playbackEventState.end()) playbackEventState.erase(it);
+            changed = true;
+            continue;
+        }
+        changed |= ApplyPlaybackState(edit.id, edit.enabled, edit.muted, edit.solo);
+    }
+
+    if (!complete) changed |= RescanPlaybackEvents();
+    return changed;
+}
+
+bool Application::ApplyPlaybackState(uint32_t id, bool enabled, bool muted, bool solo)
+{
+    uint8_t state = 0;
+    if (enabled) state |= kPlaybackEnabled;
+    if (muted) state |= kPlaybackMuted;
+    if (solo) state |= kPlaybackSolo;
+
+    auto it = playbackEventState.find(id);
+    const uint8_t previous = (it != playbackEventState.end()) ? it->second : static_cast<uint8_t>(kPlaybackEnabled);
+    bool changed = false;
+    if ((previous & kPlaybackEnabled) && !(state & kPlaybackEnabled)) {
+        simulation->KillSource(id);
+        changed = true;
+    }
+    if ((previous & (kPlaybackMuted | kPlaybackSolo)) != (state & (kPlaybackMuted | kPlaybackSolo))) {
+        simulation->SetSourceVisibility(id, muted, solo);
+        changed = true;
+    }
+    if (it != playbackEventState.end()) it->second = state;
+    else playbackEventState.emplace(id, state);
+    return changed;
+}
+
+bool Application::RescanPlaybackEvents()
+{
+    bool changed = false;
+    for (const auto& e : scene->GetEvents()) {
+        changed |= ApplyPlaybackState(e.id, e.enabled, e.muted, e.solo);
+        playbackEventState[e.id] |= kPlaybackSeen;
+    }
+
+    // Entries not seen above belong to deleted events (or to a replaced scene).
+    for (auto it = playbackEventState.begin(); it != playbackEventState.end();) {
+        if (!(it->second & kPlaybackSeen)) {
+            simulation->KillSource(it->first);
+            if (it->second & (kPlaybackMuted | kPlaybackSolo)) simulation->SetSourceVisibility(it->first, false, false);
+            it = playbackEventState.erase(it);
+            changed = true;
+            continue;
+        }
+        it->second = static_cast<uint8_t>(it->second & ~kPlaybackSeen);
+        ++it;
+    }
+    return changed;
+}
+
+void Application::PublishFrameStats()
+{
+    if (!profiler) return;
+
+    if (simulation && simulation->IsRunning()) {
+        // What is on screen: the last published snapshot (compact, so its size is the count).
+        profiler->SetCounter("particles.active", static_cast<double>(simulation->GetFrontSnapshot().GetAll().size()));
+        profiler->SetCounter("instances.active", static_cast<double>(simulation->GetSnapshotInstanceCount()));
+    }
+    else {
+        if (particlePool) profiler->SetCounter("particles.active", static_cast<double>(particlePool->GetActiveCount()));
+        if (instanceManager) profiler->SetCounter("instances.active", static_cast<double>(instanceManager->GetActiveCount()));
+    }
+    if (particlePool) {
+        profiler->SetCounter("particles.capacity", static_cast<double>(particlePool->GetCapacity()));
+    }
+    if (instanceManager) {
+        // Last step's budget decisions (the worker is idle while stats are published).
+        const ParticleBudget::Stats& b = instanceManager->GetBudget().GetStats();
+        profiler->SetCounter("budget.demand", static_cast<double>(b.demand));
+        profiler->SetCounter("budget.headroom", static_cast<double>(b.headroom));
+        profiler->SetCounter("budget.keepRatio", static_cast<double>(b.keepRatio));
+        profiler->SetCounter("budget.thinned", static_cast<double>(b.thinned));
+        profiler->SetCounter("budget.evicted", static_cast<double>(b.evicted));
+        profiler->SetCounter("budget.smokeDropped", static_cast<double>(b.smokeDropped));
+        profiler->SetCounter("budget.recursionDropped", static_cast<double>(b.recursionDropped));
+
+        if (previewCache) {
+            const PreviewCache::Stats& c = previewCache->GetStats();
+            profiler->SetCounter("previewCache.hits", static_cast<double>(c.hits));
+            profiler->SetCounter("previewCache.misses", static_cast<double>(c.misses));
+            profiler->SetCounter("previewCache.entries", static_cast<double>(c.entries));
+            profiler->SetCounter("previewCache.mb", static_cast<double>(c.bytes) / (1024.0 * 1024.0));
+        }
+
+        const EmissionBatch::Stats& e = instanceManager->GetEmissionStats();
+        profiler->SetCounter("emission.particles", static_cast<double>(e.particles));
+        profiler->SetCounter("emission.workers", static_cast<double>(e.workers));
+        profiler->SetCounter("emission.writeMs", e.writeMs);
+    }
+    if (taskGraph) {
+        // Share of the last frame each worker spent running tasks.
+        const std::vector<TaskGraph::WorkerStats>& workers = taskGraph->GetFrameStats();
+        profiler->SetCounter("tasks.workers", static_cast<double>(workers.size()));
+        for (size_t i = 0; i < workers.size(); ++i) {
+            const std::string prefix = "tasks.worker" + std::to_string(i);
+            profiler->SetCounter(prefix + ".occupancy", workers[i].occupancy);
+            profiler->SetCounter(prefix + ".tasks", static_cast<double>(workers[i].tasks));
+            profiler->SetCounter(prefix + ".steals", static_cast<double>(workers[i].steals));
+        }
+    }
+    if (overdrawView && uiManager && *uiManager->GetShowOverdrawFlag()) {
+        const OverdrawView::Stats& s = overdrawView->GetStats();
+        profiler->SetCounter("overdraw.avgLayers", s.avgLayers);
+        profiler->SetCounter("overdraw.avgLayersCovered", s.avgLayersCovered);
+        profiler->SetCounter("overdraw.maxLayers", s.maxLayers);
+        profiler->SetCounter("overdraw.fragments", s.fragments);
+    }
+}
+
 static inline uint64_t HashCombine64(uint64_t h, uint64_t v)
 {
     // 64-bit variant of boost::hash_combine
     return h ^ (v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
 }
 
+// Mixes an event's overrides into h. Identity overrides leave h unchanged: plain events
+// share their template's keys (and cached previews) with Template mode.
+static uint64_t HashOverride(uint64_t h, const TemplateOverride& o)
+{
+    if (o.IsIdentity()) return h;
+    const float values[] = { o.rotation.x, o.rotation.y, o.rotation.z, o.tint.r, o.tint.g, o.tint.b, o.tint.a,
+                             o.scale, std::min(o.countScale, 1.0f) };
+    for (float v : values) {
+        uint32_t bits = 0;
+        std::memcpy(&bits, &v, sizeof(bits));
+        h = HashCombine64(h, bits);
+    }
+    return h;
+}
+
 uint64_t Application::ComputeScenePreviewKey() const
 {
     if (!uiManager || !scene) return 0;
@@ -371,20 +922,22 @@ uint64_t Application::ComputeScenePreviewKey() const
     h = HashCombine64(h, static_cast<uint64_t>(e.templateId));
     h = HashCombine64(h, static_cast<uint64_t>(e.enabled ? 1 : 0));
 
-    // Quantize position to avoid rebuilds from tiny float jitter.
-    auto q = [](float x) -> int32_t { return static_cast<int32_t>(std::round(x * 1000.0f)); };
-    h = HashCombine64(h, static_cast<uint64_t>(static_cast<uint32_t>(q(e.position.x))));
-    h = HashCombine64(h, static_cast<uint64_t>(static_cast<uint32_t>(q(e.position.y))));
-    h = HashCombine64(h, static_cast<uint64_t>(static_cast<uint32_t>(q(e.position.z))));
+    // Position is left out: a moved event reuses the snapshot, offset by the model matrix.
+    // Template edits (shape, rotation, ...) show up as a new branches version.
+    if (templateLibrary) {
+        const FireworkTemplate* t = templateLibrary->Get(e.templateId);
+        h = HashCombine64(h, t ? t->GetBranchesVersion() : 0u);
+    }
 
-    return h;
+    return HashOverride(h, e.overrides);
 }
 
-void Application::RebuildSceneParoxysmPreview(float nowSeconds)
+void Application::RequestSceneParoxysmPreview(float nowSeconds)
 {
     scenePreviewValid = true;
+    previewInsertPending = false;
 
-    if (!instanceManager || !particlePool || !scene || !templateLibrary || !uiManager || !timeline) {
+    if (!instanceManager || !particlePool || !scene || !templateLibrary || !uiManager || !timeline || !previewWorker) {
         if (instanceManager) instanceManager->Clear();
         if (particlePool) particlePool->ClearAll();
         return;
@@ -395,48 +948,51 @@ void Application::RebuildSceneParoxysmPreview(float nowSeconds)
     const int sel = uiManager->GetSelectedSceneEventIndex();
     const auto& events = scene->GetEvents();
 
+    // Whatever playback left is frozen until the preview replaces it.
     instanceManager->Clear();
-    particlePool->ClearAll();
 
-    if (sel < 0 || sel >= static_cast<int>(events.size())) {
+    const FireworkEvent* e = (sel >= 0 && sel < static_cast<int>(events.size())) ? &events[static_cast<size_t>(sel)] : nullptr;
+    FireworkTemplate* t = (e && e->enabled) ? templateLibrary->Get(e->templateId) : nullptr;
+    if (!t) {
+        previewWorker->Cancel();
+        particlePool->ClearAll();
         return;
     }
 
-    const auto& e = events[static_cast<size_t>(sel)];
-    if (!e.enabled) return;
-
-    FireworkTemplate* t = templateLibrary->Get(e.templateId);
-    if (!t) return;
-
-    // Estimate a visually meaningful peak: after emission, around mid-life.
-    const float emission = std::max(0.0f, t->branchTemplate.emissionDuration);
-    const float life = std::max(0.0f, t->branchTemplate.lifetime);
-    float peakOffset = emission + 0.5f * life;
-
-    // Keep within a sane budget.
-    if (peakOffset < 0.1f) peakOffset = 0.1f;
-    if (peakOffset > 4.0f) peakOffset = 4.0f; // tighter cap to avoid stalls
-
-    const float startTime = nowSeconds - peakOffset;
-    auto* inst = new FireworkInstance(t, e.position, startTime);
-    instanceManager->AddInstance(inst);
-
-    // Simulate forward to "nowSeconds" with a bounded step count.
-    const float step = 1.0f / 30.0f;
-    const int maxSteps = 120;
-    int steps = static_cast<int>(std::ceil(peakOffset / step));
-    if (steps > maxSteps) steps = maxSteps;
-
-    float tcur = startTime;
-    const float target = nowSeconds;
-    for (int s = 0; s < steps; ++s) {
-        float dt = step;
-        if (tcur + dt > target) dt = std::max(0.0f, target - tcur);
-        instanceManager->Update(tcur + dt, dt, *particlePool);
-        particlePool->Update(dt);
-        tcur += dt;
-        if (dt <= 0.0f) break;
+    // Same template content baked before (here or in Template mode): reuse it, moved by the
+    // model matrix. The content key covers the rotation and overrides, so only the position
+    // can differ.
+    scenePreviewContent = HashOverride(serialization::HashTemplateContent(*t), e->overrides);
+    glm::vec3 bakedRotation(0.0f);
+    if (previewCache && previewCache->Find(scenePreviewContent, *particlePool, bakedRotation, scenePreviewBakedPosition)) {
+        previewWorker->Cancel();
+        return;
+    }
+
+    // Simulated off the UI thread; the previous preview stays on screen until TakeResult().
+    previewWorker->Request(*t, nowSeconds, e->position, e->overrides);
+}
+
+void Application::QueuePreviewInsert(uint64_t content, const glm::vec3& rotation, const glm::vec3& position, float nowSeconds)
+{
+    previewInsertPending = true;
+    previewInsertContent = content;
+    previewInsertRotation = rotation;
+    previewInsertPosition = position;
+    previewInsertSince = nowSeconds;
+}
+
+void Application::SettlePreviewInsert(float nowSeconds, bool previewShown)
+{
+    if (!previewInsertPending) return;
+    if (!previewShown) {
+        previewInsertPending = false;
+        return;
     }
+    // A slider still moving supersedes this preview before it settles: not worth a cache slot.
+    if (nowSeconds - previewInsertSince < kPreviewSettleSeconds) return;
+    previewInsertPending = false;
+    if (previewCache) previewCache->Insert(previewInsertContent, *particlePool, previewInsertRotation, previewInsertPosition);
 }
 
 uint64_t Application::ComputeTemplatePreviewKey() const
@@ -451,11 +1007,12 @@ uint64_t Application::ComputeTemplatePreviewKey() const
     return h;
 }
 
-void Application::RebuildTemplateParoxysmPreview(float nowSeconds)
+void Application::RequestTemplateParoxysmPreview(float nowSeconds)
 {
     templatePreviewValid = true;
+    previewInsertPending = false;
 
-    if (!instanceManager || !particlePool || !templateLibrary || !uiManager) {
+    if (!instanceManager || !particlePool || !templateLibrary || !uiManager || !previewWorker) {
         if (instanceManager) instanceManager->Clear();
         if (particlePool) particlePool->ClearAll();
         return;
@@ -463,51 +1020,43 @@ void Application::RebuildTemplateParoxysmPreview(float nowSeconds)
     if (uiManager->GetMode() != EditorMode::Template) return;
 
     FireworkTemplate* t = templateLibrary->GetActive();
-    templatePreviewBakedRotation = t ? t->worldRotation : glm::vec3(0.0f);
     if (!t) {
+        previewWorker->Cancel();
         instanceManager->Clear();
         particlePool->ClearAll();
         return;
     }
 
-    instanceManager->Clear();
-    particlePool->ClearAll();
-
-    // Estimate a visually meaningful peak: after emission, around mid-life.
-    const float emission = std::max(0.0f, t->branchTemplate.emissionDuration);
-    const float life = std::max(0.0f, t->branchTemplate.lifetime);
-    float peakOffset = emission + 0.5f * life;
+    // Seen before (this session or a previous one): no simulation at all.
+    templatePreviewContent = serialization::HashTemplateContent(*t);
+    if (previewCache->Find(templatePreviewContent, *particlePool, templatePreviewBakedRotation, templatePreviewBakedPosition)) {
+        previewWorker->Cancel();
+        return;
+    }
 
-    if (peakOffset < 0.1f) peakOffset = 0.1f;
-    if (peakOffset > 4.0f) peakOffset = 4.0f;
+    // The worker simulates a copy of the template; the pool is only touched by TakeResult().
+    previewWorker->Request(*t, nowSeconds);
+}
 
-    const float startTime = nowSeconds - peakOffset;
-    auto* inst = new FireworkInstance(t, glm::vec3(0.0f, 0.0f, 0.0f), startTime);
-    instanceManager->AddInstance(inst);
+void Application::Shutdown()
+{
+    // Joins the workers before the pool / instances they step go away.
+    delete simulation;
+    simulation = nullptr;
 
-    // Simulate forward to "nowSeconds" with a bounded step count.
-    const float step = 1.0f / 30.0f;
-    const int maxSteps = 120;
-    int steps = static_cast<int>(std::ceil(peakOffset / step));
-    if (steps > maxSteps) steps = maxSteps;
+    delete previewWorker;
+    previewWorker = nullptr;
 
-    float tcur = startTime;
-    const float target = nowSeconds;
-    for (int s = 0; s < steps; ++s) {
-        float dt = step;
-        if (tcur + dt > target) dt = std::max(0.0f, target - tcur);
-        instanceManager->Update(tcur + dt, dt, *particlePool);
-        particlePool->Update(dt);
-        tcur += dt;
-        if (dt <= 0.0f) break;
+    if (previewCache) {
+        if (!previewCache->Save(kPreviewCachePath)) std::cerr << "Could not write " << kPreviewCachePath << "\n";
+        delete previewCache;
+        previewCache = nullptr;
     }
 
-    // We don't want to keep an instance around for the idle preview.
-    instanceManager->Clear();
-}
+    // After the simulation thread: emission fills run on it.
+    delete taskGraph;
+    taskGraph = nullptr;
 
-void Application::Shutdown()
-{
     delete scenePlacementController;
     scenePlacementController = nullptr;
 
@@ -537,6 +1086,15 @@ void Application::Shutdown()
     delete trailRenderer;
     trailRenderer = nullptr;
 
+    delete frameUniforms;
+    frameUniforms = nullptr;
+
+    delete overdrawView;
+    overdrawView = nullptr;
+
+    delete profiler;
+    profiler = nullptr;
+
     delete shader;
     shader = nullptr;
 
@@ -570,29 +1128,38 @@ void Application::framebufferSizeCallback(GLFWwindow* glfwWindow, int width, int
     glViewport(0, 0, width, height);
 
     Application* app = static_cast<Application*>(glfwGetWindowUserPointer(glfwWindow));
+    if (app) ++app->inputEventSerial;
     if (app && app->renderer) {
         float aspectRatio = (height > 0) ? static_cast<float>(width) / static_cast<float>(height) : 16.0f / 9.0f;
         app->renderer->SetAspectRatio(aspectRatio);
+        // Both passes share the frame UBO: a stale trail aspect would re-upload it every frame.
+        if (app->trailRenderer) app->trailRenderer->SetAspectRatio(aspectRatio);
     }
 }
 
 void Application::mouseButtonCallback(GLFWwindow* w, int button, int action, int mods)
 {
     Application* app = static_cast<Application*>(glfwGetWindowUserPointer(w));
-    if (!app || !app->inputRouter) return;
+    if (!app) return;
+    ++app->inputEventSerial;
+    if (!app->inputRouter) return;
     app->inputRouter->DispatchMouseButton(w, button, action, mods);
 }
 
 void Application::cursorPosCallback(GLFWwindow* w, double xpos, double ypos)
 {
     Application* app = static_cast<Application*>(glfwGetWindowUserPointer(w));
-    if (!app || !app->inputRouter) return;
+    if (!app) return;
+    ++app->inputEventSerial;
+    if (!app->inputRouter) return;
     app->inputRouter->DispatchCursorPos(w, xpos, ypos);
 }
 
 void Application::scrollCallback(GLFWwindow* w, double xoffset, double yoffset)
 {
     Application* app = static_cast<Application*>(glfwGetWindowUserPointer(w));
-    if (!app || !app->inputRouter) return;
+    if (!app) return;
+    ++app->inputEventSerial;
+    if (!app->inputRouter) return;
     app->inputRouter->DispatchScroll(w, xoffset, yoffset);
 }
\ No newline at end of file
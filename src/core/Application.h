@@ -4,6 +4,7 @@
 #include <GLFW/glfw3.h>
 #include <iostream>
 #include <vector>
+#include <unordered_map>
 #include <glm/glm.hpp>
 #include <memory>
 
@@ -20,11 +21,20 @@
 #include "../fireworks/instance/InstanceManager.h"
 #include "../fireworks/template/TemplateLibrary.h"
 #include "../scene/Scene.h"
+#include "../scene/EventLifetimeIndex.h"
 #include "../scene/Timeline.h"
 #include "../scene/ScenePlacementController.h"
 #include "../fireworks/editor/TemplateRotationController.h"
 #include "../rendering/Shader.h"
 #include "../ui/UIManager.h"
+#include "Profiler.h"
+#include "SimulationThread.h"
+#include "PreviewWorker.h"
+#include "PreviewCache.h"
+#include "TaskGraph.h"
+#include "../rendering/OverdrawView.h"
+#include "../rendering/FrameExporter.h"
+#include "../rendering/FrameUniforms.h"
 
 // Forward declare UI manager
 class UIManager;
@@ -43,6 +53,27 @@ private:
     InputRouter* inputRouter;
     UIManager* uiManager;
 
+    // Debug / instrumentation
+    Profiler* profiler;
+    OverdrawView* overdrawView;
+
+    // Shared camera UBO (bound to FrameUniforms::kBindingPoint)
+    FrameUniforms* frameUniforms;
+
+    // Steps instanceManager / particlePool on a worker thread (see SimulationThread.h)
+    SimulationThread* simulation;
+
+    // Builds Template-mode previews off the UI thread
+    PreviewWorker* previewWorker;
+
+    // Baked previews by template content, shared by both modes and kept across sessions
+    PreviewCache* previewCache;
+    static constexpr size_t kPreviewCacheBytes = size_t(256) << 20;
+    static constexpr const char* kPreviewCachePath = "preview_cache.bin";
+
+    // Workers for the CPU stages of a frame (render preparation, emission fill)
+    TaskGraph* taskGraph;
+
     // State / Controllers
     Shader* shader;
     Shader* trailShader;
@@ -52,23 +83,78 @@ private:
 
     Scene* scene;
     Timeline* timeline;
+    // Where the last dispatch stopped in the scene's time-sorted schedule.
+    EventSchedule::Cursor sceneCursor;
+    // Event lifetimes, to rebuild the fireworks already in flight after a seek.
+    EventLifetimeIndex sceneLifetimes;
+
+    // Private template copies made for scene events (TemplateLibrary::IsEventCopy) are removed
+    // once no event references them. Only looked at when the scene or the library changed,
+    // or while a copy is still drawn by live instances.
+    uint64_t eventCopiesSceneVersion;
+    uint64_t eventCopiesLibraryVersion;
+    void ReleaseUnusedEventCopies();
+
+    // Scene playback: per event id, the state last sent to the simulation (enabled / muted /
+    // solo bits). The scene's state journal is applied every frame so deleting, disabling,
+    // muting or soloing an event reaches its live instances in the same frame; all events
+    // are rescanned only when the journal was incomplete (new or loaded scene).
+    enum : uint8_t { kPlaybackEnabled = 1u << 0, kPlaybackMuted = 1u << 1, kPlaybackSolo = 1u << 2, kPlaybackSeen = 1u << 7 };
+    std::unordered_map<uint32_t, uint8_t> playbackEventState;
+    std::vector<Scene::StateEdit> playbackEdits; // reused by SyncPlaybackEvents()
+    bool SyncPlaybackEvents();
+    bool ApplyPlaybackState(uint32_t id, bool enabled, bool muted, bool solo);
+    bool RescanPlaybackEvents();
 
     // Scene-mode paroxysm preview cache (avoid re-simulating every frame)
     bool lastTimelinePlaying;
     uint64_t scenePreviewKey;
     bool scenePreviewValid;
+    // Event position the frozen preview was simulated at. Dragging the event only offsets the
+    // snapshot through the model matrix (the simulation is translation-invariant). Rendering
+    // reads the copy published with the snapshot (SimulationThread::GetSnapshotBakedPosition).
+    glm::vec3 scenePreviewBakedPosition;
+    // Content key (template + overrides) of the pending / shown scene preview.
+    uint64_t scenePreviewContent;
 
     uint64_t ComputeScenePreviewKey() const;
-    void RebuildSceneParoxysmPreview(float nowSeconds);
+    // Built by previewWorker like the Template-mode preview: slider drags never simulate on
+    // the UI thread.
+    void RequestSceneParoxysmPreview(float nowSeconds);
 
     // Template-mode idle preview cache (avoid re-simulating every frame)
     uint64_t templatePreviewKey;
     bool templatePreviewValid;
     uint64_t templatePreviewVersion;
+    // Rotation / position the preview in the pool was simulated with (position non-zero when
+    // it comes from a scene event). Published with the snapshot, see SimulationThread::Kick.
     glm::vec3 templatePreviewBakedRotation;
+    glm::vec3 templatePreviewBakedPosition;
+    // Content hash of the template the pending / shown preview was requested for.
+    uint64_t templatePreviewContent;
 
     uint64_t ComputeTemplatePreviewKey() const;
-    void RebuildTemplateParoxysmPreview(float nowSeconds);
+    void RequestTemplateParoxysmPreview(float nowSeconds);
+
+    // A finished preview enters previewCache only once it stayed on screen for
+    // kPreviewSettleSeconds: the intermediate values of a slider drag would evict useful
+    // entries. Dropped when a newer request (or playback / a live test) replaces it.
+    static constexpr float kPreviewSettleSeconds = 0.5f;
+    bool previewInsertPending;
+    uint64_t previewInsertContent;
+    glm::vec3 previewInsertRotation;
+    glm::vec3 previewInsertPosition;
+    float previewInsertSince;
+    void QueuePreviewInsert(uint64_t content, const glm::vec3& rotation, const glm::vec3& position, float nowSeconds);
+    void SettlePreviewInsert(float nowSeconds, bool previewShown);
+
+    // On-demand rendering (Run sleeps in glfwWaitEventsTimeout when nothing changes)
+    bool renderOnDemand;
+    int idleFrames;                   // consecutive frames with no visible change
+    uint64_t inputEventSerial;        // bumped by the GLFW input / resize callbacks
+    uint64_t lastRenderedPoolVersion;
+    glm::mat4 lastRenderedView;
+    glm::mat4 lastRenderedModel;
 
     // Fonctions d'initialisation factorisées
     bool InitializeWindow();
@@ -78,6 +164,19 @@ private:
     bool InitializeUI();
     void SetupGLStates();
 
+    // Spawns instances for enabled scene events with fromTime < triggerTime <= toTime.
+    void DispatchSceneEvents(float fromTime, float toTime, float now);
+
+    // Playback (re)started at timeline time t: respawns the enabled events alive at t, as if
+    // they had been triggered (t - triggerTime) ago, and fast-forwards them to `now`.
+    void ReconstructSceneAt(float t, float now, float delta);
+    // Catch-up of a seek: at most this many steps, and never finer than kSeekStepSeconds.
+    static constexpr int kSeekMaxSteps = 240;
+    static constexpr float kSeekStepSeconds = 1.0f / 30.0f;
+
+    // Publishes per-frame stats (pool, instances, overdraw) into the profiler.
+    void PublishFrameStats();
+
     static void framebufferSizeCallback(GLFWwindow* window, int width, int height);
     static void mouseButtonCallback(GLFWwindow* w, int button, int action, int mods);
     static void cursorPosCallback(GLFWwindow* w, double xpos, double ypos);
@@ -89,5 +188,10 @@ public:
 
     bool Initialize();
     int Run();
+
+    // Offline export: loads a .fwscene, steps it at exactly settings.fps and writes every
+    // frame through FrameExporter. tailSeconds keeps rendering after the scene duration so
+    // the last shells can burn out. Returns a process exit code.
+    int RunExport(const std::string& scenePath, const FrameExporter::Settings& settings, float tailSeconds);
     void Shutdown();
 };
\ No newline at end of file
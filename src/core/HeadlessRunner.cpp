@@ -0,0 +1,142 @@
+#include "HeadlessRunner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+
+#include "Profiler.h"
+#include "../rendering/Camera.h"
+#include "../rendering/SoftwareRenderer.h"
+#include "../fireworks/particle/ParticlePool.h"
+#include "../fireworks/instance/InstanceManager.h"
+#include "../fireworks/template/TemplateLibrary.h"
+#include "../fireworks/shapes/ShapeRegistry.h"
+#include "../scene/Scene.h"
+#include "../serialization/FireworkSerialization.h"
+
+int HeadlessRunner::Run(const Settings& settings)
+{
+    if (settings.width <= 0 || settings.height <= 0 || settings.fps <= 0) {
+        std::cerr << "Headless: invalid settings\n";
+        return 2;
+    }
+
+    std::shared_ptr<Scene> scene = serialization::LoadScene(settings.scenePath);
+    if (!scene) {
+        std::cerr << "Headless: cannot load scene " << settings.scenePath << "\n";
+        return 1;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(settings.outputDir, ec);
+    if (ec) {
+        std::cerr << "Headless: cannot create " << settings.outputDir << ": " << ec.message() << "\n";
+        return 1;
+    }
+
+    // Same content setup as Application (presets + default camera), minus GL.
+    TemplateLibrary library;
+    library.SeedPresets();
+    InstanceManager instances;
+    instances.GetBudget().SetPolicy(settings.budgetPolicy);
+    instances.SetEmissionThreads(settings.threads);
+    ParticlePool pool(static_cast<size_t>(settings.poolCapacity));
+    Camera camera(glm::vec3(0.0f, 5.0f, 15.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    ShapeRegistry shapes; // paths only: Initialize() would need a GL context
+    SoftwareRenderer renderer;
+    renderer.Resize(settings.width, settings.height);
+    renderer.SetThreadCount(settings.threads);
+    renderer.LoadShapes(shapes);
+
+    std::vector<float> times = settings.times;
+    if (times.empty()) {
+        const float duration = std::max(1.0f, scene->GetDuration());
+        for (int i = 1; i <= 5; ++i) times.push_back(duration * static_cast<float>(i) / 6.0f);
+    }
+    std::sort(times.begin(), times.end());
+
+    Profiler profiler;
+    const double frameDt = 1.0 / static_cast<double>(settings.fps);
+    const float dt = static_cast<float>(frameDt);
+
+    float prevTime = -1.0f; // events at t = 0 fire on the first step
+    EventSchedule::Cursor cursor;
+    EmissionBatch::Stats peakEmission;
+    size_t nextShot = 0;
+    for (int frame = 0; nextShot < times.size(); ++frame) {
+        const float t = static_cast<float>(frame * frameDt);
+
+        {
+            Profiler::ScopedSection section(&profiler, "simulate");
+            scene->GetSchedule().Advance(cursor, prevTime, t, [&](size_t index) {
+                const FireworkEvent& e = scene->GetEvents()[index];
+                if (!e.enabled) return;
+                if (FireworkTemplate* tmpl = library.Get(e.templateId)) {
+                    instances.Spawn(tmpl, e.position, t, InstanceManager::kNoSource, e.overrides);
+                }
+            });
+            prevTime = t;
+            instances.Update(t, dt, pool);
+            pool.Update(dt);
+        }
+        // Largest emission of the run (finale cues)
+        if (instances.GetEmissionStats().particles > peakEmission.particles) peakEmission = instances.GetEmissionStats();
+
+        while (nextShot < times.size() && times[nextShot] <= t + 0.5f * dt) {
+            {
+                Profiler::ScopedSection section(&profiler, "render.software");
+                renderer.Clear(glm::vec4(0.1f, 0.1f, 0.15f, 1.0f));
+                renderer.Render(pool, camera);
+            }
+
+            char name[32];
+            std::snprintf(name, sizeof(name), "thumb_%02d.png", static_cast<int>(nextShot));
+            const std::string path = (std::filesystem::path(settings.outputDir) / name).string();
+
+            bool ok;
+            {
+                Profiler::ScopedSection section(&profiler, "png.write");
+                ok = renderer.WritePng(path);
+            }
+
+            const SoftwareRenderer::Stats& rs = renderer.GetStats();
+            std::cout << (ok ? "  wrote " : "  FAILED ") << path << " (t=" << t << "s, "
+                      << rs.sprites << " sprites, " << rs.triangles << " trail tris, "
+                      << rs.setupMs << "/" << rs.binMs << "/" << rs.rasterMs << " ms setup/bin/raster)\n";
+            if (!ok) return 1;
+
+            profiler.SetCounter("software.sprites", static_cast<double>(rs.sprites));
+            profiler.SetCounter("software.triangles", static_cast<double>(rs.triangles));
+            profiler.SetCounter("software.binnedRefs", static_cast<double>(rs.binnedRefs));
+            profiler.SetCounter("software.rasterMs", rs.rasterMs);
+            // Same names as the GL overdraw view, so headless and live captures compare.
+            profiler.SetCounter("overdraw.avgLayers", rs.avgLayers);
+            profiler.SetCounter("overdraw.avgLayersCovered", rs.avgLayersCovered);
+            profiler.SetCounter("overdraw.maxLayers", rs.maxLayers);
+            profiler.SetCounter("overdraw.fragments", rs.fragments);
+            ++nextShot;
+        }
+    }
+
+    profiler.SetCounter("particles.active", static_cast<double>(pool.GetActiveCount()));
+    profiler.SetCounter("instances.active", static_cast<double>(instances.GetActiveCount()));
+    // Budget decisions over the whole run (pool pressure)
+    const ParticleBudget::Stats& budget = instances.GetBudget().GetTotals();
+    profiler.SetCounter("budget.demand", static_cast<double>(budget.demand));
+    profiler.SetCounter("budget.thinned", static_cast<double>(budget.thinned));
+    profiler.SetCounter("budget.evicted", static_cast<double>(budget.evicted));
+    profiler.SetCounter("budget.smokeDropped", static_cast<double>(budget.smokeDropped));
+    profiler.SetCounter("budget.recursionDropped", static_cast<double>(budget.recursionDropped));
+    profiler.SetCounter("budget.minKeepRatio", static_cast<double>(budget.keepRatio));
+    profiler.SetCounter("emission.peakParticles", static_cast<double>(peakEmission.particles));
+    profiler.SetCounter("emission.peakWorkers", static_cast<double>(peakEmission.workers));
+    profiler.SetCounter("emission.peakWriteMs", peakEmission.writeMs);
+    profiler.Dump(std::cout);
+
+    instances.Clear();
+    return 0;
+}
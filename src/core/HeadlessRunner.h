@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../fireworks/instance/ParticleBudget.h"
+
+// Runs a scene without any window or GL context and writes PNG snapshots with the
+// software renderer (render nodes, thumbnails, regression images).
+//
+// The scene is simulated from t = 0 with a fixed step; whenever a requested time is
+// reached the particle state is rendered on the CPU and written to
+// <outputDir>/thumb_<index>.png. Timings and counters are printed at the end.
+class HeadlessRunner {
+public:
+    struct Settings {
+        std::string scenePath;
+        std::string outputDir;
+        int width = 640;
+        int height = 360;
+        int fps = 30;              // simulation step
+        std::vector<float> times;  // empty = 5 evenly spaced shots over the scene
+        int threads = 0;           // 0 = hardware concurrency (rasterizer + emission fill)
+        int poolCapacity = 500000;
+        ParticleBudget::Policy budgetPolicy = ParticleBudget::Policy::Thin;
+    };
+
+    // Returns a process exit code.
+    int Run(const Settings& settings);
+};
@@ -0,0 +1,235 @@
+#include "PreviewCache.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include "../fireworks/particle/ParticlePool.h"
+
+namespace {
+
+constexpr char kMagic[8] = { 'F', 'W', 'P', 'R', 'E', 'V', 'W', '2' };
+
+// A file only loads into the build that wrote it: the records are raw structs, and the
+// particles were baked by that build's simulation (bakeVersion).
+struct FileHeader {
+    char magic[8];
+    uint32_t bakeVersion;
+    uint32_t particleSize;
+    uint32_t paramsSize;
+    uint32_t trailSamples;
+    uint32_t entryCount;
+};
+
+struct EntryHeader {
+    uint64_t key;
+    float rotation[3];
+    float position[3];
+    uint32_t particleCount;
+    uint32_t paramsCount;
+};
+
+template <typename T>
+bool ReadVector(std::istream& in, std::vector<T>& v, size_t count)
+{
+    v.resize(count);
+    if (count == 0) return true;
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(v.data()), static_cast<std::streamsize>(count * sizeof(T))));
+}
+
+template <typename T>
+void WriteVector(std::ostream& out, const std::vector<T>& v)
+{
+    if (v.empty()) return;
+    out.write(reinterpret_cast<const char*>(v.data()), static_cast<std::streamsize>(v.size() * sizeof(T)));
+}
+
+} // namespace
+
+PreviewCache::PreviewCache(size_t budgetBytes)
+    : budget(budgetBytes)
+{
+}
+
+size_t PreviewCache::SizeOf(const Entry& entry)
+{
+    return sizeof(Entry)
+        + entry.particles.size() * sizeof(Particle)
+        + entry.trails.size() * sizeof(glm::vec3)
+        + entry.params.size() * sizeof(EmitterParams);
+}
+
+bool PreviewCache::Find(uint64_t key, ParticlePool& target, glm::vec3& bakedRotation, glm::vec3& bakedPosition)
+{
+    auto it = index.find(key);
+    if (it == index.end()) {
+        ++stats.misses;
+        return false;
+    }
+    ++stats.hits;
+    entries.splice(entries.begin(), entries, it->second);
+    const Entry& e = entries.front();
+
+    target.ClearAll();
+
+    // The target's table is rebuilt by interning the snapshot's entries: same authoring,
+    // possibly other indices.
+    std::vector<uint16_t> remap(e.params.size(), ParticlePool::kDefaultParams);
+    for (size_t i = 0; i < e.params.size(); ++i) remap[i] = target.InternEmitterParams(e.params[i]);
+
+    target.SetEmitOwner(ParticlePool::kNoOwner);
+    const int total = static_cast<int>(e.particles.size());
+    int copied = 0;
+    while (copied < total) {
+        const ParticleSpan span = target.AllocateRange(total - copied);
+        if (span.count == 0) break; // smaller pool than the one that baked it
+        for (int k = 0; k < span.count; ++k) {
+            const int src = copied + k;
+            Particle& p = target.Get(span.first + k);
+            const uint32_t owner = p.owner; // as registered by AllocateRange
+            p = e.particles[static_cast<size_t>(src)];
+            p.owner = owner;
+            p.active = true;
+            p.paramsIndex = (p.paramsIndex < remap.size()) ? remap[p.paramsIndex] : ParticlePool::kDefaultParams;
+            std::copy_n(&e.trails[static_cast<size_t>(src) * ParticlePool::kTrailSamples], ParticlePool::kTrailSamples,
+                        target.GetTrailBuffer(span.first + k));
+        }
+        copied += span.count;
+    }
+
+    bakedRotation = e.rotation;
+    bakedPosition = e.position;
+    return true;
+}
+
+void PreviewCache::Insert(uint64_t key, const ParticlePool& source, const glm::vec3& bakedRotation, const glm::vec3& bakedPosition)
+{
+    Entry e;
+    e.key = key;
+    e.rotation = bakedRotation;
+    e.position = bakedPosition;
+
+    // Previews sit at the head of a large pool: stop at the last active particle.
+    const auto& all = source.GetAll();
+    const size_t active = source.GetActiveCount();
+    e.particles.reserve(active);
+    e.trails.reserve(active * ParticlePool::kTrailSamples);
+    for (size_t i = 0; i < all.size() && e.particles.size() < active; ++i) {
+        if (!all[i].active) continue;
+        e.particles.push_back(all[i]);
+        const glm::vec3* trail = source.GetTrailBuffer(static_cast<int>(i));
+        e.trails.insert(e.trails.end(), trail, trail + ParticlePool::kTrailSamples);
+    }
+    e.params.reserve(source.GetEmitterParamsCount());
+    for (size_t i = 0; i < source.GetEmitterParamsCount(); ++i) {
+        e.params.push_back(source.GetEmitterParams(static_cast<uint16_t>(i)));
+    }
+
+    Add(std::move(e));
+}
+
+void PreviewCache::Add(Entry&& entry)
+{
+    entry.bytes = SizeOf(entry);
+    if (entry.bytes > budget) return;
+
+    auto existing = index.find(entry.key);
+    if (existing != index.end()) {
+        stats.bytes -= existing->second->bytes;
+        entries.erase(existing->second);
+        index.erase(existing);
+    }
+
+    stats.bytes += entry.bytes;
+    entries.push_front(std::move(entry));
+    index[entries.front().key] = entries.begin();
+
+    while (stats.bytes > budget && !entries.empty()) {
+        const Entry& victim = entries.back();
+        stats.bytes -= victim.bytes;
+        index.erase(victim.key);
+        entries.pop_back();
+        ++stats.evictions;
+    }
+    stats.entries = entries.size();
+}
+
+void PreviewCache::Clear()
+{
+    entries.clear();
+    index.clear();
+    stats.bytes = 0;
+    stats.entries = 0;
+}
+
+bool PreviewCache::Save(const std::string& path) const
+{
+    std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
+
+    FileHeader header;
+    std::copy_n(kMagic, sizeof(kMagic), header.magic);
+    header.bakeVersion = kBakeVersion;
+    header.particleSize = static_cast<uint32_t>(sizeof(Particle));
+    header.paramsSize = static_cast<uint32_t>(sizeof(EmitterParams));
+    header.trailSamples = static_cast<uint32_t>(ParticlePool::kTrailSamples);
+    header.entryCount = static_cast<uint32_t>(entries.size());
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (const Entry& e : entries) {
+        EntryHeader eh;
+        eh.key = e.key;
+        for (int k = 0; k < 3; ++k) {
+            eh.rotation[k] = e.rotation[k];
+            eh.position[k] = e.position[k];
+        }
+        eh.particleCount = static_cast<uint32_t>(e.particles.size());
+        eh.paramsCount = static_cast<uint32_t>(e.params.size());
+        out.write(reinterpret_cast<const char*>(&eh), sizeof(eh));
+        WriteVector(out, e.particles);
+        WriteVector(out, e.trails);
+        WriteVector(out, e.params);
+    }
+    return static_cast<bool>(out);
+}
+
+bool PreviewCache::Load(const std::string& path)
+{
+    std::ifstream in(path, std::ios::in | std::ios::binary);
+    if (!in.is_open()) return false;
+
+    FileHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    if (!std::equal(kMagic, kMagic + sizeof(kMagic), header.magic)
+        || header.bakeVersion != kBakeVersion
+        || header.particleSize != sizeof(Particle)
+        || header.paramsSize != sizeof(EmitterParams)
+        || header.trailSamples != static_cast<uint32_t>(ParticlePool::kTrailSamples)) {
+        return false;
+    }
+
+    std::vector<Entry> loaded;
+    size_t bytes = 0;
+    for (uint32_t i = 0; i < header.entryCount; ++i) {
+        EntryHeader eh;
+        if (!in.read(reinterpret_cast<char*>(&eh), sizeof(eh))) return false;
+        // Also guards the allocations below against a damaged file.
+        const size_t perParticle = sizeof(Particle) + ParticlePool::kTrailSamples * sizeof(glm::vec3);
+        if (bytes + static_cast<size_t>(eh.particleCount) * perParticle + static_cast<size_t>(eh.paramsCount) * sizeof(EmitterParams) > budget) break;
+
+        Entry e;
+        e.key = eh.key;
+        e.rotation = glm::vec3(eh.rotation[0], eh.rotation[1], eh.rotation[2]);
+        e.position = glm::vec3(eh.position[0], eh.position[1], eh.position[2]);
+        if (!ReadVector(in, e.particles, eh.particleCount)) return false;
+        if (!ReadVector(in, e.trails, static_cast<size_t>(eh.particleCount) * ParticlePool::kTrailSamples)) return false;
+        if (!ReadVector(in, e.params, eh.paramsCount)) return false;
+
+        bytes += SizeOf(e);
+        if (bytes > budget) break; // the rest is older
+        loaded.push_back(std::move(e));
+    }
+
+    // The file starts with the most recent entry: add back oldest first.
+    for (auto it = loaded.rbegin(); it != loaded.rend(); ++it) Add(std::move(*it));
+    return true;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../fireworks/particle/EmitterParams.h"
+#include "../fireworks/particle/Particle.h"
+
+class ParticlePool;
+
+// Content-addressed cache of baked paroxysm previews.
+//
+// A preview is a frozen pool: its active particles, their trail rings and the emitter
+// params they point to, plus the rotation / position it was simulated at. Entries are keyed
+// by serialization::HashTemplateContent(), so flipping back to a template (or to a scene
+// event using the same parameters) installs the snapshot instead of re-simulating it.
+//
+// Bounded by a byte budget, least recently used entries go first. Save() / Load() keep the
+// cache across sessions; a file with another particle layout, trail length or kBakeVersion
+// is ignored. UI thread only.
+class PreviewCache {
+public:
+    // Version of what a baked preview contains. The content key only covers the template, so
+    // bump this whenever simulation, emission or PreviewWorker baking produce different
+    // particles for the same template: saved previews would load silently stale otherwise.
+    static constexpr uint32_t kBakeVersion = 1;
+
+    struct Stats {
+        uint32_t hits = 0;
+        uint32_t misses = 0;
+        uint32_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+
+    explicit PreviewCache(size_t budgetBytes);
+
+    // On a hit, replaces target's contents with the snapshot and marks it most recent.
+    bool Find(uint64_t key, ParticlePool& target, glm::vec3& bakedRotation, glm::vec3& bakedPosition);
+
+    // Captures source's active particles. Snapshots larger than the whole budget are not kept.
+    void Insert(uint64_t key, const ParticlePool& source, const glm::vec3& bakedRotation, const glm::vec3& bakedPosition);
+
+    bool Contains(uint64_t key) const { return index.find(key) != index.end(); }
+    void Clear();
+
+    // Binary file, most recent entries first. Load() keeps what fits the budget.
+    bool Save(const std::string& path) const;
+    bool Load(const std::string& path);
+
+    const Stats& GetStats() const { return stats; }
+
+private:
+    struct Entry {
+        uint64_t key = 0;
+        glm::vec3 rotation = glm::vec3(0.0f);
+        glm::vec3 position = glm::vec3(0.0f);
+        std::vector<Particle> particles;
+        std::vector<glm::vec3> trails;     // kTrailSamples per particle
+        std::vector<EmitterParams> params; // the source pool's whole table (indices kept)
+        size_t bytes = 0;
+    };
+
+    void Add(Entry&& entry); // most recent, then evicts down to the budget
+    static size_t SizeOf(const Entry& entry);
+
+    size_t budget;
+    std::list<Entry> entries; // front = most recently used
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+    Stats stats;
+};
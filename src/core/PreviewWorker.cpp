@@ -0,0 +1,147 @@
+#include "PreviewWorker.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../fireworks/instance/InstanceManager.h"
+
+PreviewWorker::PreviewWorker(size_t stagingCapacity)
+    : staging(stagingCapacity)
+    , ready(0)
+    , readyRotation(0.0f)
+    , readyPosition(0.0f)
+    , readyGeneration(0)
+    , generation(0)
+    , takenGeneration(0)
+    , hasPending(false)
+    , running(false)
+    , stopping(false)
+{
+    worker = std::thread(&PreviewWorker::WorkerLoop, this);
+}
+
+PreviewWorker::~PreviewWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        hasPending = false;
+    }
+    generation.fetch_add(1); // abort a running job
+    cv.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+void PreviewWorker::Request(const FireworkTemplate& tmpl, float nowSeconds, const glm::vec3& position,
+                            const TemplateOverride& overrides)
+{
+    Job job;
+    job.tmpl = std::make_unique<FireworkTemplate>(tmpl);
+    job.nowSeconds = nowSeconds;
+    job.position = position;
+    job.overrides = overrides;
+    job.generation = generation.fetch_add(1) + 1;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = std::move(job);
+        hasPending = true;
+    }
+    cv.notify_all();
+}
+
+void PreviewWorker::Cancel()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!hasPending && !running && readyGeneration <= takenGeneration) return;
+    hasPending = false;
+    generation.fetch_add(1);
+}
+
+bool PreviewWorker::TakeResult(ParticlePool& target, glm::vec3& bakedRotation, glm::vec3& bakedPosition)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    // Only the job for the latest request counts; older results are stale.
+    if (readyGeneration != generation.load() || readyGeneration == takenGeneration) return false;
+
+    target.AssignFrom(ready);
+    bakedRotation = readyRotation;
+    bakedPosition = readyPosition;
+    takenGeneration = readyGeneration;
+    return true;
+}
+
+bool PreviewWorker::IsBusy() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return hasPending || running;
+}
+
+void PreviewWorker::WorkerLoop()
+{
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this]() { return hasPending || stopping; });
+            if (stopping) return;
+            job = std::move(pending);
+            hasPending = false;
+            running = true;
+        }
+
+        const bool done = Build(job);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+        if (done && job.generation == generation.load()) {
+            // Compact copy: the staging pool is reused by the next job right away.
+            ready.CopyActiveFrom(staging);
+            readyRotation = job.tmpl->worldRotation;
+            readyPosition = job.position;
+            readyGeneration = job.generation;
+        }
+    }
+}
+
+bool PreviewWorker::Build(const Job& job)
+{
+    const FireworkTemplate* t = job.tmpl.get();
+    InstanceManager instances;
+    staging.ClearAll();
+
+    // Estimate a visually meaningful peak: after emission, around mid-life.
+    const float emission = std::max(0.0f, t->branchTemplate.emissionDuration);
+    const float life = std::max(0.0f, t->branchTemplate.lifetime);
+    float peakOffset = emission + 0.5f * life;
+
+    if (peakOffset < 0.1f) peakOffset = 0.1f;
+    if (peakOffset > 4.0f) peakOffset = 4.0f;
+
+    const float startTime = job.nowSeconds - peakOffset;
+    instances.Spawn(t, job.position, startTime, InstanceManager::kNoSource, job.overrides);
+
+    // Simulate forward to "nowSeconds" with a bounded step count.
+    const float step = 1.0f / 30.0f;
+    const int maxSteps = 120;
+    int steps = static_cast<int>(std::ceil(peakOffset / step));
+    if (steps > maxSteps) steps = maxSteps;
+
+    float tcur = startTime;
+    const float target = job.nowSeconds;
+    for (int s = 0; s < steps; ++s) {
+        // A newer edit (or Cancel) supersedes this job.
+        if (job.generation != generation.load(std::memory_order_relaxed)) return false;
+
+        float dt = step;
+        if (tcur + dt > target) dt = std::max(0.0f, target - tcur);
+        instances.Update(tcur + dt, dt, staging);
+        staging.Update(dt);
+        tcur += dt;
+        if (dt <= 0.0f) break;
+    }
+
+    // We don't want to keep an instance around for the idle preview.
+    instances.Clear();
+    return true;
+}
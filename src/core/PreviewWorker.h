@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <glm/glm.hpp>
+
+#include "../fireworks/particle/ParticlePool.h"
+#include "../fireworks/template/FireworkTemplate.h"
+#include "../fireworks/template/TemplateOverride.h"
+
+// Builds the paroxysm previews (Template mode, and the selected event in Scene mode) off
+// the UI thread.
+//
+// Request() snapshots the template (instances read their template live, and the UI keeps
+// editing the original) and hands it to a worker that simulates into a private staging
+// pool. A newer Request() or Cancel() bumps the generation: the in-flight job notices
+// between steps and gives up. TakeResult() installs the latest finished preview into the
+// caller's pool in one go, so the previous preview stays on screen until then and the UI
+// thread never waits for a simulation.
+class PreviewWorker {
+public:
+    // stagingCapacity bounds the particles a preview may hold (smoke / recursion included).
+    explicit PreviewWorker(size_t stagingCapacity);
+    ~PreviewWorker();
+
+    PreviewWorker(const PreviewWorker&) = delete;
+    PreviewWorker& operator=(const PreviewWorker&) = delete;
+
+    // UI thread. Supersedes any queued or running job. A scene event's preview is built at
+    // its position, with its overrides.
+    void Request(const FireworkTemplate& tmpl, float nowSeconds, const glm::vec3& position = glm::vec3(0.0f),
+                 const TemplateOverride& overrides = TemplateOverride());
+
+    // UI thread. Drops queued / running work and any result not yet taken.
+    void Cancel();
+
+    // UI thread. If the job for the latest Request() finished, replaces target's contents with
+    // it and returns the rotation and position baked into the particles.
+    bool TakeResult(ParticlePool& target, glm::vec3& bakedRotation, glm::vec3& bakedPosition);
+
+    bool IsBusy() const;
+
+private:
+    struct Job {
+        std::unique_ptr<FireworkTemplate> tmpl;
+        float nowSeconds = 0.0f;
+        glm::vec3 position = glm::vec3(0.0f);
+        TemplateOverride overrides;
+        uint64_t generation = 0;
+    };
+
+    void WorkerLoop();
+    // false when cancelled midway.
+    bool Build(const Job& job);
+
+    ParticlePool staging;   // worker only
+    ParticlePool ready;     // compact copy of the last finished job (guarded by mutex)
+    glm::vec3 readyRotation;
+    glm::vec3 readyPosition;
+    uint64_t readyGeneration;
+
+    std::atomic<uint64_t> generation; // latest requested; jobs compare against it to cancel
+    uint64_t takenGeneration;         // UI thread only
+
+    std::thread worker;
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    Job pending;          // at most one queued job: newer requests replace it
+    bool hasPending;
+    bool running;
+    bool stopping;
+};
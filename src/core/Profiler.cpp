@@ -0,0 +1,124 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <ostream>
+
+#include <imgui.h>
+
+Profiler::Profiler()
+    : hasFrameStart(false)
+    , frameHistoryHead(0)
+{
+    std::fill(frameHistoryMs, frameHistoryMs + kHistoryFrames, 0.0f);
+}
+
+Profiler::Entry* Profiler::Find(std::vector<Entry>& entries, const std::string& name)
+{
+    for (auto& e : entries) {
+        if (e.name == name) return &e;
+    }
+    return nullptr;
+}
+
+void Profiler::BeginFrame()
+{
+    const auto now = std::chrono::steady_clock::now();
+    if (hasFrameStart) {
+        const double ms = std::chrono::duration<double, std::milli>(now - frameStart).count();
+        frameHistoryMs[frameHistoryHead] = static_cast<float>(ms);
+        frameHistoryHead = (frameHistoryHead + 1) % kHistoryFrames;
+        SetCounter("frame.ms", ms);
+    }
+    frameStart = now;
+    hasFrameStart = true;
+
+    // Sections are per-frame; keep the entries (stable display order) but reset values.
+    for (auto& s : sections) s.value = 0.0;
+}
+
+void Profiler::SetCounter(const std::string& name, double value)
+{
+    if (Entry* e = Find(counters, name)) {
+        e->value = value;
+        return;
+    }
+    counters.push_back({ name, value });
+}
+
+double Profiler::GetCounter(const std::string& name) const
+{
+    for (const auto& e : counters) {
+        if (e.name == name) return e.value;
+    }
+    return 0.0;
+}
+
+void Profiler::AddSectionTime(const std::string& name, double milliseconds)
+{
+    if (Entry* e = Find(sections, name)) {
+        e->value += milliseconds;
+        return;
+    }
+    sections.push_back({ name, milliseconds });
+}
+
+Profiler::ScopedSection::ScopedSection(Profiler* p, const char* n)
+    : profiler(p)
+    , name(n)
+    , start(std::chrono::steady_clock::now())
+{
+}
+
+Profiler::ScopedSection::~ScopedSection()
+{
+    if (!profiler) return;
+    const auto end = std::chrono::steady_clock::now();
+    profiler->AddSectionTime(name, std::chrono::duration<double, std::milli>(end - start).count());
+}
+
+void Profiler::DrawWindow(bool* open)
+{
+    if (open && !*open) return;
+
+    if (!ImGui::Begin("Profiler", open)) {
+        ImGui::End();
+        return;
+    }
+
+    // Frame time history (ring buffer, oldest first).
+    float ordered[kHistoryFrames];
+    float maxMs = 0.0f;
+    for (int i = 0; i < kHistoryFrames; ++i) {
+        ordered[i] = frameHistoryMs[(frameHistoryHead + i) % kHistoryFrames];
+        maxMs = std::max(maxMs, ordered[i]);
+    }
+    const float lastMs = ordered[kHistoryFrames - 1];
+    char overlay[64];
+    std::snprintf(overlay, sizeof(overlay), "%.2f ms (%.0f fps)", lastMs, lastMs > 0.0f ? 1000.0f / lastMs : 0.0f);
+    ImGui::PlotLines("##frametimes", ordered, kHistoryFrames, 0, overlay, 0.0f, std::max(33.3f, maxMs), ImVec2(-FLT_MIN, 60.0f));
+
+    if (ImGui::CollapsingHeader("Sections (ms)", ImGuiTreeNodeFlags_DefaultOpen)) {
+        for (const auto& s : sections) {
+            ImGui::Text("%-28s %8.3f", s.name.c_str(), s.value);
+        }
+    }
+
+    if (ImGui::CollapsingHeader("Counters", ImGuiTreeNodeFlags_DefaultOpen)) {
+        for (const auto& c : counters) {
+            ImGui::Text("%-28s %12.2f", c.name.c_str(), c.value);
+        }
+    }
+
+    ImGui::End();
+}
+
+void Profiler::Dump(std::ostream& out) const
+{
+    for (const auto& s : sections) {
+        out << "section." << s.name << ".ms " << s.value << '\n';
+    }
+    for (const auto& c : counters) {
+        out << c.name << ' ' << c.value << '\n';
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Lightweight frame profiler: CPU section timings + named counters.
+//
+// Systems do not talk to the profiler directly: Application pulls stats from the
+// renderers / pools once per frame and publishes them here. The same data is shown
+// in the "Profiler" debug window and dumped as text by headless runs.
+class Profiler {
+public:
+    static constexpr int kHistoryFrames = 120;
+
+    Profiler();
+
+    // Resets per-frame section timings and records the previous frame duration.
+    void BeginFrame();
+
+    // Counters keep their last published value until overwritten.
+    void SetCounter(const std::string& name, double value);
+    double GetCounter(const std::string& name) const;
+
+    // Accumulates time (milliseconds) into a named section for the current frame.
+    void AddSectionTime(const std::string& name, double milliseconds);
+
+    // RAII helper: times a scope into a section.
+    class ScopedSection {
+    public:
+        ScopedSection(Profiler* profiler, const char* name);
+        ~ScopedSection();
+
+        ScopedSection(const ScopedSection&) = delete;
+        ScopedSection& operator=(const ScopedSection&) = delete;
+
+    private:
+        Profiler* profiler;
+        const char* name;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    // Debug window (call between ImGui NewFrame and Render).
+    void DrawWindow(bool* open);
+
+    // Plain-text dump ("name value" per line), used by headless runs.
+    void Dump(std::ostream& out) const;
+
+private:
+    struct Entry {
+        std::string name;
+        double value = 0.0;
+    };
+
+    static Entry* Find(std::vector<Entry>& entries, const std::string& name);
+
+    std::vector<Entry> counters;
+    std::vector<Entry> sections;
+
+    std::chrono::steady_clock::time_point frameStart;
+    bool hasFrameStart;
+
+    float frameHistoryMs[kHistoryFrames];
+    int frameHistoryHead;
+};
@@ -0,0 +1,233 @@
+#include "SimulationThread.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "../fireworks/instance/InstanceManager.h"
+
+SimulationThread::SimulationThread(InstanceManager& instances_, ParticlePool& pool_)
+    : instances(instances_)
+    , pool(pool_)
+    , snapshotA(0)
+    , snapshotB(0)
+    , front(&snapshotA)
+    , back(&snapshotB)
+    , frontInstanceCount(0)
+    , backInstanceCount(0)
+    , frontBakedRotation(0.0f)
+    , backBakedRotation(0.0f)
+    , frontBakedPosition(0.0f)
+    , backBakedPosition(0.0f)
+    , backReady(false)
+    , lastStepMs(0.0)
+    , workPending(false)
+    , stopping(false)
+{
+}
+
+SimulationThread::~SimulationThread()
+{
+    Stop();
+}
+
+void SimulationThread::Start()
+{
+    if (worker.joinable()) return;
+
+    // Start with what is already in the pool (e.g. a preview built before Run()).
+    front->CopyActiveFrom(pool);
+    frontInstanceCount = instances.GetActiveCount();
+
+    stopping = false;
+    worker = std::thread(&SimulationThread::WorkerLoop, this);
+}
+
+void SimulationThread::Stop()
+{
+    if (!worker.joinable()) return;
+
+    WaitIdle();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    worker.join();
+
+    // Leftovers posted after the last Kick() still reach the pool.
+    Command c;
+    while (commands.TryPop(c)) Apply(c);
+}
+
+void SimulationThread::Spawn(const FireworkTemplate* tmpl, const glm::vec3& position, float triggerTime, uint32_t sourceId,
+                             const TemplateOverride& overrides)
+{
+    Command c;
+    c.type = Command::Type::Spawn;
+    c.tmpl = tmpl;
+    c.position = position;
+    c.time = triggerTime;
+    c.source = sourceId;
+    c.overrides = overrides;
+    Post(c);
+}
+
+void SimulationThread::Clear()
+{
+    Command c;
+    c.type = Command::Type::Clear;
+    Post(c);
+}
+
+void SimulationThread::KillSource(uint32_t sourceId)
+{
+    Command c;
+    c.type = Command::Type::KillSource;
+    c.source = sourceId;
+    Post(c);
+}
+
+void SimulationThread::SetSourceVisibility(uint32_t sourceId, bool muted, bool solo)
+{
+    Command c;
+    c.type = Command::Type::SetSourceVisibility;
+    c.source = sourceId;
+    c.muted = muted;
+    c.solo = solo;
+    Post(c);
+}
+
+void SimulationThread::FastForward(float from, float until, float step)
+{
+    if (until <= from || step <= 0.0f) return;
+    Command c;
+    c.type = Command::Type::FastForward;
+    c.time = from;
+    c.until = until;
+    c.delta = step;
+    Post(c);
+}
+
+void SimulationThread::Kick(float now, float delta, bool simulate, const glm::vec3& bakedRotation,
+                            const glm::vec3& bakedPosition)
+{
+    Command c;
+    c.type = Command::Type::Step;
+    c.time = now;
+    c.delta = delta;
+    c.simulate = simulate;
+    c.bakedRotation = bakedRotation;
+    c.bakedPosition = bakedPosition;
+    Post(c);
+    Signal();
+}
+
+void SimulationThread::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this]() { return !workPending; });
+
+    if (backReady) {
+        std::swap(front, back);
+        std::swap(frontInstanceCount, backInstanceCount);
+        std::swap(frontBakedRotation, backBakedRotation);
+        std::swap(frontBakedPosition, backBakedPosition);
+        backReady = false;
+    }
+}
+
+void SimulationThread::Post(const Command& command)
+{
+    if (!worker.joinable()) {
+        Apply(command);
+        return;
+    }
+
+    // Full queue (burst of spawns): let the worker drain it. The main thread only posts
+    // while the worker is idle, so this cannot overlap a step started elsewhere.
+    while (!commands.TryPush(command)) {
+        Signal();
+        WaitIdle();
+    }
+}
+
+void SimulationThread::Signal()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        workPending = true;
+    }
+    cv.notify_all();
+}
+
+void SimulationThread::WorkerLoop()
+{
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this]() { return workPending || stopping; });
+            if (stopping && !workPending) return;
+        }
+
+        Command c;
+        while (commands.TryPop(c)) Apply(c);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            workPending = false;
+        }
+        cv.notify_all();
+    }
+}
+
+void SimulationThread::Apply(const Command& command)
+{
+    switch (command.type) {
+    case Command::Type::Spawn:
+        if (command.tmpl) instances.Spawn(command.tmpl, command.position, command.time, command.source, command.overrides);
+        break;
+
+    case Command::Type::Clear:
+        instances.Clear();
+        pool.ClearAll();
+        break;
+
+    case Command::Type::KillSource:
+        instances.KillSource(command.source, pool);
+        break;
+
+    case Command::Type::SetSourceVisibility:
+        instances.SetSourceVisibility(command.source, command.muted, command.solo);
+        break;
+
+    case Command::Type::FastForward: {
+        float t = command.time;
+        while (t < command.until) {
+            const float dt = std::min(command.delta, command.until - t);
+            t += dt;
+            instances.Update(t, dt, pool);
+            pool.Update(dt);
+        }
+        break;
+    }
+
+    case Command::Type::Step: {
+        const auto start = std::chrono::steady_clock::now();
+        if (command.simulate) {
+            instances.Update(command.time, command.delta, pool);
+            pool.Update(command.delta);
+        }
+
+        // Without a worker (Post() before Start()) there is no back buffer to fill.
+        if (worker.joinable()) {
+            back->CopyActiveFrom(pool);
+            backInstanceCount = instances.GetActiveCount();
+            backBakedRotation = command.bakedRotation;
+            backBakedPosition = command.bakedPosition;
+            backReady = true;
+        }
+        lastStepMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        break;
+    }
+    }
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include <glm/glm.hpp>
+
+#include "SpscQueue.h"
+#include "../fireworks/particle/ParticlePool.h"
+#include "../fireworks/template/TemplateOverride.h"
+
+class FireworkTemplate;
+class InstanceManager;
+
+// Runs InstanceManager / ParticlePool stepping on a dedicated thread so frame N+1 is
+// simulated while the main thread renders frame N.
+//
+// Frame protocol (main thread):
+//   WaitIdle()                -> previous step done, latest snapshot becomes the front one
+//   ... input, UI, previews   -> the worker is idle: pool / instances / templates may be touched
+//   Spawn() / Clear() / ...   -> queued, applied by the worker in order before the step
+//   Kick(now, delta, sim)     -> worker applies the queue, steps, copies into the back snapshot
+//   render GetFrontSnapshot() -> never written by the worker while the main thread reads it
+//
+// Commands travel through a lock-free SPSC queue; the mutex / condition variable only
+// put the worker to sleep between frames.
+class SimulationThread {
+public:
+    SimulationThread(InstanceManager& instances, ParticlePool& pool);
+    ~SimulationThread();
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    void Start();
+    void Stop();
+    bool IsRunning() const { return worker.joinable(); }
+
+    // Main thread, between WaitIdle() and Kick().
+    // sourceId tags the instance with the scene event that launched it (0 = none), overrides
+    // are that event's per-instance settings.
+    void Spawn(const FireworkTemplate* tmpl, const glm::vec3& position, float triggerTime, uint32_t sourceId = 0,
+               const TemplateOverride& overrides = TemplateOverride());
+    void Clear(); // instances + particles
+
+    // Instances launched by sourceId and their particles disappear in this frame's step.
+    void KillSource(uint32_t sourceId);
+    // Editor mute / solo, see InstanceManager::SetSourceVisibility.
+    void SetSourceVisibility(uint32_t sourceId, bool muted, bool solo);
+
+    // Steps from `from` to `until` in increments of at most `step`, without a snapshot: brings
+    // instances spawned in the past (timeline seek) up to date before the next Kick().
+    void FastForward(float from, float until, float step);
+
+    // Queues one step (simulate == false only refreshes the snapshot) and wakes the worker.
+    // bakedRotation / bakedPosition describe the frozen preview the pool holds (what it was
+    // simulated with); they travel with the snapshot so the model matrix of the frame that
+    // shows it uses the matching values.
+    void Kick(float now, float delta, bool simulate, const glm::vec3& bakedRotation = glm::vec3(0.0f),
+              const glm::vec3& bakedPosition = glm::vec3(0.0f));
+
+    // Blocks until every queued command ran, then publishes the new snapshot.
+    void WaitIdle();
+
+    // Compact copy of the active particles (+ trails) as of the last finished step.
+    const ParticlePool& GetFrontSnapshot() const { return *front; }
+    size_t GetSnapshotInstanceCount() const { return frontInstanceCount; }
+    const glm::vec3& GetSnapshotBakedRotation() const { return frontBakedRotation; }
+    const glm::vec3& GetSnapshotBakedPosition() const { return frontBakedPosition; }
+
+    // Worker time of the last step (apply + simulate + snapshot copy), in milliseconds.
+    double GetLastStepMs() const { return lastStepMs; }
+
+private:
+    struct Command {
+        enum class Type : uint8_t { Spawn, Clear, KillSource, SetSourceVisibility, FastForward, Step };
+        Type type = Type::Step;
+        const FireworkTemplate* tmpl = nullptr;
+        glm::vec3 position = glm::vec3(0.0f);
+        float time = 0.0f;
+        float delta = 0.0f;
+        float until = 0.0f; // FastForward end
+        glm::vec3 bakedRotation = glm::vec3(0.0f); // Step
+        glm::vec3 bakedPosition = glm::vec3(0.0f); // Step
+        TemplateOverride overrides; // Spawn
+        uint32_t source = 0;
+        bool simulate = false;
+        bool muted = false;
+        bool solo = false;
+    };
+
+    void Post(const Command& command);
+    void Signal();
+    void WorkerLoop();
+    void Apply(const Command& command);
+
+    InstanceManager& instances;
+    ParticlePool& pool;
+
+    SpscQueue<Command, 1024> commands;
+
+    ParticlePool snapshotA;
+    ParticlePool snapshotB;
+    ParticlePool* front;
+    ParticlePool* back;
+    size_t frontInstanceCount;
+    size_t backInstanceCount;
+    glm::vec3 frontBakedRotation;
+    glm::vec3 backBakedRotation;
+    glm::vec3 frontBakedPosition;
+    glm::vec3 backBakedPosition;
+    bool backReady;
+    double lastStepMs;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool workPending;
+    bool stopping;
+};
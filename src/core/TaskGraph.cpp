@@ -0,0 +1,247 @@
+#include "TaskGraph.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+// Index of the calling thread in the graph that runs it (-1: not one of its workers).
+thread_local const TaskGraph* tls_graph = nullptr;
+thread_local int tls_worker = -1;
+}
+
+// ---------------------------------------------------------------------------
+// WorkQueue
+// ---------------------------------------------------------------------------
+
+bool TaskGraph::WorkQueue::PushBack(Task* t)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (count == kCapacity) return false;
+    ring[(head + count) % kCapacity] = t;
+    ++count;
+    return true;
+}
+
+TaskGraph::Task* TaskGraph::WorkQueue::PopBack()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (count == 0) return nullptr;
+    --count;
+    return ring[(head + count) % kCapacity];
+}
+
+TaskGraph::Task* TaskGraph::WorkQueue::PopFront()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (count == 0) return nullptr;
+    Task* t = ring[head];
+    head = (head + 1) % kCapacity;
+    --count;
+    return t;
+}
+
+// ---------------------------------------------------------------------------
+// Arena
+// ---------------------------------------------------------------------------
+
+TaskGraph::Arena::~Arena()
+{
+    for (unsigned char* b : blocks) std::free(b);
+}
+
+void* TaskGraph::Arena::Allocate(size_t size, size_t align)
+{
+    for (;;) {
+        if (block < blocks.size()) {
+            const size_t aligned = (offset + align - 1) & ~(align - 1);
+            if (aligned + size <= kBlockSize) {
+                offset = aligned + size;
+                return blocks[block] + aligned;
+            }
+            // Next block (closures are small; a block always holds at least one).
+            ++block;
+            offset = 0;
+            continue;
+        }
+        blocks.push_back(static_cast<unsigned char*>(std::malloc(kBlockSize)));
+    }
+}
+
+void TaskGraph::Arena::Rewind()
+{
+    block = 0;
+    offset = 0;
+}
+
+// ---------------------------------------------------------------------------
+// TaskGraph
+// ---------------------------------------------------------------------------
+
+TaskGraph::TaskGraph(int workerCount)
+    : stopping(false)
+    , frameStart(std::chrono::steady_clock::now())
+{
+    if (workerCount < 0) {
+        const int hw = static_cast<int>(std::thread::hardware_concurrency());
+        workerCount = std::max(0, hw - 2);
+    }
+
+    workers.reserve(static_cast<size_t>(workerCount));
+    for (int i = 0; i < workerCount; ++i) workers.push_back(new Worker());
+    for (int i = 0; i < workerCount; ++i) {
+        workers[static_cast<size_t>(i)]->thread = std::thread(&TaskGraph::WorkerLoop, this, i);
+    }
+    frameStats.resize(workers.size());
+}
+
+TaskGraph::~TaskGraph()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    sleepCv.notify_all();
+    for (auto* w : workers) {
+        if (w->thread.joinable()) w->thread.join();
+        delete w;
+    }
+    workers.clear();
+}
+
+void TaskGraph::BeginFrame()
+{
+    const auto now = std::chrono::steady_clock::now();
+    const double wallNs = std::chrono::duration<double, std::nano>(now - frameStart).count();
+    frameStart = now;
+
+    for (size_t i = 0; i < workers.size(); ++i) {
+        Worker& w = *workers[i];
+        WorkerStats& s = frameStats[i];
+        const uint64_t busy = w.busyNs.exchange(0, std::memory_order_relaxed);
+        s.busyMs = static_cast<double>(busy) * 1e-6;
+        s.occupancy = (wallNs > 0.0) ? std::min(1.0, static_cast<double>(busy) / wallNs) : 0.0;
+        s.tasks = w.tasks.exchange(0, std::memory_order_relaxed);
+        s.steals = w.steals.exchange(0, std::memory_order_relaxed);
+    }
+}
+
+void TaskGraph::Precede(Task* before, Task* after)
+{
+    if (!before || !after) return;
+    std::lock_guard<std::mutex> lock(arenaMutex);
+    Edge* e = new (arena.Allocate(sizeof(Edge), alignof(Edge))) Edge{ after, before->successors };
+    before->successors = e;
+    after->unmet.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TaskGraph::Run()
+{
+    if (pending.empty()) return;
+
+    Batch batch;
+    batch.remaining.store(static_cast<int>(pending.size()), std::memory_order_relaxed);
+    // Every task knows its batch, and the roots are picked, before any of them can run:
+    // a finished root releases its successors itself.
+    size_t roots = 0;
+    for (Task* t : pending) {
+        t->batch = &batch;
+        if (t->unmet.load(std::memory_order_relaxed) == 0) pending[roots++] = t;
+    }
+    pending.resize(roots);
+    for (Task* t : pending) Push(t);
+    pending.clear();
+
+    Wait(batch);
+}
+
+void TaskGraph::Push(Task* t)
+{
+    const int self = (tls_graph == this) ? tls_worker : -1;
+    WorkQueue& queue = (self >= 0) ? workers[static_cast<size_t>(self)]->queue : injection;
+    if (!queue.PushBack(t)) {
+        // Queue full: run it here rather than allocating.
+        Execute(t, self);
+        return;
+    }
+    queued.fetch_add(1, std::memory_order_release);
+    if (!workers.empty()) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        sleepCv.notify_one();
+    }
+}
+
+TaskGraph::Task* TaskGraph::FindWork(int self)
+{
+    if (queued.load(std::memory_order_acquire) == 0) return nullptr;
+
+    Task* t = nullptr;
+    // Own queue first (most recent task: its data is still in cache).
+    if (self >= 0) t = workers[static_cast<size_t>(self)]->queue.PopBack();
+    if (!t) t = injection.PopFront();
+
+    if (!t) {
+        // Steal the oldest task of another worker, starting after ourselves.
+        const size_t n = workers.size();
+        const size_t start = (self >= 0) ? static_cast<size_t>(self) + 1 : 0;
+        for (size_t k = 0; k < n && !t; ++k) {
+            const size_t victim = (start + k) % n;
+            if (static_cast<int>(victim) == self) continue;
+            t = workers[victim]->queue.PopFront();
+        }
+        if (t && self >= 0) workers[static_cast<size_t>(self)]->steals.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (t) queued.fetch_sub(1, std::memory_order_acq_rel);
+    return t;
+}
+
+void TaskGraph::Execute(Task* t, int self)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    t->invoke(t->closure);
+    if (t->destroy) t->destroy(t->closure);
+
+    // Release successors before the batch can complete.
+    for (Edge* e = t->successors; e; e = e->next) {
+        if (e->task->unmet.fetch_sub(1, std::memory_order_acq_rel) == 1) Push(e->task);
+    }
+
+    if (self >= 0) {
+        Worker& w = *workers[static_cast<size_t>(self)];
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        w.busyNs.fetch_add(static_cast<uint64_t>(ns), std::memory_order_relaxed);
+        w.tasks.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // t may be recycled by the arena once it is no longer alive: read what we need first.
+    Batch* batch = t->batch;
+    liveTasks.fetch_sub(1, std::memory_order_acq_rel);
+    batch->remaining.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void TaskGraph::Wait(Batch& batch)
+{
+    const int self = (tls_graph == this) ? tls_worker : -1;
+    while (batch.remaining.load(std::memory_order_acquire) > 0) {
+        if (Task* t = FindWork(self)) Execute(t, self);
+        else std::this_thread::yield(); // the last tasks run elsewhere
+    }
+}
+
+void TaskGraph::WorkerLoop(int index)
+{
+    tls_graph = this;
+    tls_worker = index;
+
+    for (;;) {
+        if (Task* t = FindWork(index)) {
+            Execute(t, index);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepCv.wait(lock, [this]() { return stopping || queued.load(std::memory_order_acquire) > 0; });
+        if (stopping) return;
+    }
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Small task scheduler for the CPU stages of a frame.
+//
+// Workers own a bounded deque each: they push and pop their own tasks at the back and
+// steal from the front of the others. Threads that are not workers (main thread,
+// simulation thread) submit through a shared injection queue and help run tasks while they
+// wait, so a graph always completes even with zero workers.
+//
+// Tasks and their closures live in an arena that is rewound whenever no task is alive (at
+// least once per frame), so adding a task never touches the heap once the arena has grown
+// to the frame's needs.
+//
+// Graph API (one owner thread, typically the main thread):
+//   Task* a = graph.Add("pack", [&] { ... });
+//   Task* b = graph.Add("upload", [&] { ... });
+//   graph.Precede(a, b);   // b runs after a
+//   graph.Run();           // submits everything added since the last Run() and waits
+//
+// ParallelFor() may be called from any thread, including from inside a task.
+class TaskGraph {
+public:
+    struct Task;
+
+    // Per worker, over the last frame (BeginFrame() to BeginFrame()).
+    struct WorkerStats {
+        double busyMs = 0.0;
+        double occupancy = 0.0; // busy / frame wall time
+        uint32_t tasks = 0;
+        uint32_t steals = 0;
+    };
+
+    // workerCount < 0: hardware threads minus the main and simulation threads.
+    explicit TaskGraph(int workerCount = -1);
+    ~TaskGraph();
+
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+
+    int GetWorkerCount() const { return static_cast<int>(workers.size()); }
+
+    // Frame boundary: publishes the per-worker stats of the frame that just ended.
+    void BeginFrame();
+    const std::vector<WorkerStats>& GetFrameStats() const { return frameStats; }
+
+    // Owner thread. fn runs once, on any thread, during the next Run().
+    template <typename F>
+    Task* Add(const char* name, F&& fn)
+    {
+        Task* t = NewTask(name, std::forward<F>(fn));
+        pending.push_back(t);
+        return t;
+    }
+
+    // Owner thread. Both tasks must come from Add() and not have run yet.
+    void Precede(Task* before, Task* after);
+
+    // Owner thread. Runs every task added since the last Run(), dependencies first, and
+    // returns when all of them finished.
+    void Run();
+
+    // body(first, last) over [begin, end) in slices of at most grain items. Runs inline
+    // when the range fits in one slice or there is no worker. Returns when all slices ran.
+    template <typename F>
+    void ParallelFor(size_t begin, size_t end, size_t grain, F&& body)
+    {
+        if (end <= begin) return;
+        if (grain == 0) grain = 1;
+        if (workers.empty() || end - begin <= grain) {
+            body(begin, end);
+            return;
+        }
+
+        Batch batch;
+        const size_t slices = (end - begin + grain - 1) / grain;
+        batch.remaining.store(static_cast<int>(slices), std::memory_order_relaxed);
+        for (size_t first = begin; first < end; first += grain) {
+            const size_t last = (end - first > grain) ? first + grain : end;
+            Task* t = NewTask("parallel_for", [&body, first, last]() { body(first, last); });
+            t->batch = &batch;
+            Push(t);
+        }
+        Wait(batch);
+    }
+
+private:
+    struct Edge {
+        Task* task;
+        Edge* next;
+    };
+
+    // Tasks submitted together; the submitter waits for remaining to reach zero.
+    struct Batch {
+        std::atomic<int> remaining{0};
+    };
+
+public:
+    struct Task {
+        const char* name = nullptr;
+        void (*invoke)(void*) = nullptr;
+        void (*destroy)(void*) = nullptr;
+        void* closure = nullptr;
+        std::atomic<int> unmet{0}; // predecessors not finished yet
+        Edge* successors = nullptr;
+        Batch* batch = nullptr;
+    };
+
+private:
+    // Bounded deque guarded by a lock (contention is per queue, tasks are coarse).
+    struct WorkQueue {
+        static constexpr size_t kCapacity = 1024;
+        std::mutex mutex;
+        Task* ring[kCapacity];
+        size_t head = 0;   // front (steal side)
+        size_t count = 0;
+
+        bool PushBack(Task* t);
+        Task* PopBack();
+        Task* PopFront();
+    };
+
+    struct Worker {
+        std::thread thread;
+        WorkQueue queue;
+        std::atomic<uint64_t> busyNs{0};
+        std::atomic<uint32_t> tasks{0};
+        std::atomic<uint32_t> steals{0};
+    };
+
+    // Bump allocator over reusable blocks, rewound when no task is alive.
+    class Arena {
+    public:
+        static constexpr size_t kBlockSize = 64 * 1024;
+        ~Arena();
+        void* Allocate(size_t size, size_t align);
+        void Rewind();
+
+    private:
+        std::vector<unsigned char*> blocks;
+        size_t block = 0;
+        size_t offset = 0;
+    };
+
+    template <typename F>
+    Task* NewTask(const char* name, F&& fn)
+    {
+        using Fn = typename std::decay<F>::type;
+        static_assert(sizeof(Fn) + sizeof(Task) <= Arena::kBlockSize / 4, "capture by reference: closures live in arena blocks");
+        std::lock_guard<std::mutex> lock(arenaMutex);
+        if (liveTasks.load(std::memory_order_acquire) == 0) arena.Rewind();
+        liveTasks.fetch_add(1, std::memory_order_relaxed);
+
+        Task* t = new (arena.Allocate(sizeof(Task), alignof(Task))) Task();
+        t->name = name;
+        t->closure = new (arena.Allocate(sizeof(Fn), alignof(Fn))) Fn(std::forward<F>(fn));
+        t->invoke = [](void* c) { (*static_cast<Fn*>(c))(); };
+        if (!std::is_trivially_destructible<Fn>::value) {
+            t->destroy = [](void* c) { static_cast<Fn*>(c)->~Fn(); };
+        }
+        return t;
+    }
+
+    void Push(Task* t);
+    Task* FindWork(int self);
+    void Execute(Task* t, int self);
+    void Wait(Batch& batch);
+    void WorkerLoop(int index);
+
+    std::vector<Worker*> workers;
+    WorkQueue injection; // submissions from non-worker threads
+
+    std::mutex sleepMutex;
+    std::condition_variable sleepCv;
+    std::atomic<int> queued{0}; // tasks sitting in a queue
+    bool stopping;
+
+    std::mutex arenaMutex;
+    Arena arena;
+    std::atomic<int> liveTasks{0}; // allocated and not finished
+
+    std::vector<Task*> pending; // Add()ed, waiting for Run()
+
+    std::chrono::steady_clock::time_point frameStart;
+    std::vector<WorkerStats> frameStats;
+};
@@ -97,4 +97,9 @@ void Window::PollEvents()
 {
 	// Polling events is global to GLFW; safe to call even if window == nullptr
 	glfwPollEvents();
+}
+
+void Window::WaitEvents(double timeoutSeconds)
+{
+	glfwWaitEventsTimeout(timeoutSeconds);
 }
\ No newline at end of file
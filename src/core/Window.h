@@ -23,6 +23,8 @@ public:
 	bool ShouldClose() const;
 	void SwapBuffers();
 	void PollEvents();
+	// Sleeps until an event arrives or timeoutSeconds elapse (on-demand rendering).
+	void WaitEvents(double timeoutSeconds);
 	inline GLFWwindow* GetWindow() const { return window; }
 	inline int GetWidth() const { return width; }
 	inline int GetHeight() const { return height; }
@@ -116,6 +116,6 @@ void TemplateRotationController::applyDelta(GLFWwindow* window, float dx, float
     t->worldRotation.y = wrap(t->worldRotation.y);
     t->worldRotation.z = wrap(t->worldRotation.z);
 
-    // Ensure branches regenerate so the viewport updates immediately.
-    t->RegenerateBranches();
+    // Only the rotation stage is redone, once per frame (TemplateLibrary::UpdateDirtyBranches).
+    t->MarkDirty(FireworkTemplate::DirtyRotation);
 }
@@ -42,11 +42,12 @@ void BranchInstance::Spawn(ParticlePool& pool)
     if (spawned || !descriptor || !physicsProfile) return;
 
     // Utiliser BranchGenerator pour créer les particules
-    particleIndices = BranchGenerator::EmitBranch(
+    particleSpans.clear();
+    BranchGenerator::EmitBranch(
         *descriptor,
-        *physicsProfile,
         position,
-        pool
+        pool,
+        &particleSpans
     );
 
     spawned = true;
@@ -60,14 +61,16 @@ bool BranchInstance::IsComplete() const
     // Pour simplifier, on considère que c'est complet après un certain temps
     // ou quand toutes les particules sont inactives
 
-    return timeAlive > (descriptor ? descriptor->lifetime : 10.0f);
+    return timeAlive > ((descriptor && descriptor->params) ? descriptor->params->lifetime : 10.0f);
 }
 
 void BranchInstance::Release(ParticlePool& pool)
 {
-    for (int idx : particleIndices) {
-        pool.Free(idx);
+    for (const ParticleSpan& span : particleSpans) {
+        for (int idx = span.first; idx < span.first + span.count; ++idx) {
+            pool.Free(idx);
+        }
     }
-    particleIndices.clear();
+    particleSpans.clear();
     spawned = false;
 }
\ No newline at end of file
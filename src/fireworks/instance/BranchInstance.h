@@ -35,7 +35,7 @@ private:
     const PhysicsProfile* physicsProfile;
     glm::vec3 position;
 
-    std::vector<int> particleIndices;  // Indices des particules dans le pool
+    std::vector<ParticleSpan> particleSpans;  // Plages de particules dans le pool
     bool spawned;
     float timeAlive;
 };
\ No newline at end of file
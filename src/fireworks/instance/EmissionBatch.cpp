@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "EmissionBatch.h"
+
+EmissionBatch::EmissionBatch()
+    : threadCount(1)
+    , maxWorkers(1)
+    , reserved(0)
+{
+}
+
+int EmissionBatch::Reserve(const std::shared_ptr<const EmissionRecipe>& recipe, size_t branchIndex, uint16_t paramsIndex,
+                           const glm::vec3& worldPosition, ParticlePool& pool, int spawnIndex, int count,
+                           const EmissionTransform* transform)
+{
+    if (!recipe || branchIndex >= recipe->GetBranches().size()) return 0;
+    count = std::min(count, recipe->GetBranches()[branchIndex].prepared.particleCount - spawnIndex);
+    if (spawnIndex < 0 || count <= 0) return 0;
+
+    // Même boucle d'allocation que BranchGenerator::EmitSampled : mêmes plages.
+    int emitted = 0;
+    while (emitted < count) {
+        const ParticleSpan span = pool.AllocateRange(count - emitted);
+        if (span.count == 0) break; // pool plein
+
+        Write w;
+        w.recipe = recipe;
+        w.branch = branchIndex;
+        w.paramsIndex = paramsIndex;
+        w.position = worldPosition;
+        w.spawnIndex = spawnIndex + emitted;
+        w.span = span;
+        if (transform) {
+            w.transform = *transform;
+            w.transformed = true;
+        }
+        writes.push_back(std::move(w));
+        emitted += span.count;
+    }
+    reserved += static_cast<size_t>(emitted);
+    return emitted;
+}
+
+void EmissionBatch::SetThreadCount(int threads)
+{
+    threadCount = threads;
+    if (threads > 0) {
+        maxWorkers = threads;
+    }
+    else {
+        const unsigned hw = std::thread::hardware_concurrency();
+        maxWorkers = hw > 0 ? static_cast<int>(hw) : 4;
+    }
+}
+
+void EmissionBatch::RunChunk(const Chunk& chunk, ParticlePool& pool) const
+{
+    const Write& w = writes[chunk.write];
+    w.recipe->Write(w.branch, w.paramsIndex, w.position, &pool.Get(w.span.first + chunk.offset),
+                    w.spawnIndex + chunk.offset, chunk.count, w.transformed ? &w.transform : nullptr);
+}
+
+void EmissionBatch::Execute(ParticlePool& pool)
+{
+    stats = Stats();
+    if (writes.empty()) return;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    chunks.clear();
+    for (size_t i = 0; i < writes.size(); ++i) {
+        const ParticleSpan& span = writes[i].span;
+        for (int offset = 0; offset < span.count; offset += kChunk) {
+            Chunk c;
+            c.write = static_cast<uint32_t>(i);
+            c.offset = offset;
+            c.count = std::min(kChunk, span.count - offset);
+            chunks.push_back(c);
+        }
+    }
+
+    // Chaque tranche ne touche que ses particules : aucun verrou.
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (;;) {
+            const size_t c = next.fetch_add(1);
+            if (c >= chunks.size()) return;
+            RunChunk(chunks[c], pool);
+        }
+    };
+
+    int workers = 1;
+    if (reserved >= kParallelMinParticles) {
+        workers = std::max(1, std::min(maxWorkers, static_cast<int>(chunks.size())));
+    }
+    if (workers == 1) {
+        worker();
+    }
+    else if (parallelFor) {
+        parallelFor(chunks.size(), [this, &pool](size_t first, size_t last) {
+            for (size_t c = first; c < last; ++c) RunChunk(chunks[c], pool);
+        });
+    }
+    else {
+        // Le thread appelant prend sa part.
+        std::vector<std::thread> threads;
+        for (int i = 1; i < workers; ++i) threads.emplace_back(worker);
+        worker();
+        for (auto& t : threads) t.join();
+    }
+
+    stats.particles = static_cast<uint32_t>(reserved);
+    stats.chunks = static_cast<uint32_t>(chunks.size());
+    stats.workers = static_cast<uint32_t>(workers);
+    stats.writeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // Libère les recettes tout de suite (une instance finie a déjà lâché la sienne).
+    writes.clear();
+    reserved = 0;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include "../particle/ParticlePool.h"
+#include "../simulation/EmissionRecipe.h"
+
+// Émission différée des instances d'un pas, remplie en parallèle.
+//
+// Pendant InstanceManager::Update, chaque instance réserve ses plages du pool au lieu de
+// les remplir (Reserve) : allocation, propriétaire et compteurs se font en série, dans le
+// même ordre qu'une émission directe, donc mêmes slots et mêmes compteurs. Execute() copie
+// ensuite les tables des recettes dans les plages réservées, par tranches réparties entre
+// threads. Les tirages sont dans les tables (EmissionRecipe) : aucun RNG n'est partagé, le
+// résultat est identique à l'émission série quel que soit le nombre de threads.
+class EmissionBatch {
+public:
+    // Tranche de particules remplie par une tâche (équilibre entre threads).
+    static constexpr int kChunk = 4096;
+    // En dessous, lancer des threads coûte plus que la copie : remplissage sur place.
+    static constexpr size_t kParallelMinParticles = 16384;
+
+    // Dernier Execute() (compteurs du profiler).
+    struct Stats {
+        uint32_t particles = 0; // particules remplies
+        uint32_t chunks = 0;    // tâches
+        uint32_t workers = 0;   // threads utilisés (1 = série)
+        double writeMs = 0.0;
+    };
+
+    // Exécuteur externe (ordonnanceur de tâches de l'application) : appelle body sur des
+    // sous-plages de [0, count) et retourne quand tout est fait. Sans lui, Execute() lance
+    // ses propres threads.
+    using ParallelFor = std::function<void(size_t count, const std::function<void(size_t first, size_t last)>& body)>;
+
+    EmissionBatch();
+
+    void SetParallelFor(ParallelFor fn) { parallelFor = std::move(fn); }
+
+    // 1 = série (défaut), 0 = tous les coeurs, N = au plus N threads.
+    void SetThreadCount(int threads);
+    int GetThreadCount() const { return threadCount; }
+    // Plus d'un thread disponible. Sinon différer ne fait qu'ajouter une passe mémoire :
+    // l'émission directe est plus rapide.
+    bool IsParallel() const { return maxWorkers > 1; }
+
+    // Alloue les spawns [spawnIndex, spawnIndex + count) de la branche branchIndex de recipe
+    // et note leur remplissage. Retourne le nombre de particules réservées (< count si le
+    // pool est plein), comme EmissionRecipe::Emit. La recette reste en vie jusqu'à Execute() ;
+    // transform (optionnel) est copié.
+    int Reserve(const std::shared_ptr<const EmissionRecipe>& recipe, size_t branchIndex, uint16_t paramsIndex,
+                const glm::vec3& worldPosition, ParticlePool& pool, int spawnIndex, int count,
+                const EmissionTransform* transform = nullptr);
+
+    // Remplit toutes les plages réservées, puis vide le lot. À appeler avant tout accès aux
+    // particules réservées (pool.Update, snapshot).
+    void Execute(ParticlePool& pool);
+
+    bool Empty() const { return writes.empty(); }
+    const Stats& GetStats() const { return stats; }
+
+private:
+    struct Write {
+        std::shared_ptr<const EmissionRecipe> recipe;
+        size_t branch = 0;
+        uint16_t paramsIndex = 0;
+        glm::vec3 position = glm::vec3(0.0f);
+        int spawnIndex = 0;   // premier spawn de la plage
+        ParticleSpan span;
+        EmissionTransform transform;
+        bool transformed = false;
+    };
+
+    struct Chunk {
+        uint32_t write = 0;   // index dans writes
+        int offset = 0;       // dans write.span
+        int count = 0;
+    };
+
+    void RunChunk(const Chunk& chunk, ParticlePool& pool) const;
+
+    int threadCount;
+    int maxWorkers;       // threadCount résolu (hardware_concurrency pour 0)
+    ParallelFor parallelFor;
+    std::vector<Write> writes;
+    std::vector<Chunk> chunks;
+    size_t reserved;
+    Stats stats;
+};
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 #include "FireworkInstance.h"
@@ -9,6 +11,10 @@ FireworkInstance::FireworkInstance()
     , triggerTime(0.0f)
     , triggered(false)
     , finished(false)
+    , ownerId(ParticlePool::kNoOwner)
+    , sourceId(0)
+    , transformed(false)
+    , countScale(1.0f)
 {
 }
 
@@ -18,6 +24,10 @@ FireworkInstance::FireworkInstance(const FireworkTemplate* tmpl, const glm::vec3
     , triggerTime(trigTime)
     , triggered(false)
     , finished(false)
+    , ownerId(ParticlePool::kNoOwner)
+    , sourceId(0)
+    , transformed(false)
+    , countScale(1.0f)
 {
     (void)fireworkTemplate;
 }
@@ -26,35 +36,105 @@ FireworkInstance::~FireworkInstance()
 {
 }
 
-void FireworkInstance::Update(float currentTime, float deltaTime, ParticlePool& pool)
+void FireworkInstance::Reset(const FireworkTemplate* tmpl, const glm::vec3& pos, float trigTime)
+{
+    fireworkTemplate = tmpl;
+    position = pos;
+    triggerTime = trigTime;
+    triggered = false;
+    finished = false;
+    sourceId = 0;
+    transformed = false;
+    countScale = 1.0f;
+    recipe.reset();
+    emitters.clear();
+}
+
+void FireworkInstance::SetOverride(const TemplateOverride& o)
+{
+    transformed = (o.rotation != glm::vec3(0.0f) || o.tint != glm::vec4(1.0f) || o.scale != 1.0f);
+    transform = transformed ? EmissionTransform::From(o) : EmissionTransform();
+    countScale = std::clamp(o.countScale, 0.0f, 1.0f);
+}
+
+int FireworkInstance::Thin(BranchEmitter& e, int due, float keepRatio)
+{
+    // La partie fractionnaire est reportée : sur plusieurs pas, la branche garde exactement
+    // keepRatio de ses spawns.
+    e.keepCarry += static_cast<float>(due) * std::max(0.0f, keepRatio);
+    const int keep = std::min(due, static_cast<int>(e.keepCarry));
+    e.keepCarry -= static_cast<float>(keep);
+    return keep;
+}
+
+int FireworkInstance::EmitRange(size_t branch, uint16_t paramsIndex, ParticlePool& pool, int spawnIndex, int count, EmissionBatch* batch)
+{
+    const EmissionTransform* t = transformed ? &transform : nullptr;
+    if (batch) return batch->Reserve(recipe, branch, paramsIndex, position, pool, spawnIndex, count, t);
+    return recipe->Emit(branch, paramsIndex, position, pool, spawnIndex, count, t);
+}
+
+// Demande après la part de l'événement (arrondie au-dessus : le budget ne manque jamais).
+static uint32_t ScaleDemand(uint32_t demand, float countScale)
+{
+    if (countScale >= 1.0f) return demand;
+    return static_cast<uint32_t>(std::ceil(static_cast<float>(demand) * countScale));
+}
+
+uint32_t FireworkInstance::GetEmissionDemand(float currentTime, float deltaTime) const
+{
+    if (finished || !fireworkTemplate) return 0;
+
+    const float dt = (deltaTime > 0.0f) ? deltaTime : 0.0f;
+    uint32_t demand = 0;
+
+    if (!triggered) {
+        if (currentTime < triggerTime) return 0;
+        // Déclenché ce pas : toutes les branches partent de zéro.
+        const std::shared_ptr<const EmissionRecipe> r = fireworkTemplate->GetEmissionRecipe();
+        if (!r) return 0;
+        for (const auto& b : r->GetBranches()) {
+            const int count = b.prepared.particleCount;
+            if (!b.prepared.params || count <= 0) continue;
+            const int due = (b.interval <= 0.0f) ? count : std::min(count, static_cast<int>(dt / b.interval));
+            demand += static_cast<uint32_t>(due);
+        }
+        return ScaleDemand(demand, countScale);
+    }
+
+    for (const auto& e : emitters) {
+        if (e.done) continue;
+        const EmissionRecipe::Branch& b = recipe->GetBranches()[e.branch];
+        const int count = b.prepared.particleCount;
+        if (!b.prepared.params || count <= 0) continue;
+        const int due = (b.interval <= 0.0f)
+            ? count - e.emitted
+            : std::min(count - e.emitted, static_cast<int>((e.accum + dt) / b.interval));
+        if (due > 0) demand += static_cast<uint32_t>(due);
+    }
+    return ScaleDemand(demand, countScale);
+}
+
+void FireworkInstance::Update(float currentTime, float deltaTime, ParticlePool& pool, float keepRatio, EmissionBatch* batch)
 {
     if (finished || !fireworkTemplate) {
         return;
     }
 
     const float dt = (deltaTime > 0.0f) ? deltaTime : 0.0f;
+    // La part de l'événement s'amincit comme celle du budget (même report de fraction).
+    keepRatio *= countScale;
 
     // Déclenchement : initialiser les émetteurs, mais ne pas tout burst systématiquement.
     if (!triggered && currentTime >= triggerTime) {
         std::cout << "[FireworkInstance] Triggering " << fireworkTemplate->name
             << " with " << fireworkTemplate->GetBranchCount() << " branches\n";
 
+        recipe = fireworkTemplate->GetEmissionRecipe();
         emitters.clear();
-        emitters.reserve(fireworkTemplate->generatedBranches.size());
-        for (const auto& b : fireworkTemplate->generatedBranches) {
-            BranchEmitter e;
-            e.branch = &b;
-            e.emitted = 0;
-            e.accum = 0.0f;
-            // 0 = burst. Otherwise, distribute spawns over emissionDuration.
-            if (b.emissionDuration > 0.0f && b.particlesPerBranch > 0) {
-                e.interval = b.emissionDuration / static_cast<float>(b.particlesPerBranch);
-                if (e.interval < 1.0f / 240.0f) e.interval = 1.0f / 240.0f;
-            } else {
-                e.interval = 0.0f;
-            }
-            e.done = false;
-            emitters.push_back(e);
+        if (recipe) {
+            emitters.resize(recipe->GetBranches().size());
+            for (size_t i = 0; i < emitters.size(); ++i) emitters[i].branch = i;
         }
 
         triggered = true;
@@ -65,32 +145,49 @@ void FireworkInstance::Update(float currentTime, float deltaTime, ParticlePool&
     // Update emission
     bool allDone = true;
     for (auto& e : emitters) {
-        if (!e.branch || e.done) continue;
-        const auto& b = *e.branch;
+        if (e.done) continue;
+        const EmissionRecipe::Branch& b = recipe->GetBranches()[e.branch];
+        const int count = b.prepared.particleCount;
+        if (!b.prepared.params || count <= 0) {
+            e.done = true;
+            continue;
+        }
 
-        // Burst mode
-        if (e.interval <= 0.0f) {
+        // Burst mode: the whole branch is a straight copy of the recipe tables.
+        if (b.interval <= 0.0f) {
             if (e.emitted == 0) {
-                BranchGenerator::EmitBranch(b, fireworkTemplate->physics, position, pool);
-                e.emitted = b.particlesPerBranch;
+                const uint16_t paramsIndex = pool.InternEmitterParams(b.prepared.emitterParams);
+                // Thinned: the recipe spawns are independent draws, the first ones are a fair sample.
+                const int keep = (keepRatio < 1.0f) ? Thin(e, count, keepRatio) : count;
+                if (keep > 0) EmitRange(e.branch, paramsIndex, pool, 0, keep, batch);
+                e.emitted = count;
             }
             e.done = true;
             continue;
         }
 
-        // Timed emission
+        // Timed emission: every spawn due this step goes out as one batch.
         e.accum += dt;
-        while (e.emitted < b.particlesPerBranch && e.accum >= e.interval) {
-            e.accum -= e.interval;
-            const int idx = BranchGenerator::EmitParticle(b, fireworkTemplate->physics, position, pool, e.emitted, b.particlesPerBranch);
-            if (idx < 0) {
-                // pool full: stop trying this frame
-                break;
+        const int due = std::min(count - e.emitted, static_cast<int>(e.accum / b.interval));
+        if (due > 0 && keepRatio < 1.0f) {
+            // Budget: emit a share of the due spawns, the others are dropped (not delayed).
+            const int keep = Thin(e, due, keepRatio);
+            if (keep > 0) {
+                const uint16_t paramsIndex = pool.InternEmitterParams(b.prepared.emitterParams);
+                EmitRange(e.branch, paramsIndex, pool, e.emitted, keep, batch);
             }
-            e.emitted++;
+            e.accum -= b.interval * static_cast<float>(due);
+            e.emitted += due;
+        }
+        else if (due > 0) {
+            const uint16_t paramsIndex = pool.InternEmitterParams(b.prepared.emitterParams);
+            const int emitted = EmitRange(e.branch, paramsIndex, pool, e.emitted, due, batch);
+            // pool full: the failed spawn still used its slot, the rest waits for next frame
+            e.accum -= b.interval * static_cast<float>(std::min(due, emitted + 1));
+            e.emitted += emitted;
         }
 
-        if (e.emitted >= b.particlesPerBranch) {
+        if (e.emitted >= count) {
             e.done = true;
         } else {
             allDone = false;
@@ -99,6 +196,9 @@ void FireworkInstance::Update(float currentTime, float deltaTime, ParticlePool&
 
     if (allDone) {
         finished = true;
+        // Plus rien à émettre : libère les tables (le template a pu changer depuis).
+        recipe.reset();
+        emitters.clear();
         std::cout << "[FireworkInstance] Emission finished. Total particles active: "
             << pool.GetActiveCount() << "\n";
     }
@@ -1,10 +1,14 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <memory>
 #include <vector>
 #include "../template/FireworkTemplate.h"
 #include "../particle/ParticlePool.h"
 #include "../template/PhysicsProfile.h"
+#include "../simulation/EmissionRecipe.h"
+#include "../template/TemplateOverride.h"
+#include "EmissionBatch.h"
 
 class FireworkInstance {
 private:
@@ -14,25 +18,62 @@ private:
     bool triggered;
 
     struct BranchEmitter {
-        const GeneratedBranch* branch = nullptr;
+        size_t branch = 0;     // index dans recipe->GetBranches()
         int emitted = 0;
         float accum = 0.0f;
-        float interval = 0.0f; // seconds between spawns; 0 => burst
+        float keepCarry = 0.0f; // part fractionnaire des spawns gardés (keepRatio < 1)
         bool done = false;
     };
 
+    // Tables d'émission du template au déclenchement (gardées en vie jusqu'à la fin)
+    std::shared_ptr<const EmissionRecipe> recipe;
     std::vector<BranchEmitter> emitters;
     bool finished;
 
+    // Nombre de spawns gardés sur due (keepRatio < 1), avec report de la fraction.
+    static int Thin(BranchEmitter& e, int due, float keepRatio);
+
+    // recipe->Emit, ou réservation dans batch (remplie plus tard) si batch est fourni.
+    int EmitRange(size_t branch, uint16_t paramsIndex, ParticlePool& pool, int spawnIndex, int count, EmissionBatch* batch);
+
+    uint32_t ownerId; // Particle::owner de ses particules (attribué par InstanceManager)
+    uint32_t sourceId; // FireworkEvent::id qui l'a lancée (0 = aucun)
+
+    // Réglages de l'événement (template partagé, voir TemplateOverride)
+    EmissionTransform transform;
+    bool transformed;  // false => tables de la recette telles quelles
+    float countScale;  // part des spawns gardés, composée avec le keepRatio du budget
+
 public:
     FireworkInstance();
     FireworkInstance(const FireworkTemplate* tmpl, const glm::vec3& pos, float trigTime);
     ~FireworkInstance();
 
-    void Update(float currentTime, float deltaTime, ParticlePool& pool);
+    // Réinitialise une instance recyclée (garde la capacité des émetteurs).
+    void Reset(const FireworkTemplate* tmpl, const glm::vec3& pos, float trigTime);
+
+    // Réglages propres à l'événement, appliqués à chaque émission. Avant le déclenchement.
+    void SetOverride(const TemplateOverride& o);
+
+    // keepRatio < 1 (ParticleBudget) : seule cette fraction des spawns dus est émise, le
+    // reste est abandonné ; chaque branche est amincie de la même façon.
+    // batch (optionnel) : les particules sont seulement réservées, EmissionBatch::Execute()
+    // les remplit ; allocation et compteurs sont ceux d'une émission directe.
+    void Update(float currentTime, float deltaTime, ParticlePool& pool, float keepRatio = 1.0f,
+                EmissionBatch* batch = nullptr);
+
+    // Spawns que Update(currentTime, deltaTime) voudrait émettre (sans rien modifier).
+    uint32_t GetEmissionDemand(float currentTime, float deltaTime) const;
 
     inline bool IsTriggered() const { return triggered; }
     inline bool IsFinished() const { return finished; }
     inline const glm::vec3& GetPosition() const { return position; }
     inline float GetTriggerTime() const { return triggerTime; }
+    inline const FireworkTemplate* GetTemplate() const { return fireworkTemplate; }
+
+    inline uint32_t GetOwnerId() const { return ownerId; }
+    inline void SetOwnerId(uint32_t id) { ownerId = id; }
+
+    inline uint32_t GetSourceId() const { return sourceId; }
+    inline void SetSourceId(uint32_t id) { sourceId = id; }
 };
\ No newline at end of file
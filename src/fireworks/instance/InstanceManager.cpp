@@ -3,59 +3,142 @@
 #include "InstanceManager.h"
 
 InstanceManager::InstanceManager()
+    : nextOwnerId(ParticlePool::kNoOwner + 1)
+    , soloCount(0)
 {
 }
 
 InstanceManager::~InstanceManager()
 {
     Clear();
+    for (auto* instance : freeInstances) {
+        delete instance;
+    }
+    freeInstances.clear();
+}
+
+FireworkInstance* InstanceManager::Spawn(const FireworkTemplate* tmpl, const glm::vec3& position, float triggerTime,
+                                         uint32_t sourceId, const TemplateOverride& overrides)
+{
+    FireworkInstance* instance = nullptr;
+    if (!freeInstances.empty()) {
+        // L'objet recyclé garde son identifiant : son compteur est à zéro depuis sa retraite.
+        instance = freeInstances.back();
+        freeInstances.pop_back();
+        instance->Reset(tmpl, position, triggerTime);
+    } else {
+        instance = new FireworkInstance(tmpl, position, triggerTime);
+        instance->SetOwnerId(nextOwnerId++);
+    }
+    instance->SetSourceId(sourceId);
+    instance->SetOverride(overrides);
+    instances.push_back(instance);
+    return instance;
 }
 
 void InstanceManager::AddInstance(FireworkInstance* instance)
 {
     if (instance) {
+        instance->SetOwnerId(nextOwnerId++);
         instances.push_back(instance);
     }
 }
 
 void InstanceManager::Update(float currentTime, float deltaTime, ParticlePool& pool)
 {
-    // Update toutes les instances
+    // Demande de ce pas, puis part de chaque instance si le pool ne suffit pas
+    uint32_t demand = 0;
+    for (const auto* instance : instances) {
+        if (instance) demand += instance->GetEmissionDemand(currentTime, deltaTime);
+    }
+    const float keepRatio = budget.Plan(pool, demand);
+
+    // Update toutes les instances. En parallèle, elles ne font que réserver leurs plages
+    // (série, même ordre), remplies ensuite par le lot.
+    EmissionBatch* batch = emission.IsParallel() ? &emission : nullptr;
     for (auto* instance : instances) {
         if (instance) {
-            instance->Update(currentTime, deltaTime, pool);
+            // Un propriétaire recyclé reprend la visibilité de sa nouvelle source.
+            pool.SetOwnerHidden(instance->GetOwnerId(), IsSourceHidden(instance->GetSourceId()));
+            pool.SetEmitOwner(instance->GetOwnerId());
+            instance->Update(currentTime, deltaTime, pool, keepRatio, batch);
         }
     }
+    pool.SetEmitOwner(ParticlePool::kNoOwner);
+    if (batch) batch->Execute(pool);
+
+    CleanupCompleted(pool);
 }
 
-void InstanceManager::CleanupCompleted()
+void InstanceManager::CleanupCompleted(const ParticlePool& pool)
 {
-    // Supprimer les instances déclenchées depuis longtemps
-    // (on pourrait vérifier si toutes leurs particules sont mortes)
-
-    auto it = instances.begin();
-    while (it != instances.end()) {
-        FireworkInstance* instance = *it;
-
-        // Critère simple : instance déclenchée depuis plus de 10 secondes
-        if (instance && instance->IsTriggered()) {
-            // TODO: vérifier que toutes les particules sont mortes
-            // Pour l'instant, on garde toutes les instances
-            ++it;
-        }
-        else {
-            ++it;
-        }
-    }
+    // Émission terminée + plus aucune particule vivante => instance retirée
+    auto it = std::remove_if(instances.begin(), instances.end(), [this, &pool](FireworkInstance* instance) {
+        if (!instance) return true;
+        if (!instance->IsFinished() || pool.GetOwnerLiveCount(instance->GetOwnerId()) > 0) return false;
+        Recycle(instance);
+        return true;
+    });
+    instances.erase(it, instances.end());
+}
 
-    // Version simple : ne rien supprimer automatiquement
-    // L'utilisateur peut Clear() manuellement
+void InstanceManager::Recycle(FireworkInstance* instance)
+{
+    // Lâche template / tables tout de suite : l'instance peut rester longtemps en réserve.
+    instance->Reset(nullptr, glm::vec3(0.0f), 0.0f);
+    freeInstances.push_back(instance);
 }
 
 void InstanceManager::Clear()
 {
     for (auto* instance : instances) {
-        delete instance;
+        if (instance) Recycle(instance);
     }
     instances.clear();
-}
\ No newline at end of file
+    sourceFlags.clear();
+    soloCount = 0;
+}
+
+size_t InstanceManager::KillSource(uint32_t sourceId, ParticlePool& pool)
+{
+    if (sourceId == kNoSource) return 0;
+
+    size_t killed = 0;
+    auto it = std::remove_if(instances.begin(), instances.end(), [this, sourceId, &pool, &killed](FireworkInstance* instance) {
+        if (!instance || instance->GetSourceId() != sourceId) return false;
+        killed += pool.KillOwner(instance->GetOwnerId());
+        Recycle(instance);
+        return true;
+    });
+    instances.erase(it, instances.end());
+    return killed;
+}
+
+void InstanceManager::SetSourceVisibility(uint32_t sourceId, bool muted, bool solo)
+{
+    if (sourceId == kNoSource) return;
+
+    uint8_t flags = 0;
+    if (muted) flags |= kSourceMuted;
+    if (solo) flags |= kSourceSolo;
+
+    auto it = sourceFlags.find(sourceId);
+    const uint8_t previous = (it != sourceFlags.end()) ? it->second : 0u;
+    if (previous == flags) return;
+
+    if (previous & kSourceSolo) --soloCount;
+    if (flags & kSourceSolo) ++soloCount;
+
+    if (flags == 0) sourceFlags.erase(it);
+    else sourceFlags[sourceId] = flags;
+}
+
+bool InstanceManager::IsSourceHidden(uint32_t sourceId) const
+{
+    if (sourceFlags.empty()) return false;
+
+    auto it = sourceFlags.find(sourceId);
+    const uint8_t flags = (it != sourceFlags.end()) ? it->second : 0u;
+    if (flags & kSourceMuted) return true;
+    return soloCount > 0 && !(flags & kSourceSolo);
+}
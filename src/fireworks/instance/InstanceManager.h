@@ -1,33 +1,88 @@
 #pragma once
 
+#include <cstdint>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 #include "FireworkInstance.h"
+#include "EmissionBatch.h"
+#include "ParticleBudget.h"
 #include "../particle/ParticlePool.h"
 
 // Gestionnaire d'instances de feux d'artifice
 // Gère plusieurs FireworkInstance simultanément
+//
+// Chaque instance reçoit un identifiant de propriétaire : le pool compte ses particules
+// vivantes (ParticlePool::GetOwnerLiveCount). Une instance dont l'émission est terminée et
+// dont la dernière particule (smoke / récursion comprises) est morte est retirée pendant
+// Update() et recyclée : le coût par frame suit les feux vivants, pas tous ceux lancés.
+//
+// Une instance peut aussi porter l'identifiant de sa source (FireworkEvent::id) : l'éditeur
+// tue (KillSource) ou masque (SetSourceVisibility) tout ce qu'un événement a lancé pendant
+// la lecture, au coût des seules particules concernées.
 class InstanceManager {
 public:
+    // Source des instances lancées hors d'un événement de scène.
+    static constexpr uint32_t kNoSource = 0;
+
     InstanceManager();
     ~InstanceManager();
 
-    // Ajoute une nouvelle instance
+    // Lance une instance (recyclée si possible) et retourne-la. overrides : réglages de
+    // l'événement appliqués à l'émission (le template reste partagé).
+    FireworkInstance* Spawn(const FireworkTemplate* tmpl, const glm::vec3& position, float triggerTime,
+                            uint32_t sourceId = kNoSource, const TemplateOverride& overrides = TemplateOverride());
+
+    // Ajoute une nouvelle instance (prend possession)
     void AddInstance(FireworkInstance* instance);
 
-    // Update toutes les instances actives
+    // Update toutes les instances actives, puis retire celles qui sont terminées.
+    // Si leur demande d'émission dépasse la place libre du pool, le budget décide qui cède.
     void Update(float currentTime, float deltaTime, ParticlePool& pool);
 
-    // Supprime les instances complètes
-    void CleanupCompleted();
+    // Retire les instances terminées sans particule vivante dans pool
+    void CleanupCompleted(const ParticlePool& pool);
 
-    // Supprime toutes les instances
+    // Supprime toutes les instances (recyclées) et oublie les mute / solo
     void Clear();
 
+    // Retire immédiatement les instances de sourceId et tue leurs particules (smoke /
+    // récursion comprises). Retourne le nombre de particules tuées.
+    size_t KillSource(uint32_t sourceId, ParticlePool& pool);
+
+    // Mute / solo d'une source : appliqué aux propriétaires dans le pool au prochain Update()
+    // (ParticlePool::SetOwnerHidden). Dès qu'une source est en solo, seules les sources en
+    // solo restent visibles.
+    void SetSourceVisibility(uint32_t sourceId, bool muted, bool solo);
+    bool IsSourceHidden(uint32_t sourceId) const;
+
     // Getters
     size_t GetActiveCount() const { return instances.size(); }
+    size_t GetPooledCount() const { return freeInstances.size(); }
     const std::vector<FireworkInstance*>& GetInstances() const { return instances; }
 
+    ParticleBudget& GetBudget() { return budget; }
+    const ParticleBudget& GetBudget() const { return budget; }
+
+    // Remplissage des particules émises pendant Update() : 1 = série, sur place (défaut),
+    // 0 = tous les coeurs, N = au plus N threads. Un final où des dizaines d'instances se
+    // déclenchent au même pas est alors copié en parallèle (résultat identique).
+    void SetEmissionThreads(int threads) { emission.SetThreadCount(threads); }
+    // Remplissage confié à un ordonnanceur externe plutôt qu'à des threads lancés à chaque pas.
+    void SetEmissionParallelFor(EmissionBatch::ParallelFor fn) { emission.SetParallelFor(std::move(fn)); }
+    const EmissionBatch::Stats& GetEmissionStats() const { return emission.GetStats(); }
+
 private:
-    std::vector<FireworkInstance*> instances;
-};
\ No newline at end of file
+    void Recycle(FireworkInstance* instance);
+
+    std::vector<FireworkInstance*> instances;     // vivantes
+    std::vector<FireworkInstance*> freeInstances; // retirées, prêtes à être réutilisées
+    uint32_t nextOwnerId;
+
+    enum SourceFlags : uint8_t { kSourceMuted = 1u << 0, kSourceSolo = 1u << 1 };
+    std::unordered_map<uint32_t, uint8_t> sourceFlags; // sources non neutres uniquement
+    size_t soloCount;
+
+    ParticleBudget budget;
+    EmissionBatch emission;
+};
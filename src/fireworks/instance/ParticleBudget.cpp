@@ -0,0 +1,96 @@
+#include <algorithm>
+
+#include "ParticleBudget.h"
+
+ParticleBudget::ParticleBudget()
+    : policy(Policy::Thin)
+{
+}
+
+const char* ParticleBudget::PolicyName(Policy p)
+{
+    switch (p) {
+    case Policy::Truncate: return "off";
+    case Policy::Thin: return "thin";
+    case Policy::SecondaryFirst: return "secondary";
+    case Policy::EvictOldest: return "evict";
+    }
+    return "off";
+}
+
+bool ParticleBudget::ParsePolicy(const std::string& name, Policy& out)
+{
+    for (Policy p : { Policy::Truncate, Policy::Thin, Policy::SecondaryFirst, Policy::EvictOldest }) {
+        if (name == PolicyName(p)) {
+            out = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+float ParticleBudget::Plan(ParticlePool& pool, uint32_t demand)
+{
+    // Les pertes d'effets secondaires datent du pool.Update() du pas précédent.
+    const ParticlePool::PressureStats& pressure = pool.GetPressureStats();
+    stats = Stats();
+    stats.smokeDropped = pressure.smokeDropped;
+    stats.recursionDropped = pressure.recursionDropped;
+    pool.ResetPressureStats();
+
+    if (policy == Policy::SecondaryFirst) {
+        const float capacity = static_cast<float>(pool.GetCapacity());
+        pool.SetSecondaryReserve(static_cast<size_t>(capacity * kSmokeReserve), static_cast<size_t>(capacity * kRecursionReserve));
+    } else {
+        pool.SetSecondaryReserve(0, 0);
+    }
+
+    stats.demand = demand;
+    size_t headroom = pool.GetFreeCount();
+    stats.headroom = static_cast<uint32_t>(headroom);
+
+    if (demand <= headroom) {
+        stats.granted = demand;
+        Accumulate();
+        return 1.0f;
+    }
+
+    switch (policy) {
+    case Policy::Thin: {
+        stats.keepRatio = static_cast<float>(headroom) / static_cast<float>(demand);
+        stats.granted = static_cast<uint32_t>(headroom);
+        stats.thinned = demand - stats.granted;
+        Accumulate();
+        return stats.keepRatio;
+    }
+
+    case Policy::EvictOldest: {
+        const size_t cap = static_cast<size_t>(static_cast<float>(pool.GetActiveCount()) * kMaxEvictFraction);
+        const size_t wanted = std::min(static_cast<size_t>(demand) - headroom, cap);
+        stats.evicted = static_cast<uint32_t>(pool.EvictNearlyDead(wanted));
+        headroom = pool.GetFreeCount();
+        stats.granted = static_cast<uint32_t>(std::min(static_cast<size_t>(demand), headroom));
+        Accumulate();
+        return 1.0f; // le reste attend le pas suivant
+    }
+
+    case Policy::Truncate:
+    case Policy::SecondaryFirst:
+        break;
+    }
+
+    stats.granted = static_cast<uint32_t>(headroom);
+    Accumulate();
+    return 1.0f;
+}
+
+void ParticleBudget::Accumulate()
+{
+    totals.demand += stats.demand;
+    totals.granted += stats.granted;
+    totals.thinned += stats.thinned;
+    totals.evicted += stats.evicted;
+    totals.smokeDropped += stats.smokeDropped;
+    totals.recursionDropped += stats.recursionDropped;
+    totals.keepRatio = std::min(totals.keepRatio, stats.keepRatio);
+}
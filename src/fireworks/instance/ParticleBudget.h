@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "../particle/ParticlePool.h"
+
+// Répartit la place libre du pool entre les instances quand il sature.
+//
+// À chaque pas, InstanceManager additionne la demande d'émission de ses instances
+// (FireworkInstance::GetEmissionDemand) et demande à Plan() quelle fraction garder. Selon la
+// politique, un final trop gros est dégradé uniformément (toutes les gerbes amincies), les
+// effets secondaires cèdent leur place aux obus, ou les particules les plus proches de la
+// mort sont libérées ; sans politique, le premier servi prend tout (comportement historique).
+class ParticleBudget {
+public:
+    enum class Policy : uint8_t {
+        Truncate,       // historique : émission interrompue quand le pool est plein
+        Thin,           // chaque branche émet la même fraction de ses spawns
+        SecondaryFirst, // fumée, puis étincelles de récursion, coupées avant les obus
+        EvictOldest,    // libère les particules en fin de vie pour faire de la place
+    };
+
+    // Décisions du dernier pas (compteurs du profiler).
+    struct Stats {
+        uint32_t demand = 0;           // spawns demandés par les instances
+        uint32_t headroom = 0;         // slots libres avant émission
+        uint32_t granted = 0;          // spawns accordés
+        uint32_t thinned = 0;          // spawns abandonnés par Thin
+        uint32_t evicted = 0;          // particules libérées par EvictOldest
+        uint32_t smokeDropped = 0;     // fumée non émise (pas précédent)
+        uint32_t recursionDropped = 0; // étincelles non émises (pas précédent)
+        float keepRatio = 1.0f;
+    };
+
+    // Part du pool que la fumée / la récursion laissent libre sous SecondaryFirst.
+    static constexpr float kSmokeReserve = 0.10f;
+    static constexpr float kRecursionReserve = 0.05f;
+    // EvictOldest ne libère jamais plus que cette part des particules vivantes par pas.
+    static constexpr float kMaxEvictFraction = 0.5f;
+
+    ParticleBudget();
+
+    void SetPolicy(Policy p) { policy = p; }
+    Policy GetPolicy() const { return policy; }
+
+    static const char* PolicyName(Policy p);
+    // "off" | "thin" | "secondary" | "evict". false si le nom est inconnu.
+    static bool ParsePolicy(const std::string& name, Policy& out);
+
+    // Appelé avant l'émission du pas. Configure les réserves du pool, libère de la place si
+    // la politique le veut, et retourne la fraction de sa demande que chaque instance émet.
+    float Plan(ParticlePool& pool, uint32_t demand);
+
+    const Stats& GetStats() const { return stats; }
+
+    // Cumul depuis la création / ResetTotals() ; keepRatio = plus petite fraction accordée.
+    const Stats& GetTotals() const { return totals; }
+    void ResetTotals() { totals = Stats(); }
+
+private:
+    void Accumulate();
+
+    Policy policy;
+    Stats stats;
+    Stats totals;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// Paramètres constants pour toutes les particules d'un même émetteur (branche d'un template,
+// fumée, émetteur générique). Le pool les stocke dans une petite table dédupliquée et chaque
+// Particle ne garde qu'un index 16 bits (Particle::paramsIndex).
+struct EmitterParams {
+    // ═══ AUTEUR (comparés pour la déduplication) ═══
+    float gravityScale = 0.35f;   // 0-1
+    float updraft = 0.5f;         // m/s^2 (accélération verticale additionnelle)
+
+    bool  shouldFade = true;
+    float fadeStartRatio = 0.7f;  // À quel % de vie commence le fade (0-1)
+
+    bool  trailEnabled = false;
+    float trailWidth = 0.02f;
+    float trailDuration = 0.35f;
+    float trailOpacity = 0.15f;
+    float trailFalloffPow = 2.0f;
+    float trailSamplePeriod = 1.0f / 60.0f;
+
+    float smokeAmount = 0.0f;     // 0-1
+    float recursionProb = 0.0f;   // 0-1
+    float recursionChildren = 6.0f; // étincelles par gerbe, en moyenne (partie fractionnaire tirée)
+
+    // ═══ DÉRIVÉS (calculés par ParticlePool::InternEmitterParams) ═══
+    glm::vec3 gravity = glm::vec3(0.0f);  // g * gravityScale + updraft
+    bool trailSampling = false;           // trail actif avec durée / période valides
+    uint16_t childIndex = 0;              // paramètres des étincelles de récursion
+
+    bool SameAuthoring(const EmitterParams& o) const
+    {
+        return gravityScale == o.gravityScale && updraft == o.updraft
+            && shouldFade == o.shouldFade && fadeStartRatio == o.fadeStartRatio
+            && trailEnabled == o.trailEnabled && trailWidth == o.trailWidth
+            && trailDuration == o.trailDuration && trailOpacity == o.trailOpacity
+            && trailFalloffPow == o.trailFalloffPow && trailSamplePeriod == o.trailSamplePeriod
+            && smokeAmount == o.smokeAmount && recursionProb == o.recursionProb
+            && recursionChildren == o.recursionChildren;
+    }
+};
@@ -3,6 +3,8 @@
 #include <cstdint>
 #include <glm/glm.hpp>
 
+// Les paramètres communs à l'émetteur (gravité, fade, trail, smoke / récursion) vivent
+// dans la table EmitterParams du pool : voir ParticlePool::GetEmitterParams(paramsIndex).
 struct Particle {
     glm::vec3 position;
     glm::vec3 velocity;
@@ -11,41 +13,22 @@ struct Particle {
     float lifeTime;            // Durée de vie restante
     float originalLifeTime;    // Durée de vie d'origine
     float size;                // Taille en pixels
-    bool active;
-    uint16_t shapeId;          // Index dans ShapeRegistry
-
-    // Fade settings
-    bool shouldFade;           // Active le fade avancé
-    float fadeStartRatio;      // À quel % de vie commence le fade (0-1)
 
-    // Physique (drag linéaire, 1/s)
+    // Physique (drag linéaire, 1/s) : varie par particule (dampingVariance)
     float damping;
 
-    // Gravité (contrôle artistique)
-    float gravityScale;   // 0-1
-    float updraft;        // m/s^2 (accélération verticale additionnelle)
+    // Trail (ruban) : état de l'échantillonnage
+    float trailSampleAccum;
 
-    // ═══════════════════════════════════════════════════════════
-    // PHASE BRANCHE (NOUVEAU)
-    // ═══════════════════════════════════════════════════════════
-    bool inBranchPhase;        // true pendant branchDuration
-    float branchPhaseTime;     // Temps restant dans phase branche
+    // Instance émettrice (ParticlePool::kNoOwner sinon) ; smoke / récursion en héritent
+    uint32_t owner;
 
-    // Trail (ruban)
-    bool  trailEnabled;
-    float trailWidth;
-    float trailDuration;
-    float trailOpacity;
-    float trailFalloffPow;
-    float trailSamplePeriod;
-    float trailSampleAccum;
+    uint16_t shapeId;          // Index dans ShapeRegistry
+    uint16_t paramsIndex;      // Index dans la table EmitterParams du pool
     uint8_t trailHead;
     uint8_t trailCount;
-
-    // Smoke / recursion
-    float smokeAmount;
-    int   recursionDepthRemaining;
-    float recursionProb;
+    uint8_t recursionDepthRemaining;
+    bool active;
 
     Particle()
         : position(0.0f, 0.0f, 0.0f)
@@ -55,27 +38,15 @@ struct Particle {
         , lifeTime(1.0f)
         , originalLifeTime(1.0f)
         , size(8.0f)
-        , active(false)
-        , shapeId(0)
-        , shouldFade(true)
-        , fadeStartRatio(0.7f)
         , damping(0.0f)
-        , gravityScale(0.35f)
-        , updraft(0.5f)
-        , inBranchPhase(false)
-        , branchPhaseTime(0.0f)
-        , trailEnabled(false)
-        , trailWidth(0.02f)
-        , trailDuration(0.35f)
-        , trailOpacity(0.15f)
-        , trailFalloffPow(2.0f)
-        , trailSamplePeriod(1.0f/60.0f)
         , trailSampleAccum(0.0f)
+        , owner(0)
+        , shapeId(0)
+        , paramsIndex(0)
         , trailHead(0)
         , trailCount(0)
-        , smokeAmount(0.0f)
         , recursionDepthRemaining(0)
-        , recursionProb(0.0f)
+        , active(false)
     {
     }
 };
\ No newline at end of file
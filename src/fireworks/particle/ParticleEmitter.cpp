@@ -2,7 +2,8 @@
 #include <random>
 #include <cmath>
 
-static std::mt19937 s_rng(std::random_device{}());
+// Per thread: the simulation thread and the preview worker emit concurrently.
+static thread_local std::mt19937 s_rng(std::random_device{}());
 
 // Constante pour 2*PI
 static const float TWO_PI = 2.0f * 3.14159265358979323846f;
@@ -47,9 +48,10 @@ std::vector<int> ParticleEmitter::Emit(const EmissionParams& params, ParticlePoo
         // Shape
         p.shapeId = params.shapeId;
 
-        // Fade
-        p.shouldFade = true;
-        p.fadeStartRatio = 0.7f;
+        // Fade par défaut (70 % de la vie), sans trail
+        p.paramsIndex = ParticlePool::kDefaultParams;
+        p.trailCount = 0;
+        p.recursionDepthRemaining = 0;
 
         // Activer
         p.active = true;
@@ -1,25 +1,140 @@
 ﻿#include <glm/glm.hpp>
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <random>
 
 #include "ParticlePool.h"
 
-static std::mt19937 s_poolRng(std::random_device{}());
+// Per thread: the simulation thread and the preview worker step pools concurrently.
+static thread_local std::mt19937 s_poolRng(std::random_device{}());
+
+static const glm::vec3 kBaseGravity(0.0f, -9.81f, 0.0f);
+
+static uint64_t HashEmitterAuthoring(const EmitterParams& e)
+{
+    // FNV-1a sur les champs auteur (ceux comparés par SameAuthoring)
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&h](float v) {
+        uint32_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        for (int b = 0; b < 4; ++b) {
+            h ^= (bits >> (8 * b)) & 0xFFu;
+            h *= 1099511628211ull;
+        }
+    };
+    mix(e.gravityScale); mix(e.updraft);
+    mix(e.shouldFade ? 1.0f : 0.0f); mix(e.fadeStartRatio);
+    mix(e.trailEnabled ? 1.0f : 0.0f); mix(e.trailWidth); mix(e.trailDuration);
+    mix(e.trailOpacity); mix(e.trailFalloffPow); mix(e.trailSamplePeriod);
+    mix(e.smokeAmount); mix(e.recursionProb); mix(e.recursionChildren);
+    return h;
+}
+
+static EmitterParams MakeSmokeParams()
+{
+    EmitterParams e;
+    e.gravityScale = 0.05f;
+    e.updraft = 0.8f;
+    e.trailEnabled = false;
+    e.shouldFade = true;
+    e.fadeStartRatio = 1.0f;
+    e.smokeAmount = 0.0f;
+    e.recursionProb = 0.0f;
+    return e;
+}
+
+// Étincelles de récursion : gardent le trail et la probabilité du parent.
+// Idempotent (enfant d'enfant == enfant), ce qui borne la table.
+static EmitterParams MakeRecursionChildParams(const EmitterParams& parent)
+{
+    EmitterParams e = parent;
+    e.gravityScale = 0.25f;
+    e.updraft = 0.2f;
+    e.shouldFade = true;
+    e.fadeStartRatio = 1.0f;
+    e.smokeAmount = 0.0f;
+    return e;
+}
 
 ParticlePool::ParticlePool(size_t maxParticles)
     : lastSearchIndex(0)
+    , highWater(0)
+    , version(0)
+    , liveCount(0)
+    , smokeReserve(0)
+    , recursionReserve(0)
+    , emitOwner(kNoOwner)
 {
     particles.resize(maxParticles);
 
     // Trail history buffer (SoA): capacity * kTrailSamples
     trailPositions.resize(maxParticles * ParticlePool::kTrailSamples, glm::vec3(0.0f));
 
+    // Chaînage par propriétaire (-1 = fin de liste)
+    ownerNext.resize(maxParticles, -1);
+    ownerPrev.resize(maxParticles, -1);
+
     // Initialiser toutes les particules comme inactives
     for (auto& p : particles)
     {
         p.active = false;
     }
+
+    ResetEmitterParams();
+}
+
+void ParticlePool::ResetEmitterParams()
+{
+    emitterParams.clear();
+    emitterParamsLookup.clear();
+    InternEmitterParams(EmitterParams());   // kDefaultParams
+    InternEmitterParams(MakeSmokeParams()); // kSmokeParams
+}
+
+uint16_t ParticlePool::InternEmitterParams(const EmitterParams& params)
+{
+    EmitterParams e = params;
+    e.smokeAmount = std::max(0.0f, std::min(1.0f, e.smokeAmount));
+    e.recursionProb = std::max(0.0f, std::min(1.0f, e.recursionProb));
+    e.recursionChildren = std::max(0.0f, std::min(static_cast<float>(kRecursionChildren), e.recursionChildren));
+
+    // Après une copie de table (snapshot / AssignFrom) l'index de recherche est à refaire.
+    if (emitterParamsLookup.size() != emitterParams.size())
+    {
+        emitterParamsLookup.clear();
+        for (size_t i = 0; i < emitterParams.size(); ++i)
+        {
+            emitterParamsLookup.emplace(HashEmitterAuthoring(emitterParams[i]), static_cast<uint16_t>(i));
+        }
+    }
+
+    const uint64_t h = HashEmitterAuthoring(e);
+    auto range = emitterParamsLookup.equal_range(h);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (emitterParams[it->second].SameAuthoring(e)) return it->second;
+    }
+
+    if (emitterParams.size() >= 0xFFFFu) return kDefaultParams;
+
+    // Dérivés : une fois par entrée plutôt qu'une fois par particule et par pas
+    e.gravity = kBaseGravity * e.gravityScale;
+    e.gravity.y += e.updraft;
+    e.trailSampling = e.trailEnabled && e.trailDuration > 0.0f && e.trailSamplePeriod > 0.0f;
+
+    const uint16_t index = static_cast<uint16_t>(emitterParams.size());
+    e.childIndex = index;
+    emitterParams.push_back(e);
+    emitterParamsLookup.emplace(h, index);
+
+    if (e.recursionProb > 0.0f)
+    {
+        const uint16_t child = InternEmitterParams(MakeRecursionChildParams(e));
+        emitterParams[index].childIndex = child;
+    }
+    return index;
 }
 
 const glm::vec3* ParticlePool::GetTrailBuffer(int particleIndex) const
@@ -34,7 +149,85 @@ glm::vec3* ParticlePool::GetTrailBuffer(int particleIndex)
     return &trailPositions[idx * ParticlePool::kTrailSamples];
 }
 
-int ParticlePool::Allocate()
+void ParticlePool::AttachOwner(int index, uint32_t owner)
+{
+    ++liveCount;
+    particles[index].owner = owner;
+    if (owner == kNoOwner) return;
+    if (owner >= ownerLiveCounts.size()) ownerLiveCounts.resize(static_cast<size_t>(owner) + 1, 0u);
+    if (owner >= ownerHeads.size()) ownerHeads.resize(static_cast<size_t>(owner) + 1, -1);
+    ++ownerLiveCounts[owner];
+
+    // Insertion en tête de la liste du propriétaire
+    const int head = ownerHeads[owner];
+    ownerPrev[index] = -1;
+    ownerNext[index] = head;
+    if (head >= 0) ownerPrev[head] = index;
+    ownerHeads[owner] = index;
+}
+
+void ParticlePool::DetachOwner(int index)
+{
+    Particle& p = particles[index];
+    if (liveCount > 0) --liveCount;
+    if (p.owner != kNoOwner && p.owner < ownerLiveCounts.size() && ownerLiveCounts[p.owner] > 0)
+    {
+        --ownerLiveCounts[p.owner];
+
+        const int prev = ownerPrev[index];
+        const int next = ownerNext[index];
+        if (prev >= 0) ownerNext[prev] = next;
+        else ownerHeads[p.owner] = next;
+        if (next >= 0) ownerPrev[next] = prev;
+        ownerPrev[index] = -1;
+        ownerNext[index] = -1;
+    }
+    p.owner = kNoOwner;
+}
+
+size_t ParticlePool::KillOwner(uint32_t owner)
+{
+    if (owner == kNoOwner || owner >= ownerHeads.size()) return 0;
+
+    // Seules les particules du propriétaire sont visitées (pas de balayage du pool).
+    size_t killed = 0;
+    int index = ownerHeads[owner];
+    while (index >= 0)
+    {
+        const int next = ownerNext[index];
+        Particle& p = particles[index];
+        p.active = false;
+        p.owner = kNoOwner;
+        p.trailCount = 0;
+        p.trailHead = 0;
+        p.trailSampleAccum = 0.0f;
+        ownerPrev[index] = -1;
+        ownerNext[index] = -1;
+        index = next;
+        ++killed;
+    }
+    ownerHeads[owner] = -1;
+    ownerLiveCounts[owner] = 0;
+    liveCount -= std::min(liveCount, killed);
+    if (killed > 0) ++version;
+    return killed;
+}
+
+void ParticlePool::SetOwnerHidden(uint32_t owner, bool hidden)
+{
+    if (owner == kNoOwner) return;
+    if (owner >= ownerHidden.size())
+    {
+        if (!hidden) return;
+        ownerHidden.resize(static_cast<size_t>(owner) + 1, 0u);
+    }
+    const uint8_t value = hidden ? 1u : 0u;
+    if (ownerHidden[owner] == value) return;
+    ownerHidden[owner] = value;
+    ++version; // le snapshot doit être recopié
+}
+
+int ParticlePool::FindFreeSlot()
 {
     const size_t capacity = particles.size();
 
@@ -44,6 +237,8 @@ int ParticlePool::Allocate()
         if (!particles[i].active)
         {
             lastSearchIndex = i;
+            if (i >= highWater) highWater = i + 1;
+            ++version;
             return static_cast<int>(i);
         }
     }
@@ -54,6 +249,8 @@ int ParticlePool::Allocate()
         if (!particles[i].active)
         {
             lastSearchIndex = i;
+            if (i >= highWater) highWater = i + 1;
+            ++version;
             return static_cast<int>(i);
         }
     }
@@ -62,10 +259,56 @@ int ParticlePool::Allocate()
     return -1;
 }
 
+int ParticlePool::Allocate()
+{
+    const int index = FindFreeSlot();
+    if (index >= 0) AttachOwner(index, emitOwner);
+    return index;
+}
+
+ParticleSpan ParticlePool::AllocateRange(int count)
+{
+    ParticleSpan span;
+    const size_t capacity = particles.size();
+    if (count <= 0 || capacity == 0) return span;
+
+    // Premier slot libre à partir de lastSearchIndex (avec retour au début)
+    size_t start = capacity;
+    for (size_t n = 0; n < capacity; ++n)
+    {
+        size_t i = lastSearchIndex + n;
+        if (i >= capacity) i -= capacity;
+        if (!particles[i].active)
+        {
+            start = i;
+            break;
+        }
+    }
+    if (start == capacity) return span; // Pool plein
+
+    size_t end = start;
+    const size_t wanted = static_cast<size_t>(count);
+    while (end < capacity && end - start < wanted && !particles[end].active)
+    {
+        particles[end].active = true;
+        AttachOwner(static_cast<int>(end), emitOwner);
+        ++end;
+    }
+
+    span.first = static_cast<int>(start);
+    span.count = static_cast<int>(end - start);
+    if (end > highWater) highWater = end;
+    lastSearchIndex = (end < capacity) ? end : 0;
+    ++version;
+    return span;
+}
+
 void ParticlePool::Free(int index)
 {
     if (index >= 0 && index < static_cast<int>(particles.size()))
     {
+        ++version;
+        if (particles[index].active) DetachOwner(index);
         particles[index].active = false;
         // Leave trail buffer as-is. trailCount gates rendering.
         particles[index].trailCount = 0;
@@ -74,28 +317,51 @@ void ParticlePool::Free(int index)
     }
 }
 
-size_t ParticlePool::GetActiveCount() const
+void ParticlePool::SetSecondaryReserve(size_t smoke, size_t recursion)
+{
+    smokeReserve = smoke;
+    recursionReserve = recursion;
+}
+
+int ParticlePool::SecondaryRoom(size_t reserve, int wanted) const
 {
-    size_t count = 0;
-    for (const auto& p : particles)
+    const size_t free = GetFreeCount();
+    if (wanted <= 0 || free <= reserve) return 0;
+    return static_cast<int>(std::min(static_cast<size_t>(wanted), free - reserve));
+}
+
+size_t ParticlePool::EvictNearlyDead(size_t count)
+{
+    if (count == 0 || liveCount == 0) return 0;
+
+    evictScratch.clear();
+    for (size_t i = 0; i < highWater; ++i)
     {
-        if (p.active)
-        {
-            ++count;
-        }
+        if (particles[i].active) evictScratch.push_back(static_cast<int>(i));
     }
+    if (count > evictScratch.size()) count = evictScratch.size();
+
+    // Sélection partielle (O(n)) : seules les count plus courtes vies restantes comptent.
+    std::nth_element(evictScratch.begin(), evictScratch.begin() + static_cast<long>(count) - 1, evictScratch.end(),
+        [this](int a, int b) { return particles[a].lifeTime < particles[b].lifeTime; });
+
+    // Pas d'effet de mort (smoke / récursion) : la place libérée est pour l'émission.
+    for (size_t n = 0; n < count; ++n) Free(evictScratch[n]);
     return count;
 }
 
 void ParticlePool::Update(float deltaTime)
 {
-    const glm::vec3 baseGravity(0.0f, -9.81f, 0.0f);
     const float dt = (deltaTime > 0.0f) ? deltaTime : 0.0f;
 
     for (size_t i = 0; i < particles.size(); ++i)
     {
         Particle& p = particles[i];
         if (!p.active) continue;
+        ++version; // an empty pool stays "unchanged" while stepping
+
+        // Pas de InternEmitterParams() dans cette boucle : la référence reste valide.
+        const EmitterParams& e = emitterParams[p.paramsIndex];
 
         p.lifeTime -= dt;
         if (p.lifeTime <= 0.0f)
@@ -105,30 +371,27 @@ void ParticlePool::Update(float deltaTime)
             const glm::vec3 deathPos = p.position;
 
             // Smoke as particles (renderer already supports particles).
-            float smoke = std::max(0.0f, std::min(1.0f, p.smokeAmount));
+            const float smoke = e.smokeAmount;
             if (smoke > 0.0f) {
                 const int count = static_cast<int>(3 + 12 * smoke);
+                const int room = SecondaryRoom(smokeReserve, count);
+                pressure.smokeDropped += static_cast<uint32_t>(count - room);
                 std::uniform_real_distribution<float> d(-1.0f, 1.0f);
-                for (int s = 0; s < count; ++s) {
-                    int si = Allocate();
+                for (int s = 0; s < room; ++s) {
+                    int si = FindFreeSlot();
                     if (si < 0) break;
                     Particle& sp = Get(si);
+                    AttachOwner(si, p.owner);
                     sp.active = true;
+                    sp.paramsIndex = kSmokeParams;
                     sp.position = deathPos;
                     sp.velocity = glm::vec3(d(s_poolRng), 0.6f + 0.4f * std::abs(d(s_poolRng)), d(s_poolRng)) * (0.25f + 0.35f * smoke);
                     sp.damping = 1.5f + 2.5f * smoke;
-                    sp.gravityScale = 0.05f;
-                    sp.updraft = 0.8f;
                     sp.size = 10.0f + 18.0f * smoke;
                     sp.lifeTime = sp.originalLifeTime = 0.8f + 1.6f * smoke;
                     sp.shapeId = p.shapeId;
-                    sp.trailEnabled = false;
-                    sp.shouldFade = true;
-                    sp.fadeStartRatio = 1.0f;
                     sp.baseColor = sp.color = glm::vec4(0.65f, 0.65f, 0.70f, 0.10f + 0.18f * smoke);
-                    sp.smokeAmount = 0.0f;
                     sp.recursionDepthRemaining = 0;
-                    sp.recursionProb = 0.0f;
                     sp.trailCount = 0;
                     sp.trailHead = 0;
                     sp.trailSampleAccum = 0.0f;
@@ -138,42 +401,39 @@ void ParticlePool::Update(float deltaTime)
             // Recursion: spawn a small sparkle burst at death.
             if (p.recursionDepthRemaining > 0) {
                 std::uniform_real_distribution<float> d01(0.0f, 1.0f);
-                if (d01(s_poolRng) < std::max(0.0f, std::min(1.0f, p.recursionProb))) {
+                if (d01(s_poolRng) < e.recursionProb) {
                     std::uniform_real_distribution<float> d(-1.0f, 1.0f);
-                    const int count = 6;
-                    for (int s = 0; s < count; ++s) {
-                        int ci = Allocate();
+                    // Budget : moyenne recursionChildren, la partie fractionnaire est tirée
+                    // (gerbes de tailles variées plutôt qu'une taille fixe réduite).
+                    const float children = e.recursionChildren;
+                    int count = static_cast<int>(children);
+                    if (d01(s_poolRng) < children - static_cast<float>(count)) ++count;
+                    const int room = SecondaryRoom(recursionReserve, count);
+                    pressure.recursionDropped += static_cast<uint32_t>(count - room);
+                    for (int s = 0; s < room; ++s) {
+                        int ci = FindFreeSlot();
                         if (ci < 0) break;
                         Particle& cp = Get(ci);
+                        AttachOwner(ci, p.owner);
                         cp.active = true;
+                        cp.paramsIndex = e.childIndex;
                         cp.position = deathPos;
                         cp.velocity = glm::normalize(glm::vec3(d(s_poolRng), d(s_poolRng), d(s_poolRng))) * (3.0f + 4.0f * d01(s_poolRng));
                         cp.damping = 6.0f;
-                        cp.gravityScale = 0.25f;
-                        cp.updraft = 0.2f;
                         cp.size = std::max(2.0f, p.size * 0.5f);
                         cp.lifeTime = cp.originalLifeTime = 0.6f;
                         cp.shapeId = p.shapeId;
-                        cp.trailEnabled = p.trailEnabled;
-                        cp.trailWidth = p.trailWidth;
-                        cp.trailDuration = p.trailDuration;
-                        cp.trailOpacity = p.trailOpacity;
-                        cp.trailFalloffPow = p.trailFalloffPow;
-                        cp.trailSamplePeriod = p.trailSamplePeriod;
                         cp.trailSampleAccum = 0.0f;
                         cp.trailHead = 0;
                         cp.trailCount = 0;
-                        cp.shouldFade = true;
-                        cp.fadeStartRatio = 1.0f;
                         cp.baseColor = cp.color = p.baseColor;
                         cp.color.a = std::min(1.0f, p.color.a);
-                        cp.smokeAmount = 0.0f;
-                        cp.recursionDepthRemaining = p.recursionDepthRemaining - 1;
-                        cp.recursionProb = p.recursionProb;
+                        cp.recursionDepthRemaining = static_cast<uint8_t>(p.recursionDepthRemaining - 1);
                     }
                 }
             }
 
+            DetachOwner(static_cast<int>(i));
             p.active = false;
             p.trailCount = 0;
             continue;
@@ -181,14 +441,13 @@ void ParticlePool::Update(float deltaTime)
 
 
         // Free phase integration: dv/dt = g - k v
-        glm::vec3 g = baseGravity * p.gravityScale;
-        g.y += p.updraft;
+        const glm::vec3& g = e.gravity;
         float k = (p.damping >= 0.0f) ? p.damping : 0.0f;
 
         if (k > 1e-6f)
         {
-            float e = std::exp(-k * dt);
-            p.velocity = p.velocity * e + (g / k) * (1.0f - e);
+            float ek = std::exp(-k * dt);
+            p.velocity = p.velocity * ek + (g / k) * (1.0f - ek);
         }
         else
         {
@@ -198,7 +457,7 @@ void ParticlePool::Update(float deltaTime)
         p.position += p.velocity * dt;
 
         // Trail sampling (discrete, fixed ring buffer)
-        if (p.trailEnabled && p.trailDuration > 0.0f && p.trailSamplePeriod > 0.0f)
+        if (e.trailSampling)
         {
             p.trailSampleAccum += dt;
             // Ensure we at least keep the newest point up to date when dt is very small
@@ -209,9 +468,9 @@ void ParticlePool::Update(float deltaTime)
                 GetTrailBuffer(static_cast<int>(i))[0] = p.position;
                 p.trailSampleAccum = 0.0f;
             }
-            while (p.trailSampleAccum >= p.trailSamplePeriod)
+            while (p.trailSampleAccum >= e.trailSamplePeriod)
             {
-                p.trailSampleAccum -= p.trailSamplePeriod;
+                p.trailSampleAccum -= e.trailSamplePeriod;
                 p.trailHead = static_cast<uint8_t>((p.trailHead + 1u) % ParticlePool::kTrailSamples);
                 glm::vec3* buf = GetTrailBuffer(static_cast<int>(i));
                 buf[p.trailHead] = p.position;
@@ -227,12 +486,12 @@ void ParticlePool::Update(float deltaTime)
         }
 
         // Fade
-        if (p.shouldFade)
+        if (e.shouldFade)
         {
             float lifeRatio = p.lifeTime / p.originalLifeTime;
-            if (lifeRatio < p.fadeStartRatio)
+            if (lifeRatio < e.fadeStartRatio)
             {
-                float fadeProgress = lifeRatio / p.fadeStartRatio;
+                float fadeProgress = lifeRatio / e.fadeStartRatio;
                 p.color = p.baseColor;
                 p.color.a = fadeProgress;
             }
@@ -244,15 +503,80 @@ void ParticlePool::Update(float deltaTime)
     }
 }
 
+void ParticlePool::CopyActiveFrom(const ParticlePool& src)
+{
+    if (&src == this || version == src.version) return;
+
+    // clear() garde la capacité : pas de réallocation une fois le pic atteint.
+    particles.clear();
+    trailPositions.clear();
+    for (size_t i = 0; i < src.highWater; ++i)
+    {
+        const Particle& p = src.particles[i];
+        if (!p.active || src.IsOwnerHidden(p.owner)) continue;
+        particles.push_back(p);
+        const glm::vec3* trail = &src.trailPositions[i * kTrailSamples];
+        trailPositions.insert(trailPositions.end(), trail, trail + kTrailSamples);
+    }
+    // Table append-only : la copie reste petite (une entrée par jeu de paramètres).
+    emitterParams = src.emitterParams;
+    emitterParamsLookup.clear();
+    ownerLiveCounts = src.ownerLiveCounts;
+    lastSearchIndex = 0;
+    highWater = particles.size();
+    liveCount = particles.size();
+    version = src.version;
+}
+
+void ParticlePool::AssignFrom(const ParticlePool& src)
+{
+    if (&src == this) return;
+
+    ClearAll();
+
+    // paramsIndex des particules copiées se réfère à la table de src.
+    emitterParams = src.emitterParams;
+    emitterParamsLookup.clear();
+
+    // Active particles of src packed at the front (the rest of the capacity stays free).
+    size_t n = 0;
+    for (size_t i = 0; i < src.highWater && n < particles.size(); ++i)
+    {
+        const Particle& p = src.particles[i];
+        if (!p.active) continue;
+        particles[n] = p;
+        particles[n].owner = kNoOwner; // les instances de src n'existent pas ici
+        std::copy(src.trailPositions.begin() + i * kTrailSamples,
+                  src.trailPositions.begin() + (i + 1) * kTrailSamples,
+                  trailPositions.begin() + n * kTrailSamples);
+        ++n;
+    }
+    lastSearchIndex = (n < particles.size()) ? n : 0;
+    highWater = n;
+    liveCount = n;
+    ++version;
+}
+
 void ParticlePool::ClearAll()
 {
     // Mark everything inactive and reset per-particle trail state.
-    for (auto& p : particles) {
+    // Nothing above highWater was ever allocated since the last clear.
+    for (size_t i = 0; i < highWater; ++i) {
+        Particle& p = particles[i];
         p.active = false;
+        p.owner = kNoOwner;
         p.trailCount = 0;
         p.trailHead = 0;
         p.trailSampleAccum = 0.0f;
     }
-    std::fill(trailPositions.begin(), trailPositions.end(), glm::vec3(0.0f));
+    std::fill(ownerLiveCounts.begin(), ownerLiveCounts.end(), 0u);
+    std::fill(ownerHeads.begin(), ownerHeads.end(), -1);
+    std::fill(ownerNext.begin(), ownerNext.begin() + highWater, -1);
+    std::fill(ownerPrev.begin(), ownerPrev.begin() + highWater, -1);
+    std::fill(trailPositions.begin(), trailPositions.begin() + highWater * kTrailSamples, glm::vec3(0.0f));
+    ResetEmitterParams();
     lastSearchIndex = 0;
+    highWater = 0;
+    liveCount = 0;
+    ++version;
 }
\ No newline at end of file
@@ -2,15 +2,33 @@
 
 #include <vector>
 #include <cstddef>
+#include <cstdint>
+#include <unordered_map>
 #include <glm/glm.hpp>
 #include "Particle.h"
+#include "EmitterParams.h"
 
+// Plage contiguë d'index de particules [first, first + count).
+struct ParticleSpan {
+    int first = -1;
+    int count = 0;
+};
 
 class ParticlePool {
 public:
     // Fixed history size per particle (ring buffer). Keep small: memory scales with capacity.
     static constexpr int kTrailSamples = 16;
 
+    // Entrées toujours présentes dans la table EmitterParams.
+    static constexpr uint16_t kDefaultParams = 0; // valeurs par défaut (émetteur générique)
+    static constexpr uint16_t kSmokeParams = 1;   // fumée émise à la mort d'une particule
+
+    // Étincelles par gerbe de récursion sans budget (EmitterParams::recursionChildren).
+    static constexpr int kRecursionChildren = 6;
+
+    // Particle::owner des particules sans instance émettrice.
+    static constexpr uint32_t kNoOwner = 0;
+
     explicit ParticlePool(size_t maxParticles = 10000);
     ~ParticlePool() = default;
 
@@ -18,6 +36,37 @@ public:
     // Retourne -1 si le pool est plein
     int Allocate();
 
+    // Alloue jusqu'à count particules contiguës (premier trou libre trouvé, étendu tant que
+    // les slots suivants sont libres). Les particules sont marquées actives et restent à
+    // initialiser. span.count < count si le trou est plus petit : rappeler pour le reste.
+    // span.count == 0 si le pool est plein.
+    ParticleSpan AllocateRange(int count);
+
+    // Propriétaire attribué aux particules allouées ensuite par Allocate / AllocateRange
+    // (InstanceManager le positionne autour de l'Update de chaque instance).
+    void SetEmitOwner(uint32_t owner) { emitOwner = owner; }
+
+    // Nombre de particules vivantes d'un propriétaire (smoke / récursion comprises).
+    // Maintenu à chaque allocation, mort, Free() et ClearAll().
+    uint32_t GetOwnerLiveCount(uint32_t owner) const
+    {
+        return (owner < ownerLiveCounts.size()) ? ownerLiveCounts[owner] : 0u;
+    }
+
+    // Tue toutes les particules d'un propriétaire (smoke / récursion comprises) en
+    // parcourant sa liste chaînée : O(ses particules), indépendant de la capacité.
+    // Retourne le nombre de particules tuées.
+    size_t KillOwner(uint32_t owner);
+
+    // Mute / solo de l'éditeur : les particules d'un propriétaire masqué continuent d'être
+    // simulées mais CopyActiveFrom() les saute, elles disparaissent donc du rendu sans
+    // toucher aux renderers. Un changement incrémente la version.
+    void SetOwnerHidden(uint32_t owner, bool hidden);
+    bool IsOwnerHidden(uint32_t owner) const
+    {
+        return owner < ownerHidden.size() && ownerHidden[owner] != 0;
+    }
+
     // Libère une particule (la marque comme inactive)
     void Free(int index);
 
@@ -29,9 +78,30 @@ public:
     std::vector<Particle>& GetAll() { return particles; }
     const std::vector<Particle>& GetAll() const { return particles; }
 
-    // Statistiques
+    // Statistiques (O(1) : compteur tenu à chaque allocation / mort / Free)
     size_t GetCapacity() const { return particles.size(); }
-    size_t GetActiveCount() const;
+    size_t GetActiveCount() const { return liveCount; }
+    size_t GetFreeCount() const { return particles.size() - liveCount; }
+
+    // Pression sur le pool (ParticleBudget) : la fumée et les gerbes de récursion émises
+    // à la mort d'une particule ne prennent un slot que s'il en reste plus que leur
+    // réserve. Réserve 0 = comportement historique (jusqu'à ce que le pool soit plein).
+    void SetSecondaryReserve(size_t smokeReserve, size_t recursionReserve);
+
+    struct PressureStats {
+        uint32_t smokeDropped = 0;     // particules de fumée non émises (réserve / pool plein)
+        uint32_t recursionDropped = 0; // étincelles de récursion non émises
+    };
+    const PressureStats& GetPressureStats() const { return pressure; }
+    void ResetPressureStats() { pressure = PressureStats(); }
+
+    // Libère les count particules actives qui ont le moins de vie restante, sans effet de
+    // mort. O(particules actives) ; réservé aux frames où le pool sature.
+    size_t EvictNearlyDead(size_t count);
+
+    // Incrémenté à chaque mutation (Allocate/Free/Update/ClearAll) : les renderers
+    // réutilisent leurs buffers GPU tant qu'il ne change pas.
+    uint64_t GetVersion() const { return version; }
 
     // Update toutes les particules actives
     void Update(float deltaTime);
@@ -40,6 +110,23 @@ public:
     // Utile pour les previews en mode Scene (paroxysme) sans lancer la timeline.
     void ClearAll();
 
+    // Snapshot pour le rendu (thread de simulation) : copie compacte des particules actives
+    // de src et de leur historique de trail. La capacité suit le nombre de particules
+    // actives ; GetVersion() reprend celle de src (aucune copie si elle n'a pas changé).
+    void CopyActiveFrom(const ParticlePool& src);
+
+    // Remplace le contenu par les particules actives de src, rangées en tête du pool
+    // (capacité inchangée). Sert à installer une preview construite hors du thread UI.
+    void AssignFrom(const ParticlePool& src);
+
+    // Table des paramètres d'émetteur, dédupliquée par valeur : une entrée par jeu de
+    // paramètres distinct (en pratique une par version de template). Les dérivés (vecteur
+    // gravité, ...) sont calculés ici une fois. Vidée par ClearAll(), copiée par les
+    // snapshots. Retourne kDefaultParams si la table est pleine.
+    uint16_t InternEmitterParams(const EmitterParams& params);
+    const EmitterParams& GetEmitterParams(uint16_t index) const { return emitterParams[index]; }
+    size_t GetEmitterParamsCount() const { return emitterParams.size(); }
+
     // Trail history access (for renderer)
     // Returns pointer to the first element of the ring buffer for a particle.
     const glm::vec3* GetTrailBuffer(int particleIndex) const;
@@ -48,7 +135,38 @@ public:
 private:
     std::vector<Particle> particles;
     size_t lastSearchIndex;  // Optimisation pour Allocate()
+    size_t highWater;        // 1 + plus grand index alloué depuis le dernier ClearAll()
+    uint64_t version;
+    size_t liveCount;        // particules actives
+
+    size_t smokeReserve;
+    size_t recursionReserve;
+    PressureStats pressure;
+    std::vector<int> evictScratch; // EvictNearlyDead()
 
     // SoA trail positions: capacity * kTrailSamples
     std::vector<glm::vec3> trailPositions;
+
+    void ResetEmitterParams();
+
+    int FindFreeSlot();
+    int SecondaryRoom(size_t reserve, int wanted) const;
+    void AttachOwner(int index, uint32_t owner);
+    void DetachOwner(int index);
+
+    // Ajout seulement (jusqu'à ClearAll) : les index restent valides pour les particules.
+    std::vector<EmitterParams> emitterParams;
+    // Hash des champs auteur -> index. Reconstruit à la demande après une copie de table.
+    std::unordered_multimap<uint64_t, uint16_t> emitterParamsLookup;
+
+    uint32_t emitOwner;
+    std::vector<uint32_t> ownerLiveCounts; // indexé par Particle::owner
+    std::vector<uint8_t> ownerHidden;      // indexé par Particle::owner (mute / solo)
+
+    // Liste doublement chaînée des particules de chaque propriétaire (index de slot, -1 =
+    // fin). Maintenue par AttachOwner / DetachOwner ; non copiée par les snapshots, dont
+    // les index de slot sont différents.
+    std::vector<int> ownerHeads; // indexé par Particle::owner
+    std::vector<int> ownerNext;  // indexé par slot
+    std::vector<int> ownerPrev;  // indexé par slot
 };
\ No newline at end of file
@@ -1,7 +1,57 @@
 #include "ShapeRegistry.h"
 #include "../rendering/Texture.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+
+#include <stbimage/stb_image.h>
+
+namespace {
+
+constexpr char kCacheMagic[8] = { 'F', 'W', 'R', 'G', 'B', 'A', '0', '1' };
+
+uint64_t Fnv1a64(const void* data, size_t size, uint64_t h = 1469598103934665603ULL)
+{
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        h ^= bytes[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// Cache key: path + modification time + size. A touched or replaced file gets a new key,
+// so stale entries are never read (they are simply left behind in the cache folder).
+bool ComputeCacheKey(const std::string& path, uint64_t& outKey)
+{
+    std::error_code ec;
+    const auto mtime = std::filesystem::last_write_time(path, ec);
+    if (ec) return false;
+    const auto size = std::filesystem::file_size(path, ec);
+    if (ec) return false;
+
+    const int64_t ticks = static_cast<int64_t>(mtime.time_since_epoch().count());
+    const uint64_t fileSize = static_cast<uint64_t>(size);
+
+    uint64_t h = Fnv1a64(path.data(), path.size());
+    h = Fnv1a64(&ticks, sizeof(ticks), h);
+    h = Fnv1a64(&fileSize, sizeof(fileSize), h);
+    outKey = h;
+    return true;
+}
+
+} // namespace
+
 ShapeRegistry::ShapeRegistry() noexcept
+    : m_placeholder(0)
+    , m_whiteFallback(0)
+    , m_cacheDir("../cache/shapes")
+    , m_inFlight(0)
+    , m_stopping(false)
 {
     // reserve builtins
     m_shapes.resize(static_cast<size_t>(BuiltinShape::Count));
@@ -18,25 +68,24 @@ ShapeRegistry::ShapeRegistry() noexcept
 
 ShapeRegistry::~ShapeRegistry() noexcept
 {
+    StopWorkers();
+
     for (GLuint t : m_textures) {
-        if (t != 0) glDeleteTextures(1, &t);
+        if (t != 0 && t != m_placeholder && t != m_whiteFallback) glDeleteTextures(1, &t);
     }
+    if (m_placeholder) glDeleteTextures(1, &m_placeholder);
+    if (m_whiteFallback) glDeleteTextures(1, &m_whiteFallback);
 }
 
 bool ShapeRegistry::Initialize()
 {
-    // Charge les textures builtin (après création du contexte GL)
+    // Les builtin affichent le placeholder jusqu'au premier PumpUploads() qui suit leur décodage.
     for (int i = 0; i < static_cast<int>(BuiltinShape::Count); ++i) {
         uint16_t idx = static_cast<uint16_t>(i);
-        const Shape& s = m_shapes[idx];
-        std::string path = s.getAssetPath();
-        GLuint tex = 0;
-        if (!loadTexture(path, tex)) {
-            std::cerr << "ShapeRegistry: Échec chargement builtin texture: " << path << '\n';
-            tex = 0;
-        }
-        m_textures[idx] = tex;
+        const std::string path = m_shapes[idx].getAssetPath();
+        m_textures[idx] = GetPlaceholder();
         m_pathToIndex[path] = idx;
+        QueueDecode(idx, path);
     }
     return true;
 }
@@ -57,29 +106,44 @@ uint16_t ShapeRegistry::RegisterCustom(const std::string& path)
     auto it = m_pathToIndex.find(path);
     if (it != m_pathToIndex.end()) return it->second;
 
-    GLuint tex = 0;
-    if (!loadTexture(path, tex)) {
-        std::cerr << "ShapeRegistry: échec chargement custom texture: " << path << '\n';
-        // fallback : crée une texture blanche 1x1
-        unsigned char white[4] = { 255,255,255,255 };
-        glGenTextures(1, &tex);
-        glBindTexture(GL_TEXTURE_2D, tex);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glBindTexture(GL_TEXTURE_2D, 0);
-    }
-
     Shape s;
     s.isCustom = true;
     s.customPath = path;
     uint16_t newIndex = static_cast<uint16_t>(m_shapes.size());
     m_shapes.push_back(std::move(s));
-    m_textures.push_back(tex);
+    m_textures.push_back(GetPlaceholder());
     m_pathToIndex[path] = newIndex;
+
+    QueueDecode(newIndex, path);
     return newIndex;
 }
 
+size_t ShapeRegistry::RegisterCustomDirectory(const std::string& directory)
+{
+    std::error_code ec;
+    std::vector<std::string> paths;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+        if (!entry.is_regular_file(ec)) continue;
+        std::string ext = entry.path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (ext == ".png") paths.push_back(entry.path().string());
+    }
+    if (ec) {
+        std::cerr << "ShapeRegistry: cannot list " << directory << ": " << ec.message() << '\n';
+    }
+
+    // Stable ids across runs for the same folder content.
+    std::sort(paths.begin(), paths.end());
+
+    size_t added = 0;
+    for (const auto& p : paths) {
+        const size_t before = m_shapes.size();
+        RegisterCustom(p);
+        if (m_shapes.size() != before) ++added;
+    }
+    return added;
+}
+
 GLuint ShapeRegistry::GetTextureId(uint16_t shapeId) const noexcept
 {
     if (shapeId < m_textures.size()) return m_textures[shapeId];
@@ -93,30 +157,232 @@ const Shape& ShapeRegistry::GetShape(uint16_t shapeId) const noexcept
     return s_default;
 }
 
-bool ShapeRegistry::loadTexture(const std::string& path, GLuint& outTex)
+void ShapeRegistry::SetCacheDirectory(const std::string& directory)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cacheDir = directory;
+}
+
+size_t ShapeRegistry::PendingCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_inFlight;
+}
+
+// ---------------------------------------------------------------------------
+// Main thread side
+// ---------------------------------------------------------------------------
+
+GLuint ShapeRegistry::GetPlaceholder()
 {
-    // Debug: afficher cwd et vérifier l'existence du fichier avant de déléguer au loader
-    try {
-        std::filesystem::path p(path);
-        std::filesystem::path abs = std::filesystem::absolute(p);
-        std::cerr << "ShapeRegistry: trying to load: " << path << " -> absolute: " << abs << "\n";
-        std::cerr << "ShapeRegistry: current_path = " << std::filesystem::current_path() << "\n";
-        if (!std::filesystem::exists(p)) {
-            std::cerr << "ShapeRegistry: file not found at: " << abs << "\n";
-            return false;
+    if (m_placeholder) return m_placeholder;
+
+    // Small soft disk: pending shapes still read as round particles, not squares.
+    constexpr int kSize = 16;
+    unsigned char pixels[kSize * kSize * 4];
+    for (int y = 0; y < kSize; ++y) {
+        for (int x = 0; x < kSize; ++x) {
+            const float dx = (static_cast<float>(x) + 0.5f) / kSize * 2.0f - 1.0f;
+            const float dy = (static_cast<float>(y) + 0.5f) / kSize * 2.0f - 1.0f;
+            const float a = std::clamp(1.0f - std::sqrt(dx * dx + dy * dy), 0.0f, 1.0f);
+            unsigned char* p = &pixels[(y * kSize + x) * 4];
+            p[0] = p[1] = p[2] = 255;
+            p[3] = static_cast<unsigned char>(a * 255.0f + 0.5f);
         }
     }
-    catch (const std::exception& e) {
-        std::cerr << "ShapeRegistry: filesystem error: " << e.what() << "\n";
-        // continue to let stbi attempt if path is weird
+    m_placeholder = Texture::CreateFromPixels(pixels, kSize, kSize);
+    return m_placeholder;
+}
+
+GLuint ShapeRegistry::GetWhiteFallback()
+{
+    if (m_whiteFallback) return m_whiteFallback;
+
+    unsigned char white[4] = { 255,255,255,255 };
+    glGenTextures(1, &m_whiteFallback);
+    glBindTexture(GL_TEXTURE_2D, m_whiteFallback);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return m_whiteFallback;
+}
+
+size_t ShapeRegistry::PumpUploads(size_t maxUploads)
+{
+    size_t uploaded = 0;
+    while (maxUploads == 0 || uploaded < maxUploads) {
+        DecodedImage image;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_ready.empty()) break;
+            image = std::move(m_ready.front());
+            m_ready.pop_front();
+            --m_inFlight;
+        }
+
+        const bool builtin = image.index < static_cast<uint16_t>(BuiltinShape::Count);
+        GLuint tex = 0;
+        if (!image.rgba.empty()) {
+            tex = Texture::CreateFromPixels(image.rgba.data(), image.width, image.height);
+        }
+        if (tex == 0) {
+            std::cerr << "ShapeRegistry: échec chargement " << (builtin ? "builtin" : "custom") << " texture: " << image.path << '\n';
+            // Builtins keep the historical behavior (not drawn); customs fall back to white.
+            tex = builtin ? 0 : GetWhiteFallback();
+        }
+
+        if (image.index < m_textures.size()) m_textures[image.index] = tex;
+        ++uploaded;
+    }
+    return uploaded;
+}
+
+void ShapeRegistry::QueueDecode(uint16_t index, const std::string& path)
+{
+    EnsureWorkers();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_jobs.push_back({ index, path });
+    ++m_inFlight;
+    m_jobCv.notify_one();
+}
+
+// ---------------------------------------------------------------------------
+// Workers
+// ---------------------------------------------------------------------------
+
+void ShapeRegistry::EnsureWorkers()
+{
+    if (!m_workers.empty()) return;
+
+    const unsigned hw = std::thread::hardware_concurrency();
+    const unsigned count = std::clamp(hw > 1 ? hw - 1 : 1u, 1u, 4u);
+    for (unsigned i = 0; i < count; ++i) {
+        m_workers.emplace_back(&ShapeRegistry::WorkerLoop, this);
+    }
+}
+
+void ShapeRegistry::StopWorkers() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        m_jobs.clear();
+    }
+    m_jobCv.notify_all();
+    for (auto& t : m_workers) {
+        if (t.joinable()) t.join();
+    }
+    m_workers.clear();
+}
+
+void ShapeRegistry::WorkerLoop()
+{
+    // Textures are uploaded bottom-up, like Texture::LoadFromFile (per-thread flag).
+    stbi_set_flip_vertically_on_load_thread(1);
+
+    for (;;) {
+        DecodeJob job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_jobCv.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+            if (m_stopping) return;
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        DecodedImage image = Decode(job);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_ready.push_back(std::move(image));
+    }
+}
+
+ShapeRegistry::DecodedImage ShapeRegistry::Decode(const DecodeJob& job) const
+{
+    DecodedImage image;
+    image.index = job.index;
+    image.path = job.path;
+
+    std::string cacheDir;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        cacheDir = m_cacheDir;
     }
 
-    outTex = Texture::LoadFromFile(path, true);
-    if (outTex == 0) {
-        std::cerr << "ShapeRegistry: Texture::LoadFromFile returned 0 for: " << path << '\n';
-        return false;
+    uint64_t key = 0;
+    const bool haveKey = !cacheDir.empty() && ComputeCacheKey(job.path, key);
+    std::string cachePath;
+    if (haveKey) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.rgba", static_cast<unsigned long long>(key));
+        cachePath = (std::filesystem::path(cacheDir) / name).string();
+        if (ReadCache(cachePath, key, image)) return image;
     }
 
-    std::cerr << "ShapeRegistry: loaded texId=" << outTex << " for " << path << '\n';
+    int width = 0, height = 0, channels = 0;
+    unsigned char* data = stbi_load(job.path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    if (!data) return image; // reported on upload
+
+    image.width = width;
+    image.height = height;
+    image.rgba.assign(data, data + static_cast<size_t>(width) * static_cast<size_t>(height) * 4);
+    stbi_image_free(data);
+
+    if (haveKey) WriteCache(cachePath, key, image);
+    return image;
+}
+
+bool ShapeRegistry::ReadCache(const std::string& cachePath, uint64_t key, DecodedImage& out) const
+{
+    std::ifstream in(cachePath, std::ios::binary);
+    if (!in.is_open()) return false;
+
+    char magic[sizeof(kCacheMagic)];
+    uint64_t storedKey = 0;
+    int32_t width = 0, height = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&storedKey), sizeof(storedKey));
+    in.read(reinterpret_cast<char*>(&width), sizeof(width));
+    in.read(reinterpret_cast<char*>(&height), sizeof(height));
+    if (!in || std::memcmp(magic, kCacheMagic, sizeof(kCacheMagic)) != 0 || storedKey != key) return false;
+    if (width <= 0 || height <= 0 || width > 16384 || height > 16384) return false;
+
+    std::vector<unsigned char> rgba(static_cast<size_t>(width) * static_cast<size_t>(height) * 4);
+    in.read(reinterpret_cast<char*>(rgba.data()), static_cast<std::streamsize>(rgba.size()));
+    if (!in) return false;
+
+    out.width = width;
+    out.height = height;
+    out.rgba = std::move(rgba);
     return true;
-}
\ No newline at end of file
+}
+
+void ShapeRegistry::WriteCache(const std::string& cachePath, uint64_t key, const DecodedImage& image) const
+{
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(cachePath).parent_path(), ec);
+    if (ec) return; // cache is best effort
+
+    // Write to a temp name then rename, so a concurrent reader never sees a partial file.
+    const std::string tmpPath = cachePath + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) return;
+        const int32_t width = image.width;
+        const int32_t height = image.height;
+        out.write(kCacheMagic, sizeof(kCacheMagic));
+        out.write(reinterpret_cast<const char*>(&key), sizeof(key));
+        out.write(reinterpret_cast<const char*>(&width), sizeof(width));
+        out.write(reinterpret_cast<const char*>(&height), sizeof(height));
+        out.write(reinterpret_cast<const char*>(image.rgba.data()), static_cast<std::streamsize>(image.rgba.size()));
+        if (!out) {
+            out.close();
+            std::filesystem::remove(tmpPath, ec);
+            return;
+        }
+    }
+    std::filesystem::rename(tmpPath, cachePath, ec);
+    if (ec) std::filesystem::remove(tmpPath, ec);
+}
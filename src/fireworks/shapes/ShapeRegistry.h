@@ -8,26 +8,47 @@
 #include <iostream>
 #include <cstring>
 #include <filesystem>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 
 #include "Shape.h"
 
 // Minimal shape registry : charge et met en cache les textures (stb_image)
 // Indices 0..BuiltinCount-1 -> builtin shapes
+//
+// Loading is asynchronous: PNGs are decoded on worker threads (or read back from the
+// on-disk RGBA cache), then uploaded to GL on the main thread by PumpUploads(). Until
+// then a shape renders with a shared placeholder texture.
 class ShapeRegistry {
 public:
     ShapeRegistry() noexcept;
     ~ShapeRegistry() noexcept;
 
-    // Initialise (charge les builtin). Appeler après contexte GL prêt.
+    // Initialise (queue les builtin). Appeler après contexte GL prêt.
     bool Initialize();
 
     // Retourne l'index pour un builtin (toujours le même)
     uint16_t RegisterBuiltin(BuiltinShape builtin);
 
-    // Enregistre un shape custom (charge la texture). Retourne index.
+    // Enregistre un shape custom (décodage en arrière-plan). Retourne index.
     uint16_t RegisterCustom(const std::string& path);
 
-    // Renvoie la texture OpenGL (0 si introuvable)
+    // Enregistre tous les .png d'un dossier. Retourne le nombre de shapes ajoutés.
+    size_t RegisterCustomDirectory(const std::string& directory);
+
+    // Main thread: uploads up to maxUploads decoded images (0 = all ready ones).
+    // Returns the number of textures uploaded.
+    size_t PumpUploads(size_t maxUploads = 4);
+
+    // Shapes still decoding or waiting for upload.
+    size_t PendingCount() const;
+
+    // Decoded-image cache (raw RGBA keyed by path hash + mtime + size). Empty disables it.
+    void SetCacheDirectory(const std::string& directory);
+
+    // Renvoie la texture OpenGL (placeholder tant que le décodage n'est pas fini, 0 si introuvable)
     GLuint GetTextureId(uint16_t shapeId) const noexcept;
 
     // Renvoie le descriptor Shape (valide si index < size)
@@ -37,10 +58,47 @@ public:
     size_t Count() const noexcept { return m_shapes.size(); }
 
 private:
-    bool loadTexture(const std::string& path, GLuint& outTex);
+    struct DecodeJob {
+        uint16_t index = 0;
+        std::string path;
+    };
+
+    struct DecodedImage {
+        uint16_t index = 0;
+        std::string path;
+        int width = 0;
+        int height = 0;
+        std::vector<unsigned char> rgba; // empty => decode failed
+    };
+
+    void EnsureWorkers();
+    void StopWorkers() noexcept;
+    void WorkerLoop();
+    void QueueDecode(uint16_t index, const std::string& path);
+
+    // Worker side: cache lookup, else decode + cache store.
+    DecodedImage Decode(const DecodeJob& job) const;
+    bool ReadCache(const std::string& cachePath, uint64_t key, DecodedImage& out) const;
+    void WriteCache(const std::string& cachePath, uint64_t key, const DecodedImage& image) const;
+
+    GLuint GetPlaceholder();
+    GLuint GetWhiteFallback();
 
 private:
     std::vector<Shape> m_shapes;
     std::vector<GLuint> m_textures;
     std::unordered_map<std::string, uint16_t> m_pathToIndex;
-};
\ No newline at end of file
+
+    GLuint m_placeholder;   // shared soft disk shown while decoding
+    GLuint m_whiteFallback; // shared 1x1 white for custom shapes that failed to load
+
+    std::string m_cacheDir;
+
+    std::vector<std::thread> m_workers;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_jobCv;
+    std::deque<DecodeJob> m_jobs;
+    std::deque<DecodedImage> m_ready;
+    size_t m_inFlight; // queued + decoding + ready
+    bool m_stopping;
+};
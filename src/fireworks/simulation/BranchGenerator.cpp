@@ -1,9 +1,10 @@
 ﻿#include "BranchGenerator.h"
 #include <random>
 #include <cmath>
-#include <iostream>
+#include <algorithm>
 
-static std::mt19937 s_rng(std::random_device{}());
+// Per thread: the simulation thread and the preview worker emit concurrently.
+static thread_local std::mt19937 s_rng(std::random_device{}());
 
 static float Biased01(float u, float bias)
 {
@@ -12,217 +13,307 @@ static float Biased01(float u, float bias)
     return 1.0f - std::pow(1.0f - u, bias);
 }
 
-static void InitParticleFromBranch(
-    Particle& p,
-    const GeneratedBranch& branch,
-    const glm::vec3& worldPosition,
-    float orderedProgress01
-)
+BranchGenerator::PreparedBranch BranchGenerator::Prepare(const GeneratedBranch& branch)
 {
-    std::uniform_real_distribution<float> dist01(0.0f, 1.0f);
-
-    // Local cone sampling (kept here to avoid exposing BranchGenerator internals)
-    auto RandomInConeLocal = [&](const glm::vec3& direction, float halfAngleDeg) -> glm::vec3 {
-        static const float TWO_PI = 2.0f * 3.14159265358979323846f;
-        std::uniform_real_distribution<float> distAngle(0.0f, glm::radians(halfAngleDeg));
-        std::uniform_real_distribution<float> distAzimuth(0.0f, TWO_PI);
-
-        float angle = distAngle(s_rng);
-        float azimuth = distAzimuth(s_rng);
+    PreparedBranch k;
+    k.params = branch.params;
+    k.direction = branch.direction;
+    k.color = branch.color;
+    if (!k.params) return k;
+
+    const BranchDescriptor& d = *k.params;
+    const bool sparkle = (d.visualMode == BranchDescriptor::VisualMode::Sparkle);
+
+    // Base du cone : ne dépend que de la direction de la branche
+    const glm::vec3& direction = k.direction;
+    const glm::vec3 perpendicular = (std::abs(direction.y) < 0.9f)
+        ? glm::vec3(0.0f, 1.0f, 0.0f)
+        : glm::vec3(1.0f, 0.0f, 0.0f);
+    k.tangent = glm::normalize(glm::cross(direction, perpendicular));
+    k.bitangent = glm::cross(direction, k.tangent);
+
+    k.speedVariance = d.speedVariance;
+    if (sparkle) k.speedVariance *= (1.0f + std::max(0.0f, d.sparkleSpeedJitter));
+
+    k.frontPortion = std::max(0.0f, std::min(1.0f, d.frontPortion));
+    k.frontSpeedBias = std::max(1.0f, d.frontSpeedBias);
+    k.backSpeedScale = std::max(0.0f, std::min(1.0f, d.backSpeedScale));
+
+    float spread = d.angularSpread;
+    if (sparkle) spread *= std::max(0.0f, d.sparkleSpreadMult);
+    k.halfSpreadRad = (spread > 0.0f) ? glm::radians(spread * 0.5f) : 0.0f;
+
+    k.sparkleJitter = (sparkle && d.sparkleSpeedJitter > 0.0f) ? d.sparkleSpeedJitter : 0.0f;
+
+    k.recursionDepth = std::max(0, std::min(255, d.recursionDepth));
+    k.particleCount = std::max(0, d.particlesPerBranch);
+
+    EmitterParams& e = k.emitterParams;
+    e.gravityScale = d.gravityScale;
+    e.updraft = d.updraft;
+    e.shouldFade = d.shouldFade;
+    e.fadeStartRatio = d.fadeStartRatio;
+    e.trailEnabled = d.trailEnabled;
+    e.trailWidth = d.trailWidth;
+    e.trailDuration = d.trailDuration;
+    e.trailOpacity = d.trailOpacity;
+    e.trailFalloffPow = d.trailFalloffPow;
+    if (d.trailEnabled && d.trailDuration > 0.0f) {
+        const float denom = static_cast<float>(ParticlePool::kTrailSamples - 1);
+        float period = (denom > 0.0f) ? (d.trailDuration / denom) : (1.0f / 60.0f);
+        if (period < 1.0f / 240.0f) period = 1.0f / 240.0f;
+        if (period > 1.0f / 10.0f)  period = 1.0f / 10.0f;
+        e.trailSamplePeriod = period;
+    }
+    e.smokeAmount = d.smokeAmount;
+    e.recursionProb = d.recursionProb;
+    e.recursionChildren = d.recursionChildren;
+    return k;
+}
 
-        glm::vec3 perpendicular;
-        if (std::abs(direction.y) < 0.9f) {
-            perpendicular = glm::vec3(0.0f, 1.0f, 0.0f);
-        } else {
-            perpendicular = glm::vec3(1.0f, 0.0f, 0.0f);
-        }
+// Uniforme [0, 1) sur 24 bits : un tirage du générateur, sans objet distribution.
+static inline float Rand01(std::mt19937& rng)
+{
+    return static_cast<float>(rng() >> 8) * (1.0f / 16777216.0f);
+}
 
-        glm::vec3 tangent = glm::normalize(glm::cross(direction, perpendicular));
-        glm::vec3 bitangent = glm::cross(direction, tangent);
+static void FillRandom01(std::mt19937& rng, float* out, int n)
+{
+    for (int i = 0; i < n; ++i) out[i] = Rand01(rng);
+}
 
-        float x = std::sin(angle) * std::cos(azimuth);
-        float y = std::sin(angle) * std::sin(azimuth);
-        float z = std::cos(angle);
+// Chaque étape travaille sur des tableaux de kBatch floats (tirages groupés, boucles sans
+// branchement vectorisables).
+void BranchGenerator::SampleSpawns(
+    const PreparedBranch& k,
+    std::mt19937& rng,
+    int spawnIndex,
+    int count,
+    int totalSpawns,
+    glm::vec3* outVelocity,
+    float* outDamping,
+    float* outSize
+)
+{
+    static const float TWO_PI = 2.0f * 3.14159265358979323846f;
 
-        glm::vec3 result = z * direction + x * tangent + y * bitangent;
-        return glm::normalize(result);
-    };
+    const BranchDescriptor& d = *k.params;
+    const float invDenom = (totalSpawns > 1) ? 1.0f / static_cast<float>(totalSpawns - 1) : 1.0f;
+    const bool spread = (k.halfSpreadRad > 0.0f);
+    const bool jitter = (k.sparkleJitter > 0.0f);
+    const bool dampVar = (d.dampingVariance > 0.0f);
+
+    float uVar[kBatch], uSpeed[kBatch], speed[kBatch];
+    float angle[kBatch], azimuth[kBatch], uJitter[kBatch], uDamp[kBatch], uSize[kBatch];
+
+    for (int base = 0; base < count; base += kBatch) {
+        const int n = std::min(kBatch, count - base);
+        glm::vec3* velocity = outVelocity + base;
+
+        // ── Tirages groupés (uniquement ceux utilisés par cette branche)
+        FillRandom01(rng, uVar, n);
+        FillRandom01(rng, uSpeed, n);
+        if (spread) {
+            FillRandom01(rng, angle, n);
+            FillRandom01(rng, azimuth, n);
+        }
+        if (jitter) FillRandom01(rng, uJitter, n);
+        if (dampVar) FillRandom01(rng, uDamp, n);
+        FillRandom01(rng, uSize, n);
+
+        // ── Vitesse scalaire : variance + tête / queue selon l'ordre d'émission
+        // progress=0 : tête (plus rapide), progress=1 : queue (plus lente)
+        for (int i = 0; i < n; ++i) {
+            const float progress = std::min(1.0f, static_cast<float>(spawnIndex + base + i) * invDenom);
+            float u = uSpeed[i];
+            u = (progress <= k.frontPortion) ? Biased01(u, k.frontSpeedBias) : u * k.backSpeedScale;
+            const float speedMultiplierVar = 1.0f + (uVar[i] - 0.5f) * 2.0f * k.speedVariance;
+            const float speedMultiplier = 0.6f + 0.8f * u; // [0.6..1.4]
+            speed[i] = d.initialSpeed * speedMultiplierVar * speedMultiplier;
+        }
 
-    // Position initiale
-    p.position = worldPosition;
+        // ── Direction : spread angulaire dans la base précalculée de la branche
+        if (spread) {
+            for (int i = 0; i < n; ++i) {
+                const float a = angle[i] * k.halfSpreadRad;
+                const float az = azimuth[i] * TWO_PI;
+                const float sa = std::sin(a);
+                const glm::vec3 dir = std::cos(a) * k.direction + (sa * std::cos(az)) * k.tangent + (sa * std::sin(az)) * k.bitangent;
+                velocity[i] = glm::normalize(dir) * std::abs(speed[i]);
+            }
+        } else {
+            for (int i = 0; i < n; ++i) velocity[i] = k.direction * speed[i];
+        }
 
-    float u = dist01(s_rng);
-    float baseSpeed = branch.initialSpeed;
+        // Sparkle: jitter additionnel de vitesse
+        if (jitter) {
+            for (int i = 0; i < n; ++i) velocity[i] *= 1.0f + (uJitter[i] - 0.5f) * 2.0f * k.sparkleJitter;
+        }
 
-    // Variance simple
-    float speedVar = branch.speedVariance;
-    if (branch.visualMode == BranchDescriptor::VisualMode::Sparkle) {
-        speedVar *= (1.0f + std::max(0.0f, branch.sparkleSpeedJitter));
-    }
-    float speedMultiplierVar = 1.0f + (u - 0.5f) * 2.0f * speedVar;
-
-    // En émission étalée, l'ordre (progress) est la source principale de "tête"/"queue".
-    // progress=0 : tête (plus rapide), progress=1 : queue (plus lente)
-    const float progress = std::max(0.0f, std::min(1.0f, orderedProgress01));
-    const bool isFront = (progress <= std::max(0.0f, std::min(1.0f, branch.frontPortion)));
-
-    float uSpeed = dist01(s_rng);
-    if (isFront) {
-        uSpeed = Biased01(uSpeed, std::max(1.0f, branch.frontSpeedBias));
-    } else {
-        uSpeed *= std::max(0.0f, std::min(1.0f, branch.backSpeedScale));
+        // ── Drag et taille
+        for (int i = 0; i < n; ++i) {
+            float damp = d.damping;
+            if (dampVar) damp *= 1.0f + (uDamp[i] - 0.5f) * 2.0f * d.dampingVariance;
+            outDamping[base + i] = (damp < 0.0f) ? 0.0f : damp;
+            outSize[base + i] = d.particleSize * (1.0f + (uSize[i] - 0.5f) * 2.0f * d.sizeVariance);
+        }
     }
+}
 
-    // Map vers un multiplier autour de 1.0
-    float speedMultiplier = 0.6f + 0.8f * uSpeed; // [0.6..1.4]
-    baseSpeed *= speedMultiplierVar * speedMultiplier;
-
-    glm::vec3 velocity = branch.direction * baseSpeed;
-
-    // Appliquer spread angulaire (+ boost sparkle)
-    float spread = branch.angularSpread;
-    if (branch.visualMode == BranchDescriptor::VisualMode::Sparkle) {
-        spread *= std::max(0.0f, branch.sparkleSpreadMult);
-    }
-    if (spread > 0.0f) {
-        glm::vec3 spreadDir = RandomInConeLocal(branch.direction, spread * 0.5f);
-        float speed = glm::length(velocity);
-        velocity = spreadDir * speed;
+// Écriture des particules à partir de tirages déjà faits (live ou table compilée).
+static void WriteParticles(
+    const BranchGenerator::PreparedBranch& k,
+    uint16_t paramsIndex,
+    const glm::vec3& worldPosition,
+    Particle* particles,
+    int count,
+    const glm::vec3* velocity,
+    const float* damping,
+    const float* size,
+    const EmissionTransform* transform
+)
+{
+    const BranchDescriptor& d = *k.params;
+    const uint8_t recursionDepth = static_cast<uint8_t>(k.recursionDepth);
+    const glm::vec4 color = transform ? k.color * transform->tint : k.color;
+
+    for (int i = 0; i < count; ++i) {
+        Particle& p = particles[i];
+        p.position = worldPosition;
+        p.velocity = transform ? transform->velocity * velocity[i] : velocity[i];
+        p.damping = damping[i];
+        p.color = color;
+        p.baseColor = color;
+        p.size = size[i];
+        p.lifeTime = d.lifetime;
+        p.originalLifeTime = d.lifetime;
+        p.shapeId = d.shapeId;
+        // Gravité, fade, trail, smoke : partagés via la table du pool
+        p.paramsIndex = paramsIndex;
+        p.trailSampleAccum = 0.0f;
+        p.trailHead = 0;
+        p.trailCount = 0;
+        p.recursionDepthRemaining = recursionDepth;
+        p.active = true;
     }
+}
 
-    // Sparkle: jitter additionnel de vitesse
-    if (branch.visualMode == BranchDescriptor::VisualMode::Sparkle && branch.sparkleSpeedJitter > 0.0f) {
-        float j = (dist01(s_rng) - 0.5f) * 2.0f * branch.sparkleSpeedJitter;
-        velocity *= (1.0f + j);
+int BranchGenerator::EmitPreparedRange(
+    const PreparedBranch& prepared,
+    uint16_t paramsIndex,
+    const glm::vec3& worldPosition,
+    ParticlePool& pool,
+    int spawnIndex,
+    int count,
+    int totalSpawns,
+    std::vector<ParticleSpan>* outSpans
+)
+{
+    if (!prepared.params) return 0;
+
+    glm::vec3 velocity[kBatch];
+    float damping[kBatch];
+    float size[kBatch];
+
+    int emitted = 0;
+    while (emitted < count) {
+        const ParticleSpan span = pool.AllocateRange(count - emitted);
+        if (span.count == 0) break; // pool plein
+
+        Particle* particles = &pool.Get(span.first);
+        for (int base = 0; base < span.count; base += kBatch) {
+            const int n = std::min(kBatch, span.count - base);
+            SampleSpawns(prepared, s_rng, spawnIndex + emitted + base, n, totalSpawns, velocity, damping, size);
+            WriteParticles(prepared, paramsIndex, worldPosition, particles + base, n, velocity, damping, size, nullptr);
+        }
+        if (outSpans) outSpans->push_back(span);
+        emitted += span.count;
     }
+    return emitted;
+}
 
-    p.velocity = velocity;
+void BranchGenerator::WriteSampled(
+    const PreparedBranch& prepared,
+    uint16_t paramsIndex,
+    const glm::vec3& worldPosition,
+    Particle* particles,
+    int count,
+    const glm::vec3* velocity,
+    const float* damping,
+    const float* size,
+    const EmissionTransform* transform
+)
+{
+    if (!prepared.params || count <= 0) return;
+    WriteParticles(prepared, paramsIndex, worldPosition, particles, count, velocity, damping, size, transform);
+}
 
-    // Drag
-    float damp = branch.damping;
-    if (branch.dampingVariance > 0.0f) {
-        float mult = 1.0f + (dist01(s_rng) - 0.5f) * 2.0f * branch.dampingVariance;
-        damp *= mult;
-    }
-    if (damp < 0.0f) damp = 0.0f;
-    p.damping = damp;
-
-    // Gravité (contrôle artistique)
-    p.gravityScale = branch.gravityScale;
-    p.updraft = branch.updraft;
-
-    // Couleur
-    p.color = branch.color;
-    p.baseColor = branch.color;
-
-    // Taille avec variance
-    float sizeVar = 1.0f + (dist01(s_rng) - 0.5f) * 2.0f * branch.sizeVariance;
-    p.size = branch.particleSize * sizeVar;
-
-    // Durée de vie
-    p.lifeTime = branch.lifetime;
-    p.originalLifeTime = branch.lifetime;
-
-    // Shape
-    p.shapeId = branch.shapeId;
-
-    // Fade
-    p.shouldFade = branch.shouldFade;
-    p.fadeStartRatio = branch.fadeStartRatio;
-
-    // Trail
-    p.trailEnabled = branch.trailEnabled;
-    p.trailWidth = branch.trailWidth;
-    p.trailDuration = branch.trailDuration;
-    p.trailOpacity = branch.trailOpacity;
-    p.trailFalloffPow = branch.trailFalloffPow;
-    if (p.trailEnabled && p.trailDuration > 0.0f) {
-        const float denom = static_cast<float>(ParticlePool::kTrailSamples - 1);
-        p.trailSamplePeriod = (denom > 0.0f) ? (p.trailDuration / denom) : (1.0f / 60.0f);
-        if (p.trailSamplePeriod < 1.0f / 240.0f) p.trailSamplePeriod = 1.0f / 240.0f;
-        if (p.trailSamplePeriod > 1.0f / 10.0f)  p.trailSamplePeriod = 1.0f / 10.0f;
-    } else {
-        p.trailSamplePeriod = 1.0f / 60.0f;
-    }
-    p.trailSampleAccum = 0.0f;
-    p.trailHead = 0;
-    p.trailCount = 0;
+int BranchGenerator::EmitSampled(
+    const PreparedBranch& prepared,
+    uint16_t paramsIndex,
+    const glm::vec3& worldPosition,
+    ParticlePool& pool,
+    const glm::vec3* velocity,
+    const float* damping,
+    const float* size,
+    int count,
+    const EmissionTransform* transform
+)
+{
+    if (!prepared.params) return 0;
+
+    int emitted = 0;
+    while (emitted < count) {
+        const ParticleSpan span = pool.AllocateRange(count - emitted);
+        if (span.count == 0) break; // pool plein
 
-    // Smoke / recursion
-    p.smokeAmount = std::max(0.0f, std::min(1.0f, branch.smokeAmount));
-    p.recursionDepthRemaining = std::max(0, branch.recursionDepth);
-    p.recursionProb = std::max(0.0f, std::min(1.0f, branch.recursionProb));
+        WriteParticles(prepared, paramsIndex, worldPosition, &pool.Get(span.first), span.count,
+                       velocity + emitted, damping + emitted, size + emitted, transform);
+        emitted += span.count;
+    }
+    return emitted;
+}
 
-    p.active = true;
+int BranchGenerator::EmitPrepared(const PreparedBranch& prepared, const glm::vec3& worldPosition, ParticlePool& pool)
+{
+    if (!prepared.params) return 0;
+    const uint16_t paramsIndex = pool.InternEmitterParams(prepared.emitterParams);
+    return EmitPreparedRange(prepared, paramsIndex, worldPosition, pool, 0, prepared.particleCount, prepared.particleCount);
 }
 
 int BranchGenerator::EmitParticle(
     const GeneratedBranch& branch,
-    const PhysicsProfile& physics,
     const glm::vec3& worldPosition,
     ParticlePool& pool,
     int spawnIndex,
     int totalSpawns
 )
 {
-    (void)physics;
-    const int idx = pool.Allocate();
-    if (idx < 0) return -1;
-
-    const float denom = (totalSpawns > 1) ? static_cast<float>(totalSpawns - 1) : 1.0f;
-    const float progress = std::max(0.0f, std::min(1.0f, static_cast<float>(spawnIndex) / denom));
-
-    Particle& p = pool.Get(idx);
-    InitParticleFromBranch(p, branch, worldPosition, progress);
-    return idx;
+    const PreparedBranch prepared = Prepare(branch);
+    if (!prepared.params) return -1;
+
+    const uint16_t paramsIndex = pool.InternEmitterParams(prepared.emitterParams);
+    const ParticleSpan span = pool.AllocateRange(1);
+    if (span.count == 0) return -1;
+
+    glm::vec3 velocity;
+    float damping;
+    float size;
+    SampleSpawns(prepared, s_rng, spawnIndex, 1, totalSpawns, &velocity, &damping, &size);
+    WriteParticles(prepared, paramsIndex, worldPosition, &pool.Get(span.first), 1, &velocity, &damping, &size, nullptr);
+    return span.first;
 }
 
-std::vector<int> BranchGenerator::EmitBranch(
+int BranchGenerator::EmitBranch(
     const GeneratedBranch& branch,
-    const PhysicsProfile& physics,
     const glm::vec3& worldPosition,
-    ParticlePool& pool
+    ParticlePool& pool,
+    std::vector<ParticleSpan>* outSpans
 )
 {
-    std::vector<int> indices;
-    indices.reserve(branch.particlesPerBranch);
-
-    for (int i = 0; i < branch.particlesPerBranch; ++i) {
-        const int idx = EmitParticle(branch, physics, worldPosition, pool, i, branch.particlesPerBranch);
-        if (idx < 0) break;
-        indices.push_back(idx);
-    }
-
-    return indices;
-}
-
-glm::vec3 BranchGenerator::RandomInCone(const glm::vec3& direction, float halfAngleDeg)
-{
-    static const float TWO_PI = 2.0f * 3.14159265358979323846f;
-
-    std::uniform_real_distribution<float> distAngle(0.0f, glm::radians(halfAngleDeg));
-    std::uniform_real_distribution<float> distAzimuth(0.0f, TWO_PI);
-
-    float angle = distAngle(s_rng);
-    float azimuth = distAzimuth(s_rng);
-
-    // Créer un vecteur perpendiculaire à direction
-    glm::vec3 perpendicular;
-    if (std::abs(direction.y) < 0.9f) {
-        perpendicular = glm::vec3(0.0f, 1.0f, 0.0f);
-    }
-    else {
-        perpendicular = glm::vec3(1.0f, 0.0f, 0.0f);
-    }
-
-    glm::vec3 tangent = glm::normalize(glm::cross(direction, perpendicular));
-    glm::vec3 bitangent = glm::cross(direction, tangent);
-
-    // Rotation dans le cone
-    float x = std::sin(angle) * std::cos(azimuth);
-    float y = std::sin(angle) * std::sin(azimuth);
-    float z = std::cos(angle);
+    const PreparedBranch prepared = Prepare(branch);
+    if (!prepared.params) return 0;
 
-    glm::vec3 result = z * direction + x * tangent + y * bitangent;
-    return glm::normalize(result);
+    const uint16_t paramsIndex = pool.InternEmitterParams(prepared.emitterParams);
+    return EmitPreparedRange(prepared, paramsIndex, worldPosition, pool, 0, prepared.particleCount, prepared.particleCount, outSpans);
 }
\ No newline at end of file
@@ -1,21 +1,119 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <memory>
+#include <random>
 #include <vector>
 #include "../template/PhysicsProfile.h"
 #include "../template/GeneratedBranch.h"
+#include "../template/TemplateOverride.h"
 #include "../particle/ParticlePool.h"
 
 // Générateur de branches : calcule les vitesses initiales et émet les particules
 class BranchGenerator {
 public:
-    // Émet une branche complète dans le pool
-    // Retourne les indices des particules allouées
-    static std::vector<int> EmitBranch(
+    // Taille des lots de tirages / calculs (tableaux sur la pile).
+    static constexpr int kBatch = 64;
+
+    // Constantes d'émission d'une branche : lues une fois dans le bloc partagé du template
+    // (clamps, mode Sparkle, base du cone, période de trail) puis réutilisées pour chaque
+    // particule. Garde son propre bloc de paramètres : une émission étalée en cours n'est
+    // pas affectée par une régénération du template.
+    struct PreparedBranch {
+        std::shared_ptr<const BranchDescriptor> params;   // nullptr => rien à émettre
+        glm::vec3 direction = glm::vec3(0.0f, 1.0f, 0.0f);
+        glm::vec4 color = glm::vec4(1.0f);
+
+        glm::vec3 tangent = glm::vec3(1.0f, 0.0f, 0.0f);   // base du cone autour de direction
+        glm::vec3 bitangent = glm::vec3(0.0f, 0.0f, 1.0f);
+
+        float speedVariance = 0.0f;     // sparkle jitter inclus
+        float frontPortion = 1.0f;
+        float frontSpeedBias = 1.0f;
+        float backSpeedScale = 1.0f;
+        float halfSpreadRad = 0.0f;     // sparkle mult inclus
+        float sparkleJitter = 0.0f;     // 0 hors mode Sparkle
+        int recursionDepth = 0;
+        int particleCount = 0;
+
+        // Constantes par particule partagées (fade, gravité, trail, smoke / récursion),
+        // à enregistrer dans le pool avec ParticlePool::InternEmitterParams().
+        EmitterParams emitterParams;
+    };
+
+    static PreparedBranch Prepare(const GeneratedBranch& branch);
+
+    // Émet une branche préparée (burst). Retourne le nombre de particules allouées.
+    static int EmitPrepared(const PreparedBranch& prepared, const glm::vec3& worldPosition, ParticlePool& pool);
+
+    // Émet les spawns [spawnIndex, spawnIndex + count) d'une branche préparée, en plages
+    // contiguës du pool (ParticlePool::AllocateRange) remplies par lots.
+    // paramsIndex : résultat de pool.InternEmitterParams(prepared.emitterParams), à obtenir
+    // une fois par branche et par pas plutôt qu'à chaque particule.
+    // outSpans (optionnel) reçoit les plages allouées. Retourne le nombre de particules
+    // émises (< count si le pool est plein).
+    static int EmitPreparedRange(
+        const PreparedBranch& prepared,
+        uint16_t paramsIndex,
+        const glm::vec3& worldPosition,
+        ParticlePool& pool,
+        int spawnIndex,
+        int count,
+        int totalSpawns,
+        std::vector<ParticleSpan>* outSpans = nullptr
+    );
+
+    // Tire vitesse, drag et taille des spawns [spawnIndex, spawnIndex + count) avec rng.
+    // Sert à l'émission live et à la compilation des tables d'EmissionRecipe.
+    static void SampleSpawns(
+        const PreparedBranch& prepared,
+        std::mt19937& rng,
+        int spawnIndex,
+        int count,
+        int totalSpawns,
+        glm::vec3* outVelocity,
+        float* outDamping,
+        float* outSize
+    );
+
+    // Émet count particules à partir de tirages déjà faits (tables d'EmissionRecipe) :
+    // simple copie + position de l'événement. transform (optionnel) : réglages de
+    // l'événement (rotation / échelle des vitesses, teinte). Retourne le nombre de particules
+    // émises.
+    static int EmitSampled(
+        const PreparedBranch& prepared,
+        uint16_t paramsIndex,
+        const glm::vec3& worldPosition,
+        ParticlePool& pool,
+        const glm::vec3* velocity,
+        const float* damping,
+        const float* size,
+        int count,
+        const EmissionTransform* transform = nullptr
+    );
+
+    // Initialise count particules déjà allouées (ParticlePool::AllocateRange) à partir de
+    // tirages déjà faits. Ne touche que ces particules : des plages disjointes peuvent être
+    // remplies depuis plusieurs threads.
+    static void WriteSampled(
+        const PreparedBranch& prepared,
+        uint16_t paramsIndex,
+        const glm::vec3& worldPosition,
+        Particle* particles,
+        int count,
+        const glm::vec3* velocity,
+        const float* damping,
+        const float* size,
+        const EmissionTransform* transform = nullptr
+    );
+
+    // Émet une branche complète dans le pool.
+    // outSpans (optionnel) reçoit les plages allouées. Retourne le nombre de particules émises.
+    static int EmitBranch(
         const GeneratedBranch& branch,
-        const PhysicsProfile& physics,
         const glm::vec3& worldPosition,
-        ParticlePool& pool
+        ParticlePool& pool,
+        std::vector<ParticleSpan>* outSpans = nullptr
     );
 
     // Émet une seule particule.
@@ -24,21 +122,9 @@ public:
     // Retourne l'index alloué, ou -1 si le pool est plein.
     static int EmitParticle(
         const GeneratedBranch& branch,
-        const PhysicsProfile& physics,
         const glm::vec3& worldPosition,
         ParticlePool& pool,
         int spawnIndex,
         int totalSpawns
     );
-
-private:
-    // Calcule la vitesse initiale pour une particule de cette branche
-    static glm::vec3 ComputeInitialVelocity(
-        const GeneratedBranch& branch,
-        const PhysicsProfile& physics,
-        float randomSeed  // 0-1 pour variance
-    );
-
-    // Génère une direction aléatoire dans le cone angularSpread
-    static glm::vec3 RandomInCone(const glm::vec3& direction, float halfAngleDeg);
 };
\ No newline at end of file
@@ -35,8 +35,6 @@ void ColorSchemeEvaluator::ApplyColors(
         color = ApplyVariances(color, scheme.saturationVariance, scheme.brightnessVariance);
 
         branches[i].color = color;
-        branches[i].shouldFade = scheme.fadeOverTime;
-        branches[i].fadeStartRatio = scheme.fadeStartRatio;
     }
 }
 
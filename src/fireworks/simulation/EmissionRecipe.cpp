@@ -0,0 +1,71 @@
+#include "EmissionRecipe.h"
+
+#include <algorithm>
+#include <random>
+
+std::shared_ptr<const EmissionRecipe> EmissionRecipe::Build(const std::vector<GeneratedBranch>& generated, uint64_t version)
+{
+    auto recipe = std::make_shared<EmissionRecipe>();
+    recipe->version = version;
+    recipe->branches.reserve(generated.size());
+
+    size_t totalSpawns = 0;
+    for (const auto& b : generated) {
+        Branch branch;
+        branch.prepared = BranchGenerator::Prepare(b);
+        branch.firstSpawn = static_cast<uint32_t>(totalSpawns);
+
+        const BranchDescriptor* d = branch.prepared.params.get();
+        const int count = branch.prepared.particleCount;
+        // 0 = burst. Otherwise, distribute spawns over emissionDuration.
+        if (d && d->emissionDuration > 0.0f && count > 0) {
+            branch.interval = std::max(1.0f / 240.0f, d->emissionDuration / static_cast<float>(count));
+        }
+
+        totalSpawns += static_cast<size_t>(count);
+        recipe->branches.push_back(branch);
+    }
+
+    recipe->velocity.resize(totalSpawns);
+    recipe->damping.resize(totalSpawns);
+    recipe->size.resize(totalSpawns);
+
+    // Flux déterministe : même version de template => mêmes tables
+    std::mt19937 rng(static_cast<std::mt19937::result_type>(version * 0x9E3779B97F4A7C15ull >> 32));
+    for (const auto& branch : recipe->branches) {
+        const int count = branch.prepared.particleCount;
+        if (!branch.prepared.params || count <= 0) continue;
+        BranchGenerator::SampleSpawns(branch.prepared, rng, 0, count, count,
+            &recipe->velocity[branch.firstSpawn],
+            &recipe->damping[branch.firstSpawn],
+            &recipe->size[branch.firstSpawn]);
+    }
+
+    return recipe;
+}
+
+int EmissionRecipe::Emit(size_t branchIndex, uint16_t paramsIndex, const glm::vec3& worldPosition, ParticlePool& pool, int spawnIndex, int count,
+                         const EmissionTransform* transform) const
+{
+    if (branchIndex >= branches.size()) return 0;
+    const Branch& b = branches[branchIndex];
+    count = std::min(count, b.prepared.particleCount - spawnIndex);
+    if (spawnIndex < 0 || count <= 0) return 0;
+
+    const size_t first = b.firstSpawn + static_cast<size_t>(spawnIndex);
+    return BranchGenerator::EmitSampled(b.prepared, paramsIndex, worldPosition, pool,
+        &velocity[first], &damping[first], &size[first], count, transform);
+}
+
+void EmissionRecipe::Write(size_t branchIndex, uint16_t paramsIndex, const glm::vec3& worldPosition, Particle* particles, int spawnIndex, int count,
+                           const EmissionTransform* transform) const
+{
+    if (branchIndex >= branches.size()) return;
+    const Branch& b = branches[branchIndex];
+    count = std::min(count, b.prepared.particleCount - spawnIndex);
+    if (spawnIndex < 0 || count <= 0) return;
+
+    const size_t first = b.firstSpawn + static_cast<size_t>(spawnIndex);
+    BranchGenerator::WriteSampled(b.prepared, paramsIndex, worldPosition, particles, count,
+        &velocity[first], &damping[first], &size[first], transform);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include "BranchGenerator.h"
+#include "../template/GeneratedBranch.h"
+#include "../particle/ParticlePool.h"
+
+// Forme "compilée" d'un template pour l'émission, construite par FireworkTemplate après
+// chaque régénération des branches et partagée (immuable) par les instances.
+//
+// Les tirages de chaque spawn (vitesse, drag, taille) sont faits une fois, avec un RNG
+// déterministe dérivé de la version du template, et rangés en tables SoA. Un déclenchement
+// se réduit alors à une copie des tables + la position de l'événement ; deux instances
+// d'une même version de template émettent le même motif.
+class EmissionRecipe {
+public:
+    struct Branch {
+        BranchGenerator::PreparedBranch prepared;
+        uint32_t firstSpawn = 0;   // offset de la branche dans les tables
+        float interval = 0.0f;     // secondes entre spawns ; 0 => burst
+    };
+
+    static std::shared_ptr<const EmissionRecipe> Build(const std::vector<GeneratedBranch>& branches, uint64_t version);
+
+    uint64_t GetVersion() const { return version; }
+    const std::vector<Branch>& GetBranches() const { return branches; }
+    size_t GetSpawnCount() const { return velocity.size(); }
+
+    // Émet les spawns [spawnIndex, spawnIndex + count) de la branche branchIndex, transformés
+    // par transform si fourni (réglages de l'événement, voir TemplateOverride).
+    // Retourne le nombre de particules émises (< count si le pool est plein).
+    int Emit(size_t branchIndex, uint16_t paramsIndex, const glm::vec3& worldPosition, ParticlePool& pool, int spawnIndex, int count,
+             const EmissionTransform* transform = nullptr) const;
+
+    // Comme Emit, mais dans count particules déjà allouées (émission différée, voir
+    // EmissionBatch) : aucun accès au pool, sûr depuis plusieurs threads sur des plages
+    // disjointes.
+    void Write(size_t branchIndex, uint16_t paramsIndex, const glm::vec3& worldPosition, Particle* particles, int spawnIndex, int count,
+               const EmissionTransform* transform = nullptr) const;
+
+private:
+    uint64_t version = 0;
+    std::vector<Branch> branches;
+
+    // Tables par spawn, indexées par Branch::firstSpawn + spawnIndex
+    std::vector<glm::vec3> velocity;
+    std::vector<float> damping;
+    std::vector<float> size;
+};
@@ -62,6 +62,13 @@ struct BranchDescriptor {
     int   recursionDepth  = 0;
     float recursionProb   = 0.0f;
 
+    // ═══ BUDGET RÉCURSION ═══
+    // Particules attendues par obus (primaires + fumée + récursion), 0 = illimité.
+    // Au-delà, FireworkTemplate réduit le nombre moyen d'étincelles par gerbe.
+    int   recursionBudget = 0;
+    // Piloté par FireworkTemplate (budget) : étincelles par gerbe, en moyenne.
+    float recursionChildren = 6.0f;
+
     // ═══ FADE (piloté par ColorScheme) ═══
     bool shouldFade = false;
     float fadeStartRatio = 0.5f;
@@ -1,10 +1,11 @@
 ﻿#include "FireworkTemplate.h"
 #include "../simulation/BranchLayoutGenerator.h"
 #include "../simulation/ColorSchemeEvaluator.h"
+#include "../simulation/EmissionRecipe.h"
+#include "../particle/ParticlePool.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include <cmath>
 #include <algorithm>
-#include <iostream>
 
 FireworkTemplate::FireworkTemplate()
     : name("Unnamed Firework")
@@ -17,6 +18,8 @@ FireworkTemplate::FireworkTemplate()
     , layout()
     , colorScheme()
     , branchTemplate()
+    , dirtyFlags(DirtyAll)
+    , branchesVersion(0)
 {
 }
 
@@ -31,19 +34,41 @@ FireworkTemplate::FireworkTemplate(const std::string& _name)
     , layout()
     , colorScheme()
     , branchTemplate()
+    , dirtyFlags(DirtyAll)
+    , branchesVersion(0)
 {
 }
 
 void FireworkTemplate::RegenerateBranches()
 {
-    // ═══════════════════════════════════════════════════════════
-    // DEBUG
-    // ═══════════════════════════════════════════════════════════
-    std::cerr << "[RegenerateBranches] Called!" << std::endl;
-    std::cerr << "  initialSpeed: " << branchTemplate.initialSpeed << std::endl;
-    std::cerr << "  damping: " << branchTemplate.damping << std::endl;
-    std::cerr << "  particlesPerBranch: " << branchTemplate.particlesPerBranch << std::endl;
+    MarkDirty(DirtyAll);
+    UpdateBranches();
+}
 
+bool FireworkTemplate::UpdateBranches()
+{
+    if (dirtyFlags == 0) return false;
+
+    // Le nombre de branches peut changer : toutes les étapes suivantes sont à refaire.
+    if (dirtyFlags & DirtyLayout) dirtyFlags |= DirtyRotation | DirtyParams | DirtyColors;
+    // Le mode Radial colore selon la direction (tournée).
+    if ((dirtyFlags & DirtyRotation) && colorScheme.type == ColorDistributionType::Radial) dirtyFlags |= DirtyColors;
+    // Le fade vient du ColorScheme mais fait partie du bloc partagé.
+    if (dirtyFlags & DirtyColors) dirtyFlags |= DirtyParams;
+
+    if (dirtyFlags & DirtyLayout) GenerateLayout();
+    if (dirtyFlags & DirtyRotation) ApplyRotation();
+    if (dirtyFlags & DirtyParams) BroadcastParams();
+    if (dirtyFlags & DirtyColors) ColorSchemeEvaluator::ApplyColors(colorScheme, layout, generatedBranches);
+
+    dirtyFlags = 0;
+    ++branchesVersion;
+    emissionRecipe = EmissionRecipe::Build(generatedBranches, branchesVersion);
+    return true;
+}
+
+void FireworkTemplate::GenerateLayout()
+{
     // ═══════════════════════════════════════════════════════════
     // ÉTAPE 1 : Copier les contraintes dans le layout
     // ═══════════════════════════════════════════════════════════
@@ -57,6 +82,14 @@ void FireworkTemplate::RegenerateBranches()
     // ═══════════════════════════════════════════════════════════
     BranchLayoutGenerator::Generate(layout, generatedBranches);
 
+    layoutDirections.resize(generatedBranches.size());
+    for (size_t i = 0; i < generatedBranches.size(); ++i) {
+        layoutDirections[i] = generatedBranches[i].direction;
+    }
+}
+
+void FireworkTemplate::ApplyRotation()
+{
     // ═══════════════════════════════════════════════════════════
     // ÉTAPE 3 : Appliquer la rotation mondiale
     // ═══════════════════════════════════════════════════════════
@@ -68,53 +101,82 @@ void FireworkTemplate::RegenerateBranches()
     rotationMatrix = glm::rotate(rotationMatrix, glm::radians(worldRotation.x), glm::vec3(1.0f, 0.0f, 0.0f)); // Pitch
     rotationMatrix = glm::rotate(rotationMatrix, glm::radians(worldRotation.z), glm::vec3(0.0f, 0.0f, 1.0f)); // Roll
 
-    // Appliquer rotation à toutes les directions
-    for (auto& branch : generatedBranches) {
-        glm::vec4 rotatedDir = rotationMatrix * glm::vec4(branch.direction, 0.0f);
-        branch.direction = glm::normalize(glm::vec3(rotatedDir));
+    // Toujours depuis les directions du layout : les rotations ne s'accumulent pas
+    for (size_t i = 0; i < generatedBranches.size(); ++i) {
+        glm::vec4 rotatedDir = rotationMatrix * glm::vec4(layoutDirections[i], 0.0f);
+        generatedBranches[i].direction = glm::normalize(glm::vec3(rotatedDir));
     }
+}
 
+void FireworkTemplate::BroadcastParams()
+{
     // ═══════════════════════════════════════════════════════════
-    // ÉTAPE 4 : Copier les paramètres de branche
+    // ÉTAPE 4 : Publier les paramètres de branche (un seul bloc partagé)
     // ═══════════════════════════════════════════════════════════
+    auto params = std::make_shared<BranchDescriptor>(branchTemplate);
+    params->shouldFade = colorScheme.fadeOverTime;
+    params->fadeStartRatio = colorScheme.fadeStartRatio;
+    particleCost = ComputeParticleCost(branchTemplate, generatedBranches.size());
+    params->recursionChildren = particleCost.childrenPerBurst;
+    branchParams = std::move(params);
+
     for (auto& branch : generatedBranches) {
-        branch.initialSpeed = branchTemplate.initialSpeed;
-        branch.speedVariance = branchTemplate.speedVariance;
-        branch.damping = branchTemplate.damping;
-        branch.dampingVariance = branchTemplate.dampingVariance;
-        branch.gravityScale = branchTemplate.gravityScale;
-        branch.updraft = branchTemplate.updraft;
-        branch.angularSpread = branchTemplate.angularSpread;
-        branch.particlesPerBranch = branchTemplate.particlesPerBranch;
-        branch.emissionDuration = branchTemplate.emissionDuration;
-        branch.particleSize = branchTemplate.particleSize;
-        branch.sizeVariance = branchTemplate.sizeVariance;
-        branch.lifetime = branchTemplate.lifetime;
-        branch.shapeId = branchTemplate.shapeId;
-
-        branch.visualMode = branchTemplate.visualMode;
-        branch.trailEnabled = branchTemplate.trailEnabled;
-        branch.trailWidth = branchTemplate.trailWidth;
-        branch.trailDuration = branchTemplate.trailDuration;
-        branch.trailOpacity = branchTemplate.trailOpacity;
-        branch.trailFalloffPow = branchTemplate.trailFalloffPow;
-
-        branch.frontPortion = branchTemplate.frontPortion;
-        branch.frontSpeedBias = branchTemplate.frontSpeedBias;
-        branch.backSpeedScale = branchTemplate.backSpeedScale;
-
-        branch.sparkleSpeedJitter = branchTemplate.sparkleSpeedJitter;
-        branch.sparkleSpreadMult = branchTemplate.sparkleSpreadMult;
-
-        branch.smokeAmount = branchTemplate.smokeAmount;
-        branch.recursionDepth = branchTemplate.recursionDepth;
-        branch.recursionProb = branchTemplate.recursionProb;
+        branch.params = branchParams;
     }
+}
 
-    // ═══════════════════════════════════════════════════════════
-    // ÉTAPE 5 : Appliquer les couleurs
-    // ═══════════════════════════════════════════════════════════
-    ColorSchemeEvaluator::ApplyColors(colorScheme, layout, generatedBranches);
+// Étincelles créées par les niveaux de récursion sous `primaries` morts : chaque mort
+// déclenche une gerbe de `children` avec la probabilité `prob`, sur `depth` niveaux.
+static float RecursionParticles(float primaries, float children, float prob, int depth)
+{
+    float total = 0.0f;
+    float level = primaries;
+    for (int k = 0; k < depth; ++k) {
+        level *= children * prob;
+        total += level;
+    }
+    return total;
+}
+
+FireworkTemplate::ParticleCost FireworkTemplate::ComputeParticleCost(const BranchDescriptor& d, size_t branchCount)
+{
+    ParticleCost cost;
+    cost.primaries = static_cast<float>(branchCount) * static_cast<float>(std::max(0, d.particlesPerBranch));
+
+    // Mêmes règles que ParticlePool::Update (les étincelles ne fument pas).
+    const float smoke = std::max(0.0f, std::min(1.0f, d.smokeAmount));
+    if (smoke > 0.0f) cost.smoke = cost.primaries * static_cast<float>(static_cast<int>(3 + 12 * smoke));
+
+    const int depth = std::max(0, std::min(255, d.recursionDepth));
+    const float prob = std::max(0.0f, std::min(1.0f, d.recursionProb));
+    const float maxChildren = static_cast<float>(ParticlePool::kRecursionChildren);
+    cost.childrenPerBurst = maxChildren;
+    if (depth == 0 || prob <= 0.0f) return cost;
+
+    // Budget : plus grand nombre moyen d'étincelles par gerbe qui tient dans ce qui reste
+    // après primaires + fumée. Probabilité et profondeur (l'aspect) ne changent pas.
+    if (d.recursionBudget > 0) {
+        const float room = static_cast<float>(d.recursionBudget) - cost.primaries - cost.smoke;
+        if (room <= 0.0f) {
+            cost.childrenPerBurst = 0.0f;
+        }
+        else if (RecursionParticles(cost.primaries, maxChildren, prob, depth) > room) {
+            float lo = 0.0f;
+            float hi = maxChildren;
+            for (int i = 0; i < 24; ++i) { // croissant en children : dichotomie
+                const float mid = 0.5f * (lo + hi);
+                if (RecursionParticles(cost.primaries, mid, prob, depth) > room) hi = mid;
+                else lo = mid;
+            }
+            cost.childrenPerBurst = lo;
+        }
+        cost.budgetLimited = cost.childrenPerBurst < maxChildren;
+    }
+
+    cost.recursionExpected = RecursionParticles(cost.primaries, cost.childrenPerBurst, prob, depth);
+    // Pire cas : chaque gerbe tire l'arrondi supérieur et aucune n'échoue.
+    cost.recursionWorst = RecursionParticles(cost.primaries, std::ceil(cost.childrenPerBurst), 1.0f, depth);
+    return cost;
 }
 
 int FireworkTemplate::GetTotalParticleCount() const
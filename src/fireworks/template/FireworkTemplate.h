@@ -1,5 +1,7 @@
 ﻿#pragma once
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 #include <glm/glm.hpp>
@@ -9,6 +11,8 @@
 #include "BranchDescriptor.h"
 #include "GeneratedBranch.h"
 
+class EmissionRecipe;
+
 class FireworkTemplate {
 public:
     std::string name;
@@ -40,13 +44,57 @@ public:
     std::vector<GeneratedBranch> generatedBranches;
 
 public:
+    // Étapes de génération des branches, chacune recalculée seulement si elle est sale.
+    enum BranchDirtyFlags : uint32_t {
+        DirtyLayout   = 1u << 0, // zone / grille -> directions (entraîne toutes les suivantes)
+        DirtyRotation = 1u << 1, // worldRotation -> directions tournées
+        DirtyParams   = 1u << 2, // branchTemplate (+ fade) -> bloc de paramètres partagé
+        DirtyColors   = 1u << 3, // colorScheme -> couleurs par branche
+        DirtyAll      = 0xFu
+    };
+
+    // Particules créées par un obus sur toute sa vie, calculé par BroadcastParams() à partir
+    // des règles de mort du pool (fumée, gerbes de récursion).
+    struct ParticleCost {
+        float primaries = 0.0f;         // émises par les branches
+        float smoke = 0.0f;             // fumée à la mort des primaires
+        float recursionExpected = 0.0f; // étincelles, en moyenne (recursionProb)
+        float recursionWorst = 0.0f;    // si chaque mort déclenche sa gerbe, à chaque niveau
+        float childrenPerBurst = 0.0f;  // étincelles par gerbe après budget (moyenne)
+        bool budgetLimited = false;     // childrenPerBurst réduit par recursionBudget
+
+        float Expected() const { return primaries + smoke + recursionExpected; }
+        float WorstCase() const { return primaries + smoke + recursionWorst; }
+    };
+
     FireworkTemplate();
     explicit FireworkTemplate(const std::string& name);
     ~FireworkTemplate() = default;
 
-    // Régénère toutes les branches selon layout + zone + orientation
+    // Les éditeurs marquent ce qu'ils ont modifié ; UpdateBranches() (une fois par frame)
+    // regroupe toutes les modifications de la frame.
+    void MarkDirty(uint32_t flags) { dirtyFlags |= flags; }
+    bool IsDirty() const { return dirtyFlags != 0; }
+
+    // Recalcule uniquement les étapes sales. Retourne true si generatedBranches a changé.
+    bool UpdateBranches();
+
+    // Régénère toutes les branches selon layout + zone + orientation (presets, chargement)
     void RegenerateBranches();
 
+    // Incrémenté à chaque modification de generatedBranches.
+    uint64_t GetBranchesVersion() const { return branchesVersion; }
+
+    // Bloc partagé par toutes les branches (nullptr avant la première génération).
+    const std::shared_ptr<const BranchDescriptor>& GetBranchParams() const { return branchParams; }
+
+    // Tables d'émission compilées pour la version courante des branches (voir EmissionRecipe).
+    // Les instances gardent la leur jusqu'à la fin de leur émission.
+    const std::shared_ptr<const EmissionRecipe>& GetEmissionRecipe() const { return emissionRecipe; }
+
+    // Coût de la version courante des branches (budget de récursion appliqué).
+    const ParticleCost& GetParticleCost() const { return particleCost; }
+
     // Getters
     size_t GetBranchCount() const { return generatedBranches.size(); }
     int GetTotalParticleCount() const;
@@ -57,4 +105,19 @@ public:
     static FireworkTemplate Willow();
     static FireworkTemplate Ring();
     static FireworkTemplate Sphere();
+
+private:
+    void GenerateLayout();
+    void ApplyRotation();
+    void BroadcastParams();
+    static ParticleCost ComputeParticleCost(const BranchDescriptor& d, size_t branchCount);
+
+    // Directions de la grille avant rotation (cache de l'étape Layout)
+    std::vector<glm::vec3> layoutDirections;
+    // Paramètres communs publiés par BroadcastParams() (jamais modifiés une fois publiés)
+    std::shared_ptr<const BranchDescriptor> branchParams;
+    std::shared_ptr<const EmissionRecipe> emissionRecipe;
+    ParticleCost particleCost;
+    uint32_t dirtyFlags;
+    uint64_t branchesVersion;
 };
\ No newline at end of file
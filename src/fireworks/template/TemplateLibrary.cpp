@@ -3,6 +3,7 @@
 TemplateLibrary::TemplateLibrary()
     : nextId(1)
     , activeId(-1)
+    , editVersion(1)
 {
 }
 
@@ -18,15 +19,17 @@ int TemplateLibrary::Add(std::unique_ptr<FireworkTemplate> t)
     }
     int id = NextId();
     ids.push_back(id);
+    eventCopies.push_back(0);
     names.push_back(t->name);
     templates.push_back(std::move(t));
+    ++editVersion;
     if (activeId < 0) {
         activeId = id;
     }
     return id;
 }
 
-int TemplateLibrary::Clone(int sourceId)
+int TemplateLibrary::Clone(int sourceId, bool eventCopy)
 {
     const FireworkTemplate* src = Get(sourceId);
     if (!src) return -1;
@@ -42,10 +45,34 @@ int TemplateLibrary::Clone(int sourceId)
         if (t) {
             t->name = baseName + " (" + std::to_string(newId) + ")";
         }
+        eventCopies.back() = eventCopy ? 1 : 0;
     }
     return newId;
 }
 
+bool TemplateLibrary::IsEventCopy(int id) const
+{
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (ids[i] == id) return eventCopies[i] != 0;
+    }
+    return false;
+}
+
+bool TemplateLibrary::Remove(int id)
+{
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (ids[i] != id) continue;
+        ids.erase(ids.begin() + static_cast<long>(i));
+        eventCopies.erase(eventCopies.begin() + static_cast<long>(i));
+        templates.erase(templates.begin() + static_cast<long>(i));
+        if (i < names.size()) names.erase(names.begin() + static_cast<long>(i));
+        if (activeId == id) activeId = ids.empty() ? -1 : ids.front();
+        ++editVersion;
+        return true;
+    }
+    return false;
+}
+
 void TemplateLibrary::SyncNames() const
 {
     // Keep a stable vector instance for UI code that holds references.
@@ -118,3 +145,13 @@ const char* TemplateLibrary::GetName(int id) const
     }
     return nullptr;
 }
+
+size_t TemplateLibrary::UpdateDirtyBranches()
+{
+    size_t updated = 0;
+    for (auto& t : templates) {
+        if (t && t->UpdateBranches()) ++updated;
+    }
+    if (updated > 0) ++editVersion;
+    return updated;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -17,14 +18,24 @@ public:
     int Add(std::unique_ptr<FireworkTemplate> t);
 
     // Creates a deep copy of an existing template and returns the new template id.
-    // This is used by the Scene editor so each placed firework can be edited independently.
-    int Clone(int sourceId);
+    // eventCopy marks a private copy made for one scene event (copy-on-write, see
+    // UIManager::ApplyTemplateCopyOnWrite): it is released once no event references it.
+    int Clone(int sourceId, bool eventCopy = false);
+
+    bool IsEventCopy(int id) const;
+
+    // Deletes a template. The caller guarantees nothing references it any more (scene events,
+    // live instances). The active id falls back to the first template.
+    bool Remove(int id);
 
     // Utility to seed the library with presets.
     void SeedPresets();
 
     size_t Count() const { return templates.size(); }
 
+    // Template ids, in insertion order (parallel to GetNames()).
+    const std::vector<int>& GetIds() const { return ids; }
+
     const FireworkTemplate* Get(int id) const;
     FireworkTemplate* Get(int id);
 
@@ -44,6 +55,14 @@ public:
     // Convenience: fetch name for a given template id (or nullptr if not found).
     const char* GetName(int id) const;
 
+    // Applies pending MarkDirty() edits (see FireworkTemplate::UpdateBranches), once per frame.
+    // Returns how many templates had their branches rebuilt.
+    size_t UpdateDirtyBranches();
+
+    // Changes whenever a template is added or has its branches rebuilt: scene-wide caches
+    // (occupancy, lifetimes) compare it instead of every template's branches version.
+    uint64_t GetEditVersion() const { return editVersion; }
+
 private:
     int NextId();
 
@@ -53,7 +72,9 @@ private:
 private:
     int nextId;
     int activeId;
+    uint64_t editVersion;
     std::vector<int> ids;
+    std::vector<uint8_t> eventCopies; // parallel to ids: 1 = Clone(id, true)
     // Cached names for UI (refreshed on demand because templates are editable).
     mutable std::vector<std::string> names;
     std::vector<std::unique_ptr<FireworkTemplate>> templates;
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// Réglages propres à un événement de scène, appliqués au moment de l'émission.
+//
+// Le template reste partagé par tous les événements qui le référencent : pas de copie, pas
+// de régénération des branches. Seul ce qui se ramène à une transformation des tirages de
+// la recette est exposé ici ; une modification structurelle (layout, couleurs, physique...)
+// passe par une copie du template (voir UIManager::EditTemplateForSceneEvent).
+struct TemplateOverride {
+    glm::vec3 rotation = glm::vec3(0.0f); // degrés, appliquée après celle du template
+    glm::vec4 tint = glm::vec4(1.0f);     // multiplie la couleur des particules
+    float scale = 1.0f;                   // multiplie les vitesses initiales (taille de la gerbe)
+    float countScale = 1.0f;              // part des spawns émis (0-1), comme le keepRatio du budget
+
+    bool IsIdentity() const
+    {
+        return rotation == glm::vec3(0.0f) && tint == glm::vec4(1.0f) && scale == 1.0f && countScale >= 1.0f;
+    }
+
+    bool operator==(const TemplateOverride& o) const
+    {
+        return rotation == o.rotation && tint == o.tint && scale == o.scale && countScale == o.countScale;
+    }
+    bool operator!=(const TemplateOverride& o) const { return !(*this == o); }
+};
+
+// Forme "compilée" d'un TemplateOverride, appliquée à chaque particule écrite
+// (BranchGenerator::WriteSampled). La part des spawns est gérée par l'instance.
+struct EmissionTransform {
+    glm::mat3 velocity = glm::mat3(1.0f); // rotation * échelle
+    glm::vec4 tint = glm::vec4(1.0f);
+
+    static EmissionTransform From(const TemplateOverride& o)
+    {
+        // Même ordre que FireworkTemplate::ApplyRotation : Yaw (Y) → Pitch (X) → Roll (Z)
+        glm::mat4 r(1.0f);
+        r = glm::rotate(r, glm::radians(o.rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+        r = glm::rotate(r, glm::radians(o.rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+        r = glm::rotate(r, glm::radians(o.rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+
+        EmissionTransform t;
+        t.velocity = glm::mat3(r) * o.scale;
+        t.tint = o.tint;
+        return t;
+    }
+};
@@ -1,13 +1,136 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <string>
 #include "core/Application.h"
+#include "core/HeadlessRunner.h"
 
-int main()
+static void PrintExportUsage()
 {
+	std::cerr << "Usage: FireworksStudio --export <scene.fwscene> <output> [--fps N] [--size WxH]"
+	             " [--format png|y4m] [--tail SECONDS] [--threads N]\n"
+	             "  png: <output> is a directory (frame_00000.png ...)\n"
+	             "  y4m: <output> is a single .y4m file\n";
+}
+
+static void PrintHeadlessUsage()
+{
+	std::cerr << "Usage: FireworksStudio --headless <scene.fwscene> <outputDir> [--size WxH] [--fps N]"
+	             " [--times t0,t1,...] [--threads N] [--pool N] [--budget off|thin|secondary|evict]\n"
+	             "  Renders PNG snapshots on the CPU (no window / GL context).\n";
+}
+
+// Parses "--headless ..." arguments. Returns false on malformed input.
+static bool ParseHeadlessArgs(int argc, char** argv, HeadlessRunner::Settings& settings)
+{
+	if (argc < 4) return false;
+	settings.scenePath = argv[2];
+	settings.outputDir = argv[3];
+
+	for (int i = 4; i < argc; ++i) {
+		const std::string arg = argv[i];
+		const bool hasValue = (i + 1 < argc);
+		if (arg == "--size" && hasValue) {
+			if (std::sscanf(argv[++i], "%dx%d", &settings.width, &settings.height) != 2) return false;
+		}
+		else if (arg == "--fps" && hasValue) {
+			settings.fps = std::atoi(argv[++i]);
+		}
+		else if (arg == "--times" && hasValue) {
+			const char* cursor = argv[++i];
+			while (*cursor) {
+				char* end = nullptr;
+				const float t = std::strtof(cursor, &end);
+				if (end == cursor) return false;
+				settings.times.push_back(t);
+				cursor = (*end == ',') ? end + 1 : end;
+			}
+		}
+		else if (arg == "--threads" && hasValue) {
+			settings.threads = std::atoi(argv[++i]);
+		}
+		else if (arg == "--pool" && hasValue) {
+			settings.poolCapacity = std::atoi(argv[++i]);
+		}
+		else if (arg == "--budget" && hasValue) {
+			if (!ParticleBudget::ParsePolicy(argv[++i], settings.budgetPolicy)) return false;
+		}
+		else {
+			return false;
+		}
+	}
+	return settings.fps > 0 && settings.width > 0 && settings.height > 0 && settings.poolCapacity > 0;
+}
+
+// Parses "--export ..." arguments. Returns false on malformed input.
+static bool ParseExportArgs(int argc, char** argv, std::string& scenePath, FrameExporter::Settings& settings, float& tailSeconds)
+{
+	if (argc < 4) return false;
+	scenePath = argv[2];
+	settings.outputPath = argv[3];
+
+	for (int i = 4; i < argc; ++i) {
+		const std::string arg = argv[i];
+		const bool hasValue = (i + 1 < argc);
+		if (arg == "--fps" && hasValue) {
+			settings.fps = std::atoi(argv[++i]);
+		}
+		else if (arg == "--size" && hasValue) {
+			if (std::sscanf(argv[++i], "%dx%d", &settings.width, &settings.height) != 2) return false;
+		}
+		else if (arg == "--format" && hasValue) {
+			const std::string f = argv[++i];
+			if (f == "png") settings.format = FrameExporter::Format::PNG;
+			else if (f == "y4m") settings.format = FrameExporter::Format::Y4M;
+			else return false;
+		}
+		else if (arg == "--tail" && hasValue) {
+			tailSeconds = static_cast<float>(std::atof(argv[++i]));
+		}
+		else if (arg == "--threads" && hasValue) {
+			settings.encoderThreads = std::atoi(argv[++i]);
+		}
+		else {
+			return false;
+		}
+	}
+	return settings.fps > 0 && settings.width > 0 && settings.height > 0;
+}
+
+int main(int argc, char** argv)
+{
+	// Headless mode never creates a window: handled before Application exists.
+	if (argc > 1 && std::strcmp(argv[1], "--headless") == 0) {
+		HeadlessRunner::Settings headlessSettings;
+		if (!ParseHeadlessArgs(argc, argv, headlessSettings)) {
+			PrintHeadlessUsage();
+			return 2;
+		}
+		HeadlessRunner runner;
+		return runner.Run(headlessSettings);
+	}
+
+	const bool exportMode = (argc > 1 && std::strcmp(argv[1], "--export") == 0);
+
+	std::string scenePath;
+	FrameExporter::Settings exportSettings;
+	float tailSeconds = 3.0f;
+	if (exportMode && !ParseExportArgs(argc, argv, scenePath, exportSettings, tailSeconds)) {
+		PrintExportUsage();
+		return 2;
+	}
+
 	Application app;
 	if (!app.Initialize()) {
 		std::cerr << "Échec de l'initialisation de l'application\n";
 		return -1;
 	}
+
+	if (exportMode) {
+		return app.RunExport(scenePath, exportSettings, tailSeconds);
+	}
+
 	app.Run();
 	return 0;
-}
\ No newline at end of file
+}
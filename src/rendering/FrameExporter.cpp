@@ -0,0 +1,365 @@
+#include "FrameExporter.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#include <stbimage/stb_image_write.h>
+
+FrameExporter::FrameExporter()
+    : active(false)
+    , fbo(0)
+    , colorTexture(0)
+    , depthBuffer(0)
+    , submitted(0)
+    , collected(0)
+    , stopping(false)
+    , nextFrameToWrite(0)
+    , stream(nullptr)
+{
+}
+
+FrameExporter::~FrameExporter()
+{
+    Finish();
+}
+
+bool FrameExporter::Begin(const Settings& s)
+{
+    if (active) Finish();
+
+    if (s.width <= 0 || s.height <= 0 || s.fps <= 0 || s.outputPath.empty()) {
+        std::cerr << "FrameExporter: invalid settings\n";
+        return false;
+    }
+    if (s.format == Format::Y4M && ((s.width & 1) || (s.height & 1))) {
+        std::cerr << "FrameExporter: Y4M (4:2:0) needs an even width and height\n";
+        return false;
+    }
+
+    settings = s;
+    settings.pboRingSize = std::max(2, settings.pboRingSize);
+    settings.encoderThreads = std::max(1, settings.encoderThreads);
+    settings.maxPendingFrames = std::max(1, settings.maxPendingFrames);
+
+    std::error_code ec;
+    if (settings.format == Format::PNG) {
+        std::filesystem::create_directories(settings.outputPath, ec);
+        if (ec) {
+            std::cerr << "FrameExporter: cannot create " << settings.outputPath << ": " << ec.message() << "\n";
+            return false;
+        }
+    }
+    else {
+        const std::filesystem::path parent = std::filesystem::path(settings.outputPath).parent_path();
+        if (!parent.empty()) std::filesystem::create_directories(parent, ec);
+
+        stream = std::fopen(settings.outputPath.c_str(), "wb");
+        if (!stream) {
+            std::cerr << "FrameExporter: cannot open " << settings.outputPath << "\n";
+            return false;
+        }
+        // C420jpeg = full-range BT.601, matching the conversion in EncodeY4m.
+        std::fprintf(stream, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", settings.width, settings.height, settings.fps);
+    }
+
+    CreateTargets();
+
+    submitted = 0;
+    collected = 0;
+    stopping = false;
+    nextFrameToWrite = 0;
+    stats = Stats();
+
+    for (int i = 0; i < settings.encoderThreads; ++i) {
+        workers.emplace_back(&FrameExporter::EncoderLoop, this);
+    }
+
+    active = true;
+    return true;
+}
+
+void FrameExporter::CreateTargets()
+{
+    glGenTextures(1, &colorTexture);
+    glBindTexture(GL_TEXTURE_2D, colorTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, settings.width, settings.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, settings.width, settings.height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "FrameExporter: framebuffer incomplete\n";
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    const GLsizeiptr frameBytes = static_cast<GLsizeiptr>(settings.width) * settings.height * 4;
+    pbos.assign(static_cast<size_t>(settings.pboRingSize), 0);
+    fences.assign(static_cast<size_t>(settings.pboRingSize), nullptr);
+    glGenBuffers(settings.pboRingSize, pbos.data());
+    for (unsigned int pbo : pbos) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, frameBytes, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void FrameExporter::DestroyTargets()
+{
+    for (void*& f : fences) {
+        if (f) glDeleteSync(static_cast<GLsync>(f));
+        f = nullptr;
+    }
+    if (!pbos.empty()) glDeleteBuffers(static_cast<GLsizei>(pbos.size()), pbos.data());
+    pbos.clear();
+    fences.clear();
+
+    if (fbo) glDeleteFramebuffers(1, &fbo);
+    if (depthBuffer) glDeleteRenderbuffers(1, &depthBuffer);
+    if (colorTexture) glDeleteTextures(1, &colorTexture);
+    fbo = depthBuffer = colorTexture = 0;
+}
+
+void FrameExporter::BindTarget() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, settings.width, settings.height);
+}
+
+void FrameExporter::EndFrame()
+{
+    if (!active) return;
+
+    const size_t slot = static_cast<size_t>(submitted % settings.pboRingSize);
+
+    // The slot is reused: its previous frame must have been collected already.
+    if (submitted - collected >= settings.pboRingSize) {
+        CollectFrame(collected);
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[slot]);
+    glReadPixels(0, 0, settings.width, settings.height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+    fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    ++submitted;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.framesSubmitted = submitted;
+    }
+
+    // Keep the ring one slot ahead: collect the oldest frame as soon as the ring is full.
+    if (submitted - collected >= settings.pboRingSize) {
+        CollectFrame(collected);
+    }
+}
+
+void FrameExporter::CollectFrame(int frameIndex)
+{
+    const size_t slot = static_cast<size_t>(frameIndex % settings.pboRingSize);
+
+    if (GLsync fence = static_cast<GLsync>(fences[slot])) {
+        GLenum r = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (r == GL_TIMEOUT_EXPIRED) {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++stats.readbackStalls;
+        }
+        while (r == GL_TIMEOUT_EXPIRED) {
+            r = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1 ms
+        }
+        glDeleteSync(fence);
+        fences[slot] = nullptr;
+    }
+
+    Job job;
+    job.frameIndex = frameIndex;
+    job.rgba = AcquireBuffer();
+
+    const size_t rowBytes = static_cast<size_t>(settings.width) * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[slot]);
+    const auto* src = static_cast<const std::uint8_t*>(glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY));
+    if (src) {
+        // GL rows are bottom-up; encoders want top-down.
+        for (int y = 0; y < settings.height; ++y) {
+            std::memcpy(job.rgba.data() + static_cast<size_t>(y) * rowBytes,
+                        src + static_cast<size_t>(settings.height - 1 - y) * rowBytes,
+                        rowBytes);
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    else {
+        std::fill(job.rgba.begin(), job.rgba.end(), std::uint8_t(0));
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    ++collected;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (static_cast<int>(queue.size()) >= settings.maxPendingFrames) {
+        ++stats.encoderWaits;
+        spaceCv.wait(lock, [this] { return static_cast<int>(queue.size()) < settings.maxPendingFrames; });
+    }
+    queue.push_back(std::move(job));
+    queueCv.notify_one();
+}
+
+std::vector<std::uint8_t> FrameExporter::AcquireBuffer()
+{
+    const size_t frameBytes = static_cast<size_t>(settings.width) * static_cast<size_t>(settings.height) * 4;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!freeBuffers.empty()) {
+            std::vector<std::uint8_t> b = std::move(freeBuffers.back());
+            freeBuffers.pop_back();
+            b.resize(frameBytes);
+            return b;
+        }
+    }
+    return std::vector<std::uint8_t>(frameBytes);
+}
+
+void FrameExporter::ReleaseBuffer(std::vector<std::uint8_t>&& buffer)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    freeBuffers.push_back(std::move(buffer));
+}
+
+void FrameExporter::EncoderLoop()
+{
+    std::vector<std::uint8_t> yuv; // per-thread scratch for Y4M
+
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            queueCv.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) return; // stopping and drained
+            job = std::move(queue.front());
+            queue.pop_front();
+            spaceCv.notify_one();
+        }
+
+        bool ok = true;
+        if (settings.format == Format::PNG) {
+            ok = EncodePng(job);
+        }
+        else {
+            // Conversion runs in parallel; writes are serialized in frame order.
+            EncodeY4m(job, yuv);
+            std::unique_lock<std::mutex> lock(mutex);
+            orderCv.wait(lock, [this, &job] { return nextFrameToWrite == job.frameIndex; });
+            ok = std::fwrite("FRAME\n", 1, 6, stream) == 6
+                && std::fwrite(yuv.data(), 1, yuv.size(), stream) == yuv.size();
+            ++nextFrameToWrite;
+            orderCv.notify_all();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++stats.framesWritten;
+            if (!ok) stats.writeFailed = true;
+        }
+        ReleaseBuffer(std::move(job.rgba));
+    }
+}
+
+bool FrameExporter::EncodePng(Job& job) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "frame_%05d.png", job.frameIndex);
+    const std::string path = (std::filesystem::path(settings.outputPath) / name).string();
+
+    // Blending leaves partial alpha in the target; export frames are opaque.
+    for (size_t i = 3; i < job.rgba.size(); i += 4) job.rgba[i] = 255;
+
+    return stbi_write_png(path.c_str(), settings.width, settings.height, 4, job.rgba.data(), settings.width * 4) != 0;
+}
+
+void FrameExporter::EncodeY4m(const Job& job, std::vector<std::uint8_t>& yuv) const
+{
+    const int w = settings.width;
+    const int h = settings.height;
+    const size_t lumaSize = static_cast<size_t>(w) * static_cast<size_t>(h);
+    const size_t chromaSize = lumaSize / 4;
+    yuv.resize(lumaSize + 2 * chromaSize);
+
+    std::uint8_t* yPlane = yuv.data();
+    std::uint8_t* uPlane = yPlane + lumaSize;
+    std::uint8_t* vPlane = uPlane + chromaSize;
+    const std::uint8_t* rgba = job.rgba.data();
+
+    auto clamp8 = [](int v) -> std::uint8_t { return static_cast<std::uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v)); };
+
+    // Full-range BT.601 in 16.16 fixed point; chroma is averaged over each 2x2 block.
+    for (int y = 0; y < h; y += 2) {
+        for (int x = 0; x < w; x += 2) {
+            int rSum = 0, gSum = 0, bSum = 0;
+            for (int dy = 0; dy < 2; ++dy) {
+                for (int dx = 0; dx < 2; ++dx) {
+                    const size_t i = static_cast<size_t>(y + dy) * static_cast<size_t>(w) + static_cast<size_t>(x + dx);
+                    const int r = rgba[i * 4 + 0];
+                    const int g = rgba[i * 4 + 1];
+                    const int b = rgba[i * 4 + 2];
+                    yPlane[i] = clamp8((19595 * r + 38470 * g + 7471 * b + 32768) >> 16);
+                    rSum += r; gSum += g; bSum += b;
+                }
+            }
+            const int r = rSum >> 2, g = gSum >> 2, b = bSum >> 2;
+            const size_t c = static_cast<size_t>(y / 2) * static_cast<size_t>(w / 2) + static_cast<size_t>(x / 2);
+            uPlane[c] = clamp8(((-11059 * r - 21709 * g + 32768 * b + 32768) >> 16) + 128);
+            vPlane[c] = clamp8(((32768 * r - 27439 * g - 5329 * b + 32768) >> 16) + 128);
+        }
+    }
+}
+
+void FrameExporter::Finish()
+{
+    if (!active) return;
+
+    // Drain the ring (GL thread), then let encoders finish the queue.
+    while (collected < submitted) {
+        CollectFrame(collected);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    queueCv.notify_all();
+    for (auto& t : workers) {
+        if (t.joinable()) t.join();
+    }
+    workers.clear();
+
+    if (stream) {
+        std::fclose(stream);
+        stream = nullptr;
+    }
+
+    DestroyTargets();
+    freeBuffers.clear();
+    active = false;
+}
+
+FrameExporter::Stats FrameExporter::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Offline render target + pipelined readback for image sequence export.
+//
+// Frames are rendered into an offscreen FBO of arbitrary size. Readback goes through
+// a ring of pixel-pack buffers: glReadPixels into PBO[n] is asynchronous, and the
+// PBO written `ringSize - 1` frames earlier is mapped instead, so the CPU only waits
+// on the GPU when the ring is too shallow. Pixels are handed to background encoder
+// threads (PNG files or a single raw Y4M stream) while the next frame simulates.
+class FrameExporter {
+public:
+    enum class Format {
+        PNG, // <output>/frame_00000.png ...
+        Y4M, // single 4:2:0 YUV4MPEG2 stream at <output>
+    };
+
+    struct Settings {
+        std::string outputPath;
+        int width = 1920;
+        int height = 1080;
+        int fps = 60;
+        Format format = Format::PNG;
+        int pboRingSize = 3;
+        int encoderThreads = 2;
+        int maxPendingFrames = 8; // back-pressure: bounds memory if encoding is slower than rendering
+    };
+
+    struct Stats {
+        int framesSubmitted = 0;
+        int framesWritten = 0;
+        int readbackStalls = 0; // mapped a PBO whose transfer was not finished yet
+        int encoderWaits = 0;   // main thread blocked on a full encode queue
+        bool writeFailed = false;
+    };
+
+    FrameExporter();
+    ~FrameExporter();
+
+    FrameExporter(const FrameExporter&) = delete;
+    FrameExporter& operator=(const FrameExporter&) = delete;
+
+    // Creates the FBO / PBO ring and starts encoder threads. Requires a current GL context.
+    bool Begin(const Settings& settings);
+
+    // Binds the offscreen target and sets the viewport to the export size.
+    void BindTarget() const;
+
+    // Queues the readback of the frame currently in the target.
+    void EndFrame();
+
+    // Drains the PBO ring, waits for encoders and releases GL resources.
+    void Finish();
+
+    bool IsActive() const { return active; }
+    const Settings& GetSettings() const { return settings; }
+    Stats GetStats() const;
+
+private:
+    struct Job {
+        int frameIndex = 0;
+        std::vector<std::uint8_t> rgba; // top-down rows
+    };
+
+    void CreateTargets();
+    void DestroyTargets();
+
+    // Maps the PBO holding `frameIndex` and pushes its pixels to the encoders.
+    void CollectFrame(int frameIndex);
+
+    void EncoderLoop();
+    bool EncodePng(Job& job) const;
+    void EncodeY4m(const Job& job, std::vector<std::uint8_t>& yuv) const;
+
+    std::vector<std::uint8_t> AcquireBuffer();
+    void ReleaseBuffer(std::vector<std::uint8_t>&& buffer);
+
+    Settings settings;
+    bool active;
+
+    unsigned int fbo;
+    unsigned int colorTexture;
+    unsigned int depthBuffer;
+    std::vector<unsigned int> pbos;
+    std::vector<void*> fences; // GLsync per ring slot
+    int submitted;             // frames read into the ring
+    int collected;             // frames handed to encoders
+
+    // Encoder side
+    std::vector<std::thread> workers;
+    mutable std::mutex mutex;
+    std::condition_variable queueCv;   // jobs available / stop
+    std::condition_variable spaceCv;   // queue has room
+    std::condition_variable orderCv;   // Y4M: next frame in order may be written
+    std::deque<Job> queue;
+    std::vector<std::vector<std::uint8_t>> freeBuffers;
+    bool stopping;
+    int nextFrameToWrite;
+    std::FILE* stream;
+    Stats stats;
+};
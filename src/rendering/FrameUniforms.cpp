@@ -0,0 +1,53 @@
+#include "FrameUniforms.h"
+
+#include <glad/glad.h>
+
+#include <cstring>
+
+#include "Camera.h"
+
+static_assert(sizeof(glm::mat4) == 64 && sizeof(glm::vec4) == 16, "FrameUniforms assumes tightly packed glm types (std140)");
+
+FrameUniforms::FrameUniforms()
+    : ubo(0)
+    , current()
+    , valid(false)
+{
+}
+
+FrameUniforms::~FrameUniforms()
+{
+    if (ubo) glDeleteBuffers(1, &ubo);
+}
+
+bool FrameUniforms::initialize()
+{
+    glGenBuffers(1, &ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(Block), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    glBindBufferBase(GL_UNIFORM_BUFFER, kBindingPoint, ubo);
+    valid = false;
+    return ubo != 0;
+}
+
+bool FrameUniforms::Update(const Camera& camera, float aspectRatio)
+{
+    if (!ubo) return false;
+
+    Block next;
+    next.view = camera.getViewMatrix();
+    next.projection = camera.getProjectionMatrix(aspectRatio);
+    next.cameraPos = glm::vec4(camera.getPosition(), 1.0f);
+
+    if (valid && std::memcmp(&next, &current, sizeof(Block)) == 0) return false;
+
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Block), &next);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    current = next;
+    valid = true;
+    return true;
+}
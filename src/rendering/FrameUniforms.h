@@ -0,0 +1,49 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+class Camera;
+
+// Per-frame camera data shared by every program through a std140 uniform block:
+//
+//   layout(std140) uniform FrameUniforms {
+//       mat4 view;
+//       mat4 projection;
+//       vec4 cameraPos; // xyz
+//   };
+//
+// Shader binds any block named "FrameUniforms" to kBindingPoint at link time, so the
+// particle, trail and overdraw programs all read the same buffer. Update() only
+// re-uploads when the camera or aspect actually changed.
+class FrameUniforms {
+public:
+    static constexpr unsigned int kBindingPoint = 0;
+    static constexpr const char* kBlockName = "FrameUniforms";
+
+    FrameUniforms();
+    ~FrameUniforms();
+
+    FrameUniforms(const FrameUniforms&) = delete;
+    FrameUniforms& operator=(const FrameUniforms&) = delete;
+
+    // Creates the UBO and binds it to kBindingPoint. Requires a current GL context.
+    bool initialize();
+
+    // Uploads view / projection / camera position if they differ from the last upload.
+    // Returns true when the buffer was rewritten.
+    bool Update(const Camera& camera, float aspectRatio);
+
+    // Forces the next Update() to upload (e.g. after another context touched the buffer).
+    void Invalidate() { valid = false; }
+
+private:
+    struct Block {
+        glm::mat4 view;
+        glm::mat4 projection;
+        glm::vec4 cameraPos;
+    };
+
+    unsigned int ubo;
+    Block current;
+    bool valid;
+};
@@ -0,0 +1,224 @@
+#include "OverdrawView.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+#include <imgui.h>
+
+#include "Shader.h"
+#include "ParticleRenderer.h"
+#include "TrailRenderer.h"
+
+#include "../fireworks/particle/ParticlePool.h"
+
+OverdrawView::OverdrawView()
+    : particleCountShader(nullptr)
+    , trailCountShader(nullptr)
+    , heatmapShader(nullptr)
+    , fbo(0)
+    , countTexture(0)
+    , emptyVao(0)
+    , targetWidth(0)
+    , targetHeight(0)
+    , maxLayersRamp(16.0f)
+    , opacity(0.85f)
+    , statsInterval(8)
+    , frameCounter(0)
+{
+}
+
+OverdrawView::~OverdrawView()
+{
+    if (countTexture) glDeleteTextures(1, &countTexture);
+    if (fbo) glDeleteFramebuffers(1, &fbo);
+    if (emptyVao) glDeleteVertexArrays(1, &emptyVao);
+
+    delete particleCountShader;
+    delete trailCountShader;
+    delete heatmapShader;
+}
+
+bool OverdrawView::initialize()
+{
+    particleCountShader = new Shader("../shaders/particle.vert", "../shaders/overdraw.frag");
+    trailCountShader = new Shader("../shaders/trail.vert", "../shaders/overdraw.frag");
+    heatmapShader = new Shader("../shaders/heatmap.vert", "../shaders/heatmap.frag");
+
+    if (!particleCountShader->getID() || !trailCountShader->getID() || !heatmapShader->getID()) {
+        std::cerr << "OverdrawView::initialize - failed to build overdraw programs\n";
+        return false;
+    }
+
+    // Same discard rule as particle.frag; trail.frag never discards.
+    particleCountShader->use();
+    particleCountShader->setFloat("uAlphaDiscard", 0.01f);
+    trailCountShader->use();
+    trailCountShader->setFloat("uAlphaDiscard", -1.0f);
+    trailCountShader->setInt("uHasTexture", 0);
+    glUseProgram(0);
+
+    // Core profile requires a bound VAO even for attribute-less draws.
+    glGenVertexArrays(1, &emptyVao);
+    return true;
+}
+
+bool OverdrawView::EnsureTarget(int width, int height)
+{
+    if (width <= 0 || height <= 0) return false;
+    if (fbo && width == targetWidth && height == targetHeight) return true;
+
+    if (!fbo) glGenFramebuffers(1, &fbo);
+    if (!countTexture) glGenTextures(1, &countTexture);
+
+    glBindTexture(GL_TEXTURE_2D, countTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, width, height, 0, GL_RED, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, countTexture, 0);
+    const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "OverdrawView: R32F framebuffer incomplete (0x" << std::hex << status << std::dec << ")\n";
+        return false;
+    }
+
+    targetWidth = width;
+    targetHeight = height;
+    readback.resize(static_cast<size_t>(width) * static_cast<size_t>(height));
+    frameCounter = 0;
+    return true;
+}
+
+void OverdrawView::RenderCounts(ParticleRenderer& particles, TrailRenderer& trails, const ParticlePool& pool,
+                                const Camera& camera, const glm::mat4& model, int width, int height)
+{
+    if (!particleCountShader || !EnsureTarget(width, height)) return;
+
+    GLint prevViewport[4];
+    glGetIntegerv(GL_VIEWPORT, prevViewport);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, width, height);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    // Replay the regular draws with the counting programs and additive blending.
+    Shader* particleShader = particles.GetShader();
+    Shader* trailShader = trails.GetShader();
+    particles.SetShader(particleCountShader);
+    trails.SetShader(trailCountShader);
+    particles.SetAdditiveBlending(true);
+    trails.SetAdditiveBlending(true);
+
+    trails.Render(pool, camera, model);
+    particles.Render(pool, camera, model);
+
+    particles.SetAdditiveBlending(false);
+    trails.SetAdditiveBlending(false);
+    particles.SetShader(particleShader);
+    trails.SetShader(trailShader);
+
+    if (++frameCounter >= statsInterval) {
+        frameCounter = 0;
+        ReadbackStats();
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(prevViewport[0], prevViewport[1], prevViewport[2], prevViewport[3]);
+}
+
+void OverdrawView::ReadbackStats()
+{
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glReadPixels(0, 0, targetWidth, targetHeight, GL_RED, GL_FLOAT, readback.data());
+
+    Stats s;
+    const size_t pixelCount = readback.size();
+    size_t covered = 0;
+    double sum = 0.0;
+    float maxLayers = 0.0f;
+    std::array<size_t, kHistogramBins> bins{};
+
+    for (float v : readback) {
+        sum += v;
+        if (v > maxLayers) maxLayers = v;
+        if (v >= 0.5f) ++covered;
+        const int layers = static_cast<int>(v + 0.5f);
+        bins[static_cast<size_t>(std::min(layers, kHistogramBins - 1))]++;
+    }
+
+    if (pixelCount > 0) {
+        s.avgLayers = static_cast<float>(sum / static_cast<double>(pixelCount));
+        s.coveredRatio = static_cast<float>(covered) / static_cast<float>(pixelCount);
+        for (int i = 0; i < kHistogramBins; ++i) {
+            s.histogram[static_cast<size_t>(i)] = static_cast<float>(bins[static_cast<size_t>(i)]) / static_cast<float>(pixelCount);
+        }
+    }
+    s.avgLayersCovered = covered > 0 ? static_cast<float>(sum / static_cast<double>(covered)) : 0.0f;
+    s.maxLayers = maxLayers;
+    s.fragments = sum;
+    stats = s;
+}
+
+void OverdrawView::DrawHeatmap(int width, int height)
+{
+    if (!heatmapShader || !countTexture || width != targetWidth || height != targetHeight) return;
+
+    heatmapShader->use();
+    heatmapShader->setInt("uCounts", 0);
+    heatmapShader->setFloat("uMaxLayers", maxLayersRamp);
+    heatmapShader->setFloat("uOpacity", opacity);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, countTexture);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDisable(GL_DEPTH_TEST);
+
+    glBindVertexArray(emptyVao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void OverdrawView::DrawStatsWindow(bool* open)
+{
+    if (open && !*open) return;
+
+    if (!ImGui::Begin("Overdraw", open)) {
+        ImGui::End();
+        return;
+    }
+
+    ImGui::Text("Target: %dx%d", targetWidth, targetHeight);
+    ImGui::Text("Fragments / frame: %.0f", stats.fragments);
+    ImGui::Text("Avg layers (frame): %.3f", stats.avgLayers);
+    ImGui::Text("Avg layers (covered): %.2f", stats.avgLayersCovered);
+    ImGui::Text("Max layers: %.0f", stats.maxLayers);
+    ImGui::Text("Coverage: %.1f %%", stats.coveredRatio * 100.0f);
+
+    ImGui::Separator();
+    ImGui::SliderFloat("Ramp max (layers)", &maxLayersRamp, 1.0f, 128.0f, "%.0f");
+    ImGui::SliderFloat("Opacity", &opacity, 0.0f, 1.0f, "%.2f");
+    ImGui::SliderInt("Stats every N frames", &statsInterval, 1, 60);
+
+    // Skip bin 0 (uncovered pixels dominate and flatten the plot).
+    ImGui::Separator();
+    ImGui::TextDisabled("Pixels per layer count (1..%d+)", kHistogramBins - 1);
+    ImGui::PlotHistogram("##overdraw_hist", stats.histogram.data() + 1, kHistogramBins - 1, 0, nullptr,
+                         0.0f, FLT_MAX, ImVec2(-FLT_MIN, 90.0f));
+
+    ImGui::End();
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class Shader;
+class Camera;
+class ParticlePool;
+class ParticleRenderer;
+class TrailRenderer;
+
+// Debug render mode: counts how many fragments land on each pixel.
+//
+// The regular particle / trail draws are replayed into an offscreen R32F target with
+// a counting fragment shader and additive blending (GL 3.3 core only, no atomics).
+// The result is composited as a heatmap over the frame, and periodically read back
+// to compute overdraw statistics (average / max layers, fragments per frame, histogram).
+class OverdrawView {
+public:
+    static constexpr int kHistogramBins = 16; // 0..14 layers, last bin = 15+
+
+    struct Stats {
+        float avgLayers = 0.0f;         // over all pixels of the frame
+        float avgLayersCovered = 0.0f;  // over pixels touched at least once
+        float maxLayers = 0.0f;
+        double fragments = 0.0;         // total fragments written by particles + trails
+        float coveredRatio = 0.0f;      // fraction of pixels with at least one layer
+        std::array<float, kHistogramBins> histogram{}; // fraction of pixels per bin
+    };
+
+    OverdrawView();
+    ~OverdrawView();
+
+    OverdrawView(const OverdrawView&) = delete;
+    OverdrawView& operator=(const OverdrawView&) = delete;
+
+    // Loads the counting / heatmap programs. Requires a current GL context.
+    bool initialize();
+
+    // Replays the particle + trail draws into the count target (width x height).
+    void RenderCounts(ParticleRenderer& particles, TrailRenderer& trails, const ParticlePool& pool,
+                      const Camera& camera, const glm::mat4& model, int width, int height);
+
+    // Blends the heatmap over the currently bound framebuffer.
+    void DrawHeatmap(int width, int height);
+
+    // Stats window with the histogram (call between ImGui NewFrame and Render).
+    void DrawStatsWindow(bool* open);
+
+    const Stats& GetStats() const { return stats; }
+
+    // Stats readback stalls the pipeline; only do it every N frames.
+    void SetStatsInterval(int frames) { statsInterval = frames < 1 ? 1 : frames; }
+
+private:
+    bool EnsureTarget(int width, int height);
+    void ReadbackStats();
+
+    Shader* particleCountShader;
+    Shader* trailCountShader;
+    Shader* heatmapShader;
+
+    unsigned int fbo;
+    unsigned int countTexture;
+    unsigned int emptyVao;
+    int targetWidth;
+    int targetHeight;
+
+    float maxLayersRamp;
+    float opacity;
+    int statsInterval;
+    int frameCounter;
+
+    std::vector<float> readback;
+    Stats stats;
+};
@@ -1,12 +1,12 @@
 ﻿#include "ParticleRenderer.h"
 
 ParticleRenderer::ParticleRenderer()
-    : VAO(0), VBO(0), shader(nullptr), shapeRegistry(nullptr), aspectRatio(16.0f / 9.0f)
+    : VAO(0), VBO(0), shader(nullptr), shapeRegistry(nullptr), frameUniforms(nullptr), packedVersion(0), packedValid(false), uploadedVersion(0), uploadedValid(false), aspectRatio(16.0f / 9.0f), additiveBlending(false)
 {
 }
 
 ParticleRenderer::ParticleRenderer(Shader* _shader)
-    : VAO(0), VBO(0), shader(_shader), shapeRegistry(nullptr), aspectRatio(16.0f / 9.0f)
+    : VAO(0), VBO(0), shader(_shader), shapeRegistry(nullptr), frameUniforms(nullptr), packedVersion(0), packedValid(false), uploadedVersion(0), uploadedValid(false), aspectRatio(16.0f / 9.0f), additiveBlending(false)
 {
 }
 
@@ -52,22 +52,103 @@ void ParticleRenderer::SetShapeRegistry(ShapeRegistry* registry)
 void ParticleRenderer::Render(const std::vector<Particle>& particles, const Camera& camera, const glm::mat4& model)
 {
     if (!shader) return;
+    Upload(particles);
+    uploadedValid = false; // no version to key on: the next pool render re-uploads
+    Draw(camera, model);
+}
+
+void ParticleRenderer::Render(const ParticlePool& pool, const Camera& camera, const glm::mat4& model)
+{
+    if (!shader) return;
+
+    // Même contenu que la dernière frame (preview figée, seule l'UI a changé) : on redessine
+    // depuis le VBO existant sans regrouper ni ré-uploader.
+    if (!uploadedValid || uploadedVersion != pool.GetVersion()) {
+        Prepare(pool); // déjà fait si un thread de tâches est passé avant
+        UploadPacked();
+        uploadedVersion = pool.GetVersion();
+        uploadedValid = true;
+    }
+    Draw(camera, model);
+}
+
+void ParticleRenderer::Prepare(const ParticlePool& pool)
+{
+    if (uploadedValid && uploadedVersion == pool.GetVersion()) return;
+    if (packedValid && packedVersion == pool.GetVersion()) return;
+    Pack(pool.GetAll());
+    packedVersion = pool.GetVersion();
+    packedValid = true;
+}
+
+void ParticleRenderer::Upload(const std::vector<Particle>& particles)
+{
+    Pack(particles);
+    UploadPacked();
+}
+
+void ParticleRenderer::Pack(const std::vector<Particle>& particles)
+{
+    // Grouper les particules par shapeId pour minimiser les changements de texture :
+    // un seul buffer trié par groupe, un draw call par texture avec son offset.
+    packedValid = false;
+    packedGroups.clear();
+    std::unordered_map<uint16_t, size_t> groupOf;
+    for (const auto& p : particles) {
+        if (!p.active) continue;
+        auto it = groupOf.find(p.shapeId);
+        if (it == groupOf.end()) {
+            it = groupOf.emplace(p.shapeId, packedGroups.size()).first;
+            packedGroups.push_back({ p.shapeId, 0, 0 });
+        }
+        ++packedGroups[it->second].count;
+    }
+
+    GLint first = 0;
+    for (auto& g : packedGroups) {
+        g.first = first;
+        first += g.count;
+    }
+
+    cpuData.resize(static_cast<size_t>(first) * 8);
+    std::vector<GLint> cursor(packedGroups.size());
+    for (size_t i = 0; i < packedGroups.size(); ++i) cursor[i] = packedGroups[i].first;
 
-    // Grouper les particules par shapeId pour minimiser les changements de texture
-    std::unordered_map<uint16_t, std::vector<const Particle*>> groups;
     for (const auto& p : particles) {
         if (!p.active) continue;
-        groups[p.shapeId].push_back(&p);
+        float* v = &cpuData[static_cast<size_t>(cursor[groupOf[p.shapeId]]++) * 8];
+        v[0] = p.position.x;
+        v[1] = p.position.y;
+        v[2] = p.position.z;
+        v[3] = p.color.r;
+        v[4] = p.color.g;
+        v[5] = p.color.b;
+        v[6] = p.color.a;
+        v[7] = p.size;
     }
+}
+
+void ParticleRenderer::UploadPacked()
+{
+    groups = packedGroups;
+    packedValid = false;
+    if (cpuData.empty()) return;
+
+    // Upload vers GPU (une fois par frame, orphaning du buffer précédent)
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, cpuData.size() * sizeof(float), cpuData.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void ParticleRenderer::Draw(const Camera& camera, const glm::mat4& model)
+{
     if (groups.empty()) return;
 
     shader->use();
 
-    // Utiliser les vraies matrices de la caméra
-    shader->setMat4("view", camera.getViewMatrix());
-    shader->setMat4("projection", camera.getProjectionMatrix(aspectRatio));
+    // Matrices caméra : bloc FrameUniforms partagé (ré-uploadé seulement si la caméra a bougé)
+    if (frameUniforms) frameUniforms->Update(camera, aspectRatio);
     shader->setMat4("model", model);
-    shader->setVec3("uCameraPos", camera.getPosition());
 
     // Définir l'unité de texture utilisée (texture unit 0)
     shader->setInt("uTexture", 0);
@@ -76,41 +157,21 @@ void ParticleRenderer::Render(const std::vector<Particle>& particles, const Came
     glEnable(GL_PROGRAM_POINT_SIZE);
     glEnable(GL_POINT_SPRITE);
     glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    if (additiveBlending) glBlendFunc(GL_ONE, GL_ONE);
+    else glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     // Désactiver le depth test pour que les particules se superposent naturellement
     glDisable(GL_DEPTH_TEST);
 
     glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
 
     // Rendre chaque groupe de particules (un draw call par texture)
-    for (auto& kv : groups) {
-        uint16_t shapeId = kv.first;
-        const auto& vec = kv.second;
-        if (vec.empty()) continue;
-
-        // Construire le buffer de vertices pour ce groupe
-        std::vector<float> data;
-        data.reserve(vec.size() * 8);
-        for (const Particle* p : vec) {
-            data.push_back(p->position.x);
-            data.push_back(p->position.y);
-            data.push_back(p->position.z);
-            data.push_back(p->color.r);
-            data.push_back(p->color.g);
-            data.push_back(p->color.b);
-            data.push_back(p->color.a);
-            data.push_back(p->size);
-        }
-
-        // Upload vers GPU
-        glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), data.data(), GL_DYNAMIC_DRAW);
-
-        // Obtenir la texture pour cette forme
+    for (const auto& g : groups) {
+        // Obtenir la texture pour cette forme (résolue à chaque frame : le placeholder
+        // est remplacé quand le décodage asynchrone se termine)
         GLuint texId = 0;
         if (shapeRegistry) {
-            texId = shapeRegistry->GetTextureId(shapeId);
+            texId = shapeRegistry->GetTextureId(g.shapeId);
         }
 
         // Configurer texture et uniforms
@@ -133,7 +194,7 @@ void ParticleRenderer::Render(const std::vector<Particle>& particles, const Came
         }
 
         // Draw call
-        glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(data.size() / 8));
+        glDrawArrays(GL_POINTS, g.first, g.count);
 
         // Débinder texture après utilisation
         if (texId != 0) {
@@ -142,7 +203,6 @@ void ParticleRenderer::Render(const std::vector<Particle>& particles, const Came
     }
 
     // Cleanup
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 
     // Restaurer l'état OpenGL
@@ -9,7 +9,9 @@
 
 #include "Shader.h"
 #include "Camera.h"
+#include "FrameUniforms.h"
 #include "../fireworks/particle/Particle.h"
+#include "../fireworks/particle/ParticlePool.h"
 #include "../fireworks/shapes/ShapeRegistry.h"
 
 class ParticleRenderer {
@@ -18,10 +20,32 @@ private:
     unsigned int VBO;
     Shader* shader;
     ShapeRegistry* shapeRegistry;
+    FrameUniforms* frameUniforms;
+
+    // Un draw call par shapeId : plage [first, first + count) du VBO
+    struct DrawGroup {
+        uint16_t shapeId;
+        GLint first;
+        GLsizei count;
+    };
+    std::vector<DrawGroup> groups;       // contenu du VBO
+    std::vector<DrawGroup> packedGroups; // contenu de cpuData (pas encore uploadé)
+    std::vector<float> cpuData;
+
+    // Version du pool regroupée dans cpuData par Prepare()
+    uint64_t packedVersion;
+    bool packedValid;
+
+    // Version du pool actuellement dans le VBO (réutilisé tant qu'elle ne change pas)
+    uint64_t uploadedVersion;
+    bool uploadedValid;
 
     // Aspect ratio pour la projection (mis à jour depuis l'extérieur)
     float aspectRatio;
 
+    // Blend ONE/ONE instead of alpha blending (overdraw counting pass)
+    bool additiveBlending;
+
 public:
     ParticleRenderer();
     ParticleRenderer(Shader* _shader);
@@ -29,10 +53,31 @@ public:
 
     bool initialize();
     void SetShapeRegistry(ShapeRegistry* registry);
+    // UBO partagé view / projection / position caméra (possédé par Application)
+    void SetFrameUniforms(FrameUniforms* uniforms) { frameUniforms = uniforms; }
 
     // Définir l'aspect ratio (appelé depuis Application quand la fenêtre change)
     void SetAspectRatio(float aspect) { aspectRatio = aspect; }
 
-    // Méthode principale de rendu
+    // Debug views (overdraw) temporarily swap the program and blend mode.
+    void SetShader(Shader* s) { shader = s; }
+    Shader* GetShader() const { return shader; }
+    void SetAdditiveBlending(bool additive) { additiveBlending = additive; }
+
+    // Méthode principale de rendu (regroupe et ré-uploade à chaque appel)
     void Render(const std::vector<Particle>& particles, const Camera& camera, const glm::mat4& model = glm::mat4(1.0f));
+
+    // Idem, mais réutilise le VBO tant que pool.GetVersion() n'a pas changé
+    void Render(const ParticlePool& pool, const Camera& camera, const glm::mat4& model = glm::mat4(1.0f));
+
+    // Partie CPU de Render(pool) (regroupement par shapeId), sans appel GL : peut tourner
+    // sur un autre thread avant Render(), qui n'a plus qu'à uploader. No-op si la version
+    // du pool est déjà prête ou déjà dans le VBO.
+    void Prepare(const ParticlePool& pool);
+
+private:
+    void Upload(const std::vector<Particle>& particles);
+    void Pack(const std::vector<Particle>& particles);
+    void UploadPacked();
+    void Draw(const Camera& camera, const glm::mat4& model);
 };
\ No newline at end of file
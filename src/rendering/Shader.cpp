@@ -3,10 +3,86 @@
 #include <glad/glad.h>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <GLFW/glfw3.h>
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 
+#include "FrameUniforms.h"
+
+// ARB_get_program_binary (core in 4.1) is not part of the GL 3.3 glad loader:
+// resolve the entry points manually and treat them as optional.
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+namespace {
+
+typedef void (APIENTRY* ProgramBinaryFn)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRY* GetProgramBinaryFn)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRY* ProgramParameteriFn)(GLuint program, GLenum pname, GLint value);
+
+struct ProgramBinaryApi {
+	ProgramBinaryFn programBinary = nullptr;
+	GetProgramBinaryFn getProgramBinary = nullptr;
+	ProgramParameteriFn programParameteri = nullptr;
+	bool available = false;
+};
+
+const ProgramBinaryApi& GetProgramBinaryApi()
+{
+	static ProgramBinaryApi api = []() {
+		ProgramBinaryApi a;
+		a.programBinary = reinterpret_cast<ProgramBinaryFn>(glfwGetProcAddress("glProgramBinary"));
+		a.getProgramBinary = reinterpret_cast<GetProgramBinaryFn>(glfwGetProcAddress("glGetProgramBinary"));
+		a.programParameteri = reinterpret_cast<ProgramParameteriFn>(glfwGetProcAddress("glProgramParameteri"));
+		GLint formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		while (glGetError() != GL_NO_ERROR) {} // enum unknown on drivers without the extension
+		a.available = a.programBinary && a.getProgramBinary && a.programParameteri && formats > 0;
+		return a;
+	}();
+	return api;
+}
+
+std::string g_binaryCacheDir = "../cache/shaders";
+
+constexpr char kBinaryMagic[8] = { 'F', 'W', 'P', 'R', 'O', 'G', '0', '1' };
+
+unsigned long long HashString(const char* s, unsigned long long h)
+{
+	if (!s) return h;
+	for (; *s; ++s) {
+		h ^= static_cast<unsigned char>(*s);
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+std::string BinaryCachePath(unsigned long long key)
+{
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx.bin", key);
+	return (std::filesystem::path(g_binaryCacheDir) / name).string();
+}
+
+} // namespace
+
+void Shader::setBinaryCacheDirectory(const std::string& directory)
+{
+	g_binaryCacheDir = directory;
+}
+
 Shader::Shader()
 	: id(0)
 {
@@ -24,6 +100,22 @@ Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath)
 		return;
 	}
 
+	// Source + driver identity: a driver update invalidates every cached binary.
+	unsigned long long key = 1469598103934665603ULL;
+	key = HashString(vertSrc.c_str(), key);
+	key = HashString("\x1f", key);
+	key = HashString(fragSrc.c_str(), key);
+	key = HashString(reinterpret_cast<const char*>(glGetString(GL_VENDOR)), key);
+	key = HashString(reinterpret_cast<const char*>(glGetString(GL_RENDERER)), key);
+	key = HashString(reinterpret_cast<const char*>(glGetString(GL_VERSION)), key);
+
+	if (loadProgramBinary(key))
+	{
+		cacheUniformLocations();
+		bindUniformBlocks();
+		return;
+	}
+
 	unsigned int vertex = compileShader(GL_VERTEX_SHADER, vertSrc);
 	unsigned int fragment = compileShader(GL_FRAGMENT_SHADER, fragSrc);
 
@@ -38,6 +130,8 @@ Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath)
 	id = glCreateProgram();
 	glAttachShader(id, vertex);
 	glAttachShader(id, fragment);
+	if (GetProgramBinaryApi().available)
+		GetProgramBinaryApi().programParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 	glLinkProgram(id);
 
 	// check linking errors
@@ -59,8 +153,20 @@ Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath)
 	}
 
 	// shaders can be deleted after linking
+	if (id != 0)
+	{
+		glDetachShader(id, vertex);
+		glDetachShader(id, fragment);
+	}
 	glDeleteShader(vertex);
 	glDeleteShader(fragment);
+
+	if (id != 0)
+	{
+		cacheUniformLocations();
+		bindUniformBlocks();
+		saveProgramBinary(key);
+	}
 }
 
 Shader::~Shader()
@@ -88,43 +194,155 @@ unsigned int Shader::getID() const
 void Shader::setBool(const std::string& name, bool value) const
 {
 	if (!id) return;
-	glUniform1i(glGetUniformLocation(id, name.c_str()), static_cast<int>(value));
+	glUniform1i(getUniformLocation(name), static_cast<int>(value));
 }
 
 void Shader::setInt(const std::string& name, int value) const
 {
 	if (!id) return;
-	glUniform1i(glGetUniformLocation(id, name.c_str()), value);
+	glUniform1i(getUniformLocation(name), value);
 }
 
 void Shader::setFloat(const std::string& name, float value) const
 {
 	if (!id) return;
-	glUniform1f(glGetUniformLocation(id, name.c_str()), value);
+	glUniform1f(getUniformLocation(name), value);
 }
 
 void Shader::setVec2(const std::string& name, const glm::vec2& value) const
 {
 	if (!id) return;
-	glUniform2fv(glGetUniformLocation(id, name.c_str()), 1, glm::value_ptr(value));
+	glUniform2fv(getUniformLocation(name), 1, glm::value_ptr(value));
 }
 
 void Shader::setVec3(const std::string& name, const glm::vec3& value) const
 {
 	if (!id) return;
-	glUniform3fv(glGetUniformLocation(id, name.c_str()), 1, glm::value_ptr(value));
+	glUniform3fv(getUniformLocation(name), 1, glm::value_ptr(value));
 }
 
 void Shader::setVec4(const std::string& name, const glm::vec4& value) const
 {
 	if (!id) return;
-	glUniform4fv(glGetUniformLocation(id, name.c_str()), 1, glm::value_ptr(value));
+	glUniform4fv(getUniformLocation(name), 1, glm::value_ptr(value));
 }
 
 void Shader::setMat4(const std::string& name, const glm::mat4& mat) const
 {
 	if (!id) return;
-	glUniformMatrix4fv(glGetUniformLocation(id, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+	glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(mat));
+}
+
+void Shader::cacheUniformLocations()
+{
+	uniformLocations.clear();
+
+	GLint count = 0;
+	GLint maxLength = 0;
+	glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+	if (count <= 0 || maxLength <= 0) return;
+
+	std::vector<GLchar> buffer(static_cast<size_t>(maxLength));
+	for (GLint i = 0; i < count; ++i)
+	{
+		GLsizei length = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(id, static_cast<GLuint>(i), maxLength, &length, &size, &type, buffer.data());
+
+		std::string name(buffer.data(), static_cast<size_t>(length));
+		// Arrays are reported as "name[0]"; callers use the bare name.
+		const size_t bracket = name.find('[');
+		if (bracket != std::string::npos) name.resize(bracket);
+
+		// Block members report -1 and are set through their uniform buffer instead.
+		const GLint location = glGetUniformLocation(id, name.c_str());
+		if (location >= 0) uniformLocations.emplace_back(std::move(name), location);
+	}
+}
+
+void Shader::bindUniformBlocks() const
+{
+	const GLuint block = glGetUniformBlockIndex(id, FrameUniforms::kBlockName);
+	if (block != GL_INVALID_INDEX)
+		glUniformBlockBinding(id, block, FrameUniforms::kBindingPoint);
+}
+
+int Shader::getUniformLocation(const std::string& name) const
+{
+	for (const auto& entry : uniformLocations)
+	{
+		if (entry.first == name) return entry.second;
+	}
+	// Unknown or optimized out: -1 makes glUniform* a silent no-op, as before.
+	return -1;
+}
+
+bool Shader::loadProgramBinary(unsigned long long key)
+{
+	const ProgramBinaryApi& api = GetProgramBinaryApi();
+	if (!api.available || g_binaryCacheDir.empty()) return false;
+
+	std::ifstream in(BinaryCachePath(key), std::ios::binary);
+	if (!in.is_open()) return false;
+
+	char magic[sizeof(kBinaryMagic)];
+	unsigned long long storedKey = 0;
+	GLenum format = 0;
+	GLint length = 0;
+	in.read(magic, sizeof(magic));
+	in.read(reinterpret_cast<char*>(&storedKey), sizeof(storedKey));
+	in.read(reinterpret_cast<char*>(&format), sizeof(format));
+	in.read(reinterpret_cast<char*>(&length), sizeof(length));
+	if (!in || std::memcmp(magic, kBinaryMagic, sizeof(magic)) != 0 || storedKey != key || length <= 0) return false;
+
+	std::vector<char> binary(static_cast<size_t>(length));
+	in.read(binary.data(), length);
+	if (!in) return false;
+
+	id = glCreateProgram();
+	api.programBinary(id, format, binary.data(), length);
+
+	// The driver may still reject a binary (e.g. after an update with the same strings).
+	GLint linkStatus = GL_FALSE;
+	glGetProgramiv(id, GL_LINK_STATUS, &linkStatus);
+	if (linkStatus != GL_TRUE)
+	{
+		glDeleteProgram(id);
+		id = 0;
+		return false;
+	}
+	return true;
+}
+
+void Shader::saveProgramBinary(unsigned long long key) const
+{
+	const ProgramBinaryApi& api = GetProgramBinaryApi();
+	if (!api.available || g_binaryCacheDir.empty()) return;
+
+	GLint length = 0;
+	glGetProgramiv(id, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) return;
+
+	std::vector<char> binary(static_cast<size_t>(length));
+	GLenum format = 0;
+	GLsizei written = 0;
+	api.getProgramBinary(id, length, &written, &format, binary.data());
+	if (written <= 0) return;
+
+	std::error_code ec;
+	std::filesystem::create_directories(g_binaryCacheDir, ec);
+	if (ec) return; // cache is best effort
+
+	std::ofstream out(BinaryCachePath(key), std::ios::binary | std::ios::trunc);
+	if (!out.is_open()) return;
+	const GLint size = written;
+	out.write(kBinaryMagic, sizeof(kBinaryMagic));
+	out.write(reinterpret_cast<const char*>(&key), sizeof(key));
+	out.write(reinterpret_cast<const char*>(&format), sizeof(format));
+	out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+	out.write(binary.data(), written);
 }
 
 std::string Shader::loadShaderSource(const std::string& path) const
@@ -2,16 +2,31 @@
 
 #include <glm/glm.hpp>
 #include <string>
+#include <utility>
+#include <vector>
 
 class Shader
 {
 private:
     unsigned int id;
 
+    // Active uniform locations, resolved once after link (name -> location).
+    // Programs have a handful of uniforms: a linear scan beats hashing here.
+    std::vector<std::pair<std::string, int>> uniformLocations;
+
     std::string loadShaderSource(const std::string& path) const;
     unsigned int compileShader(unsigned int type, const std::string& source) const;
     void checkCompileErrors(unsigned int shader, const std::string& type) const;
 
+    // Link-time setup shared by the source and binary paths.
+    void cacheUniformLocations();
+    void bindUniformBlocks() const;
+    int getUniformLocation(const std::string& name) const;
+
+    // glProgramBinary cache (keyed by source hash + driver strings).
+    bool loadProgramBinary(unsigned long long key);
+    void saveProgramBinary(unsigned long long key) const;
+
 public:
     Shader();
     Shader(const std::string& vertexPath, const std::string& fragmentPath);
@@ -30,4 +45,7 @@ public:
 
     void setMat4(const std::string& name, const glm::mat4& mat) const;
 
+    // Directory for cached program binaries (empty disables the cache).
+    static void setBinaryCacheDirectory(const std::string& directory);
+
 };
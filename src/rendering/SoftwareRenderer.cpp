@@ -0,0 +1,466 @@
+#include "SoftwareRenderer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FW_SOFTWARE_SSE 1
+#endif
+
+#include <stbimage/stb_image.h>
+#include <stbimage/stb_image_write.h>
+
+#include "Camera.h"
+#include "../fireworks/particle/ParticlePool.h"
+#include "../fireworks/shapes/ShapeRegistry.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double MsSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+// dst = src * a + dst * (1 - a) on all four channels (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA).
+inline void BlendPixel(float* dst, const glm::vec4& src, float a)
+{
+#if defined(FW_SOFTWARE_SSE)
+    const __m128 s = _mm_set_ps(src.a, src.b, src.g, src.r);
+    const __m128 d = _mm_loadu_ps(dst);
+    const __m128 alpha = _mm_set1_ps(a);
+    const __m128 inv = _mm_set1_ps(1.0f - a);
+    _mm_storeu_ps(dst, _mm_add_ps(_mm_mul_ps(s, alpha), _mm_mul_ps(d, inv)));
+#else
+    const float inv = 1.0f - a;
+    dst[0] = src.r * a + dst[0] * inv;
+    dst[1] = src.g * a + dst[1] * inv;
+    dst[2] = src.b * a + dst[2] * inv;
+    dst[3] = src.a * a + dst[3] * inv;
+#endif
+}
+
+inline float EdgeFunction(const glm::vec2& a, const glm::vec2& b, float px, float py)
+{
+    return (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+}
+
+} // namespace
+
+SoftwareRenderer::SoftwareRenderer()
+    : width(0)
+    , height(0)
+    , tilesX(0)
+    , tilesY(0)
+    , threadCount(0)
+    , trailBaseOpacity(0.15f)
+{
+}
+
+void SoftwareRenderer::Resize(int w, int h)
+{
+    width = std::max(1, w);
+    height = std::max(1, h);
+    tilesX = (width + kTileSize - 1) / kTileSize;
+    tilesY = (height + kTileSize - 1) / kTileSize;
+    pixels.assign(static_cast<size_t>(width) * static_cast<size_t>(height) * 4, 0.0f);
+    layers.assign(static_cast<size_t>(width) * static_cast<size_t>(height), 0u);
+    tileBins.assign(static_cast<size_t>(tilesX) * static_cast<size_t>(tilesY), {});
+}
+
+int SoftwareRenderer::ResolveThreadCount() const
+{
+    if (threadCount > 0) return threadCount;
+    const unsigned hw = std::thread::hardware_concurrency();
+    return hw > 0 ? static_cast<int>(hw) : 4;
+}
+
+void SoftwareRenderer::LoadShapes(const ShapeRegistry& registry)
+{
+    sprites.assign(registry.Count(), Sprite());
+
+    for (size_t i = 0; i < registry.Count(); ++i) {
+        const std::string path = registry.GetShape(static_cast<uint16_t>(i)).getAssetPath();
+
+        int w = 0, h = 0, channels = 0;
+        unsigned char* data = stbi_load(path.c_str(), &w, &h, &channels, STBI_rgb_alpha);
+        if (!data) {
+            // Same outcome as a missing GL texture: the sprite is not drawn.
+            std::cerr << "SoftwareRenderer: cannot decode " << path << "\n";
+            continue;
+        }
+
+        Sprite& s = sprites[i];
+        s.width = w;
+        s.height = h;
+        s.alpha.resize(static_cast<size_t>(w) * static_cast<size_t>(h));
+        for (size_t p = 0; p < s.alpha.size(); ++p) {
+            s.alpha[p] = data[p * 4 + 3] / 255.0f;
+        }
+        stbi_image_free(data);
+    }
+}
+
+void SoftwareRenderer::Clear(const glm::vec4& color)
+{
+    for (size_t i = 0; i < pixels.size(); i += 4) {
+        pixels[i + 0] = color.r;
+        pixels[i + 1] = color.g;
+        pixels[i + 2] = color.b;
+        pixels[i + 3] = color.a;
+    }
+}
+
+void SoftwareRenderer::Render(const ParticlePool& pool, const Camera& camera, const glm::mat4& model)
+{
+    if (pixels.empty()) return;
+
+    stats = Stats();
+    const int threads = ResolveThreadCount();
+
+    auto t0 = Clock::now();
+    BuildPrimitives(pool, camera, model);
+    stats.setupMs = MsSince(t0);
+
+    t0 = Clock::now();
+    BinPrimitives(threads);
+    stats.binMs = MsSince(t0);
+
+    t0 = Clock::now();
+    std::fill(layers.begin(), layers.end(), 0u);
+    RasterizeTiles(threads);
+    stats.rasterMs = MsSince(t0);
+
+    ReduceLayers();
+
+    stats.sprites = spritePrims.size();
+    stats.triangles = trianglePrims.size();
+    stats.tiles = tilesX * tilesY;
+}
+
+void SoftwareRenderer::BuildPrimitives(const ParticlePool& pool, const Camera& camera, const glm::mat4& model)
+{
+    spritePrims.clear();
+    trianglePrims.clear();
+    submitOrder.clear();
+
+    const float aspect = static_cast<float>(width) / static_cast<float>(height);
+    const glm::mat4 view = camera.getViewMatrix();
+    const glm::mat4 viewProj = camera.getProjectionMatrix(aspect) * view * model;
+    const glm::vec3 cameraPos = camera.getPosition();
+
+    // Ribbons use the camera right vector, exactly like TrailRenderer.
+    glm::vec3 camRight = glm::vec3(glm::inverse(view)[0]);
+    const float len = glm::length(camRight);
+    if (len > 0.0f) camRight /= len;
+
+    // Returns false for points outside the clip volume (GL clips these too).
+    auto project = [&](const glm::vec3& p, glm::vec2& out) -> bool {
+        const glm::vec4 clip = viewProj * glm::vec4(p, 1.0f);
+        if (clip.w <= 1e-6f) return false;
+        if (clip.z < -clip.w || clip.z > clip.w) return false;
+        const float invW = 1.0f / clip.w;
+        out.x = (clip.x * invW * 0.5f + 0.5f) * static_cast<float>(width);
+        out.y = (1.0f - (clip.y * invW * 0.5f + 0.5f)) * static_cast<float>(height);
+        return true;
+    };
+
+    const auto& particles = pool.GetAll();
+
+    // Single pass over the pool; trails are submitted before sprites (same order as the GL path).
+    glm::vec2 prevL, prevR;
+    glm::vec4 prevC;
+    for (size_t i = 0; i < particles.size(); ++i) {
+        const auto& p = particles[i];
+        if (!p.active) continue;
+
+        // --- Sprite ---
+        if (p.shapeId < sprites.size() && !sprites[p.shapeId].alpha.empty()) {
+            glm::vec2 center;
+            if (project(p.position, center)) {
+                // particle.vert: gl_PointSize = aSize / max(distance to camera, 0.1)
+                const float dist = std::max(glm::length(p.position - cameraPos), 0.1f);
+                const float size = p.size / dist;
+                if (size >= 0.5f) {
+                    spritePrims.push_back({ center.x - 0.5f * size, center.y - 0.5f * size, size, p.color, p.shapeId });
+                }
+            }
+        }
+
+        // --- Trail ribbon ---
+        if (p.trailCount < 2) continue;
+        const EmitterParams& e = pool.GetEmitterParams(p.paramsIndex);
+        if (!e.trailEnabled || e.trailWidth <= 0.0f) continue;
+
+        const glm::vec3* buf = pool.GetTrailBuffer(static_cast<int>(i));
+        const int count = static_cast<int>(p.trailCount);
+        const int head = static_cast<int>(p.trailHead);
+        const float falloffPow = std::max(1.0f, e.trailFalloffPow);
+        const float opacity = std::max(0.0f, e.trailOpacity);
+
+        bool havePrev = false;
+        for (int j = 0; j < count; ++j) {
+            int ringIdx = head - (count - 1 - j);
+            while (ringIdx < 0) ringIdx += ParticlePool::kTrailSamples;
+            ringIdx %= ParticlePool::kTrailSamples;
+            const glm::vec3 pos = buf[ringIdx];
+
+            const float u = static_cast<float>(j) / static_cast<float>(count - 1);
+            const float a = std::pow(u, falloffPow);
+
+            float baseW = e.trailWidth;
+            if (baseW > 0.0f && baseW <= 1.0f) {
+                baseW = (p.size * baseW) * 0.0025f;
+            }
+            const glm::vec3 off = camRight * (baseW * (0.25f + 0.75f * u));
+
+            glm::vec4 c = p.color;
+            c.a *= (trailBaseOpacity * opacity * a);
+
+            glm::vec2 l, r;
+            if (!project(pos - off, l) || !project(pos + off, r)) {
+                havePrev = false;
+                continue;
+            }
+
+            if (havePrev) {
+                trianglePrims.push_back({ { prevL, prevR, l }, { prevC, prevC, c } });
+                trianglePrims.push_back({ { prevR, r, l }, { prevC, c, c } });
+            }
+            prevL = l;
+            prevR = r;
+            prevC = c;
+            havePrev = true;
+        }
+    }
+
+    submitOrder.reserve(trianglePrims.size() + spritePrims.size());
+    for (size_t i = 0; i < trianglePrims.size(); ++i) submitOrder.push_back({ static_cast<uint32_t>(i), true });
+    for (size_t i = 0; i < spritePrims.size(); ++i) submitOrder.push_back({ static_cast<uint32_t>(i), false });
+}
+
+void SoftwareRenderer::BinPrimitives(int threads)
+{
+    const size_t tileCount = tileBins.size();
+    for (auto& bin : tileBins) bin.clear();
+    if (submitOrder.empty()) return;
+
+    auto tileRange = [this](float minX, float minY, float maxX, float maxY, int& tx0, int& ty0, int& tx1, int& ty1) -> bool {
+        if (maxX < 0.0f || maxY < 0.0f || minX >= static_cast<float>(width) || minY >= static_cast<float>(height)) return false;
+        tx0 = std::max(0, static_cast<int>(minX) / kTileSize);
+        ty0 = std::max(0, static_cast<int>(minY) / kTileSize);
+        tx1 = std::min(tilesX - 1, static_cast<int>(maxX) / kTileSize);
+        ty1 = std::min(tilesY - 1, static_cast<int>(maxY) / kTileSize);
+        return true;
+    };
+
+    // Each worker bins a contiguous slice of the submit stream into private bins;
+    // concatenating the slices in worker order keeps the global draw order.
+    const size_t primCount = submitOrder.size();
+    const int workers = static_cast<int>(std::min<size_t>(static_cast<size_t>(threads), std::max<size_t>(1, primCount / 4096)));
+    std::vector<std::vector<std::vector<PrimRef>>> local(static_cast<size_t>(workers), std::vector<std::vector<PrimRef>>(tileCount));
+
+    auto binSlice = [&](int w) {
+        const size_t begin = primCount * static_cast<size_t>(w) / static_cast<size_t>(workers);
+        const size_t end = primCount * static_cast<size_t>(w + 1) / static_cast<size_t>(workers);
+        auto& bins = local[static_cast<size_t>(w)];
+        for (size_t i = begin; i < end; ++i) {
+            const PrimRef ref = submitOrder[i];
+            float minX, minY, maxX, maxY;
+            if (ref.isTriangle) {
+                const TrianglePrim& t = trianglePrims[ref.index];
+                minX = std::min({ t.p[0].x, t.p[1].x, t.p[2].x });
+                minY = std::min({ t.p[0].y, t.p[1].y, t.p[2].y });
+                maxX = std::max({ t.p[0].x, t.p[1].x, t.p[2].x });
+                maxY = std::max({ t.p[0].y, t.p[1].y, t.p[2].y });
+            }
+            else {
+                const SpritePrim& s = spritePrims[ref.index];
+                minX = s.x0;
+                minY = s.y0;
+                maxX = s.x0 + s.size;
+                maxY = s.y0 + s.size;
+            }
+            int tx0, ty0, tx1, ty1;
+            if (!tileRange(minX, minY, maxX, maxY, tx0, ty0, tx1, ty1)) continue;
+            for (int ty = ty0; ty <= ty1; ++ty) {
+                for (int tx = tx0; tx <= tx1; ++tx) {
+                    bins[static_cast<size_t>(ty * tilesX + tx)].push_back(ref);
+                }
+            }
+        }
+    };
+
+    if (workers == 1) {
+        binSlice(0);
+    }
+    else {
+        std::vector<std::thread> pool;
+        for (int w = 0; w < workers; ++w) pool.emplace_back(binSlice, w);
+        for (auto& t : pool) t.join();
+    }
+
+    for (size_t tile = 0; tile < tileCount; ++tile) {
+        auto& dst = tileBins[tile];
+        for (int w = 0; w < workers; ++w) {
+            const auto& src = local[static_cast<size_t>(w)][tile];
+            dst.insert(dst.end(), src.begin(), src.end());
+        }
+        stats.binnedRefs += dst.size();
+    }
+}
+
+void SoftwareRenderer::RasterizeTiles(int threads)
+{
+    const int tileCount = tilesX * tilesY;
+    std::atomic<int> next(0);
+
+    auto worker = [&]() {
+        for (;;) {
+            const int tile = next.fetch_add(1);
+            if (tile >= tileCount) return;
+            if (!tileBins[static_cast<size_t>(tile)].empty()) RasterizeTile(tile);
+        }
+    };
+
+    const int workers = std::max(1, std::min(threads, tileCount));
+    if (workers == 1) {
+        worker();
+        return;
+    }
+    std::vector<std::thread> pool;
+    for (int i = 0; i < workers; ++i) pool.emplace_back(worker);
+    for (auto& t : pool) t.join();
+}
+
+void SoftwareRenderer::RasterizeTile(int tileIndex)
+{
+    const int tx0 = (tileIndex % tilesX) * kTileSize;
+    const int ty0 = (tileIndex / tilesX) * kTileSize;
+    const int tx1 = std::min(tx0 + kTileSize, width);
+    const int ty1 = std::min(ty0 + kTileSize, height);
+
+    for (const PrimRef& ref : tileBins[static_cast<size_t>(tileIndex)]) {
+        if (ref.isTriangle) DrawTriangle(trianglePrims[ref.index], tx0, ty0, tx1, ty1);
+        else DrawSprite(spritePrims[ref.index], tx0, ty0, tx1, ty1);
+    }
+}
+
+void SoftwareRenderer::DrawSprite(const SpritePrim& s, int tx0, int ty0, int tx1, int ty1)
+{
+    const Sprite& sprite = sprites[s.shapeId];
+    const int x0 = std::max(tx0, static_cast<int>(std::floor(s.x0)));
+    const int y0 = std::max(ty0, static_cast<int>(std::floor(s.y0)));
+    const int x1 = std::min(tx1, static_cast<int>(std::ceil(s.x0 + s.size)));
+    const int y1 = std::min(ty1, static_cast<int>(std::ceil(s.y0 + s.size)));
+    const float invSize = 1.0f / s.size;
+
+    // Texture was uploaded flipped and sampled with gl_PointCoord (origin top-left),
+    // so point-coord t = 0 reads the bottom row of the image.
+    const float maxU = static_cast<float>(sprite.width - 1);
+    const float maxV = static_cast<float>(sprite.height - 1);
+
+    for (int y = y0; y < y1; ++y) {
+        const float t = (static_cast<float>(y) + 0.5f - s.y0) * invSize;
+        if (t < 0.0f || t >= 1.0f) continue;
+        const float fy = std::clamp((1.0f - t) * static_cast<float>(sprite.height) - 0.5f, 0.0f, maxV);
+        const int iy0 = static_cast<int>(fy);
+        const int iy1 = std::min(iy0 + 1, sprite.height - 1);
+        const float wy = fy - static_cast<float>(iy0);
+
+        float* row = &pixels[(static_cast<size_t>(y) * static_cast<size_t>(width)) * 4];
+        uint32_t* layerRow = &layers[static_cast<size_t>(y) * static_cast<size_t>(width)];
+        for (int x = x0; x < x1; ++x) {
+            const float u = (static_cast<float>(x) + 0.5f - s.x0) * invSize;
+            if (u < 0.0f || u >= 1.0f) continue;
+            const float fx = std::clamp(u * static_cast<float>(sprite.width) - 0.5f, 0.0f, maxU);
+            const int ix0 = static_cast<int>(fx);
+            const int ix1 = std::min(ix0 + 1, sprite.width - 1);
+            const float wx = fx - static_cast<float>(ix0);
+
+            const float* a0 = &sprite.alpha[static_cast<size_t>(iy0) * static_cast<size_t>(sprite.width)];
+            const float* a1 = &sprite.alpha[static_cast<size_t>(iy1) * static_cast<size_t>(sprite.width)];
+            const float texA = (a0[ix0] * (1.0f - wx) + a0[ix1] * wx) * (1.0f - wy)
+                             + (a1[ix0] * (1.0f - wx) + a1[ix1] * wx) * wy;
+
+            // particle.frag: FragColor = vColor * vec4(1, 1, 1, texA), discard below 0.01.
+            glm::vec4 c = s.color;
+            c.a *= texA;
+            if (c.a < 0.01f) continue;
+
+            ++layerRow[x];
+            BlendPixel(row + static_cast<size_t>(x) * 4, c, c.a);
+        }
+    }
+}
+
+void SoftwareRenderer::DrawTriangle(const TrianglePrim& t, int tx0, int ty0, int tx1, int ty1)
+{
+    const float area = EdgeFunction(t.p[0], t.p[1], t.p[2].x, t.p[2].y);
+    if (std::fabs(area) < 1e-8f) return;
+    const float invArea = 1.0f / area;
+
+    const int x0 = std::max(tx0, static_cast<int>(std::floor(std::min({ t.p[0].x, t.p[1].x, t.p[2].x }))));
+    const int y0 = std::max(ty0, static_cast<int>(std::floor(std::min({ t.p[0].y, t.p[1].y, t.p[2].y }))));
+    const int x1 = std::min(tx1, static_cast<int>(std::ceil(std::max({ t.p[0].x, t.p[1].x, t.p[2].x }))));
+    const int y1 = std::min(ty1, static_cast<int>(std::ceil(std::max({ t.p[0].y, t.p[1].y, t.p[2].y }))));
+
+    for (int y = y0; y < y1; ++y) {
+        const float py = static_cast<float>(y) + 0.5f;
+        float* row = &pixels[(static_cast<size_t>(y) * static_cast<size_t>(width)) * 4];
+        uint32_t* layerRow = &layers[static_cast<size_t>(y) * static_cast<size_t>(width)];
+        for (int x = x0; x < x1; ++x) {
+            const float px = static_cast<float>(x) + 0.5f;
+            // Barycentrics normalized by the signed area: works for both windings.
+            const float w0 = EdgeFunction(t.p[1], t.p[2], px, py) * invArea;
+            const float w1 = EdgeFunction(t.p[2], t.p[0], px, py) * invArea;
+            const float w2 = 1.0f - w0 - w1;
+            if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
+            // The trail program never discards: transparent fragments still count.
+            ++layerRow[x];
+
+            // Screen-space interpolation (trail colors vary slowly; perspective error is negligible).
+            const glm::vec4 c = t.c[0] * w0 + t.c[1] * w1 + t.c[2] * w2;
+            if (c.a <= 0.0f) continue;
+            BlendPixel(row + static_cast<size_t>(x) * 4, c, c.a);
+        }
+    }
+}
+
+void SoftwareRenderer::ReduceLayers()
+{
+    size_t covered = 0;
+    uint64_t sum = 0;
+    uint32_t maxLayers = 0;
+    for (uint32_t v : layers) {
+        sum += v;
+        if (v > maxLayers) maxLayers = v;
+        if (v > 0) ++covered;
+    }
+
+    if (!layers.empty()) stats.avgLayers = static_cast<float>(static_cast<double>(sum) / static_cast<double>(layers.size()));
+    stats.avgLayersCovered = covered > 0 ? static_cast<float>(static_cast<double>(sum) / static_cast<double>(covered)) : 0.0f;
+    stats.maxLayers = static_cast<float>(maxLayers);
+    stats.fragments = static_cast<double>(sum);
+}
+
+bool SoftwareRenderer::WritePng(const std::string& path) const
+{
+    if (pixels.empty()) return false;
+
+    std::vector<unsigned char> out(static_cast<size_t>(width) * static_cast<size_t>(height) * 4);
+    for (size_t i = 0; i < out.size(); i += 4) {
+        for (size_t c = 0; c < 3; ++c) {
+            const float v = std::clamp(pixels[i + c], 0.0f, 1.0f);
+            out[i + c] = static_cast<unsigned char>(v * 255.0f + 0.5f);
+        }
+        out[i + 3] = 255;
+    }
+    return stbi_write_png(path.c_str(), width, height, 4, out.data(), width * 4) != 0;
+}
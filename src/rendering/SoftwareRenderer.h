@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class Camera;
+class ParticlePool;
+class ShapeRegistry;
+
+// Pure-CPU splat renderer (no GL context needed).
+//
+// Consumes the same data as ParticleRenderer / TrailRenderer: textured point sprites
+// (shape PNGs decoded with stb) and camera-facing trail ribbons, composited with the
+// same alpha blending into an RGBA float buffer. Work is split in three phases:
+//   1. project particles / ribbon triangles to screen-space primitives,
+//   2. bin primitives into fixed-size tiles (per-thread bins, merged in submit order),
+//   3. rasterize tiles in parallel; each tile is owned by one thread, so blending
+//      needs no synchronization and stays in draw order.
+// Used for headless thumbnails, regression images and asset browser previews.
+class SoftwareRenderer {
+public:
+    static constexpr int kTileSize = 32;
+
+    struct Stats {
+        size_t sprites = 0;
+        size_t triangles = 0;
+        size_t binnedRefs = 0;   // primitive references across all tiles
+        int tiles = 0;
+        // Overdraw, counted like OverdrawView: one layer per fragment that survives the
+        // regular pass's alpha discard (sprites), every rasterized fragment for trails.
+        float avgLayers = 0.0f;         // over all pixels of the frame
+        float avgLayersCovered = 0.0f;  // over pixels touched at least once
+        float maxLayers = 0.0f;
+        double fragments = 0.0;         // total fragments written by particles + trails
+        double setupMs = 0.0;
+        double binMs = 0.0;
+        double rasterMs = 0.0;
+    };
+
+    SoftwareRenderer();
+
+    // Allocates the framebuffer (RGBA float, top-down rows).
+    void Resize(int width, int height);
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+
+    // 0 = hardware concurrency.
+    void SetThreadCount(int threads) { threadCount = threads; }
+
+    void SetTrailBaseOpacity(float o) { trailBaseOpacity = o; }
+
+    // Decodes the sprite of every registered shape (builtin + custom) with stb.
+    // Does not touch GL: the registry only provides asset paths.
+    void LoadShapes(const ShapeRegistry& registry);
+
+    void Clear(const glm::vec4& color);
+
+    // Trails first, then sprites (same order as the GL path).
+    void Render(const ParticlePool& pool, const Camera& camera, const glm::mat4& model = glm::mat4(1.0f));
+
+    // Writes the framebuffer as an opaque 8-bit PNG.
+    bool WritePng(const std::string& path) const;
+
+    const std::vector<float>& GetPixels() const { return pixels; }
+    const Stats& GetStats() const { return stats; }
+
+private:
+    struct Sprite {
+        int width = 0;
+        int height = 0;
+        std::vector<float> alpha; // particle.frag only uses the texture alpha
+    };
+
+    struct SpritePrim {
+        float x0, y0;   // top-left corner in pixels
+        float size;     // point size in pixels
+        glm::vec4 color;
+        uint16_t shapeId;
+    };
+
+    struct TrianglePrim {
+        glm::vec2 p[3];
+        glm::vec4 c[3];
+    };
+
+    // Primitive reference: sprites and triangles share one ordered stream per tile.
+    struct PrimRef {
+        uint32_t index;
+        bool isTriangle;
+    };
+
+    void BuildPrimitives(const ParticlePool& pool, const Camera& camera, const glm::mat4& model);
+    void BinPrimitives(int threads);
+    void RasterizeTiles(int threads);
+    void RasterizeTile(int tileIndex);
+
+    void DrawSprite(const SpritePrim& s, int tx0, int ty0, int tx1, int ty1);
+    void DrawTriangle(const TrianglePrim& t, int tx0, int ty0, int tx1, int ty1);
+    void ReduceLayers();
+
+    int ResolveThreadCount() const;
+
+    int width;
+    int height;
+    int tilesX;
+    int tilesY;
+    int threadCount;
+    float trailBaseOpacity;
+
+    std::vector<float> pixels;
+    std::vector<uint32_t> layers; // fragments per pixel in the last Render()
+    std::vector<Sprite> sprites;
+
+    std::vector<SpritePrim> spritePrims;
+    std::vector<TrianglePrim> trianglePrims;
+    std::vector<PrimRef> submitOrder;
+    std::vector<std::vector<PrimRef>> tileBins;
+
+    Stats stats;
+};
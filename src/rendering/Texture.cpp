@@ -1,5 +1,4 @@
-﻿#define STB_IMAGE_IMPLEMENTATION
-#include "Texture.h"
+﻿#include "Texture.h"
 
 #include <stbimage/stb_image.h>
 #include <iostream>
@@ -34,7 +33,20 @@ GLuint Texture::LoadFromFile(const std::string& path, bool flipVertically)
         std::cerr << "      For best results, use RGBA PNG with proper alpha channel.\n";
     }
 
-    // Créer la texture OpenGL
+    GLuint tex = CreateFromPixels(data, width, height);
+
+    // Libérer les données CPU
+    stbi_image_free(data);
+
+    std::cerr << "  ✅ Texture created successfully, OpenGL ID: " << tex << "\n";
+
+    return tex;
+}
+
+GLuint Texture::CreateFromPixels(const unsigned char* rgba, int width, int height)
+{
+    if (!rgba || width <= 0 || height <= 0) return 0;
+
     GLuint tex = 0;
     glGenTextures(1, &tex);
     glBindTexture(GL_TEXTURE_2D, tex);
@@ -49,19 +61,12 @@ GLuint Texture::LoadFromFile(const std::string& path, bool flipVertically)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 
     // Upload texture data (toujours RGBA)
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0,
-        GL_RGBA, GL_UNSIGNED_BYTE, data);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
 
     // Générer mipmaps pour un meilleur rendu à distance
     glGenerateMipmap(GL_TEXTURE_2D);
 
-    // Libérer les données CPU
-    stbi_image_free(data);
-
     // Débinder
     glBindTexture(GL_TEXTURE_2D, 0);
-
-    std::cerr << "  ✅ Texture created successfully, OpenGL ID: " << tex << "\n";
-
     return tex;
-}
\ No newline at end of file
+}
@@ -9,4 +9,7 @@ class Texture
 public:
     // Retourne 0 en cas d'erreur. flipVertically = true par défaut.
     static GLuint LoadFromFile(const std::string& path, bool flipVertically = true);
+
+    // Crée une texture RGBA8 (mipmaps) depuis des pixels déjà décodés. Contexte GL requis.
+    static GLuint CreateFromPixels(const unsigned char* rgba, int width, int height);
 };
\ No newline at end of file
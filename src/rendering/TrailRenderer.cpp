@@ -6,17 +6,23 @@
 
 #include "Shader.h"
 #include "Camera.h"
+#include "FrameUniforms.h"
 
 #include "../fireworks/particle/ParticlePool.h"
 
 TrailRenderer::TrailRenderer(Shader* s)
     : shader(s)
+    , frameUniforms(nullptr)
     , vao(0)
     , vbo(0)
     , ebo(0)
     , aspectRatio(16.0f / 9.0f)
     , alphaPower(1.5f)
     , baseOpacity(0.15f)
+    , additiveBlending(false)
+    , uploadedValid(false)
+    , uploadedIndexCount(0)
+    , preparedValid(false)
 {
 }
 
@@ -55,6 +61,8 @@ bool TrailRenderer::initialize()
     return true;
 }
 
+static constexpr std::uint32_t kRestart = 0xFFFFFFFFu;
+
 static inline glm::vec3 CameraRightFromView(const glm::mat4& view)
 {
     // View matrix rotates world into camera space. The camera basis in world space is the inverse rotation.
@@ -65,29 +73,78 @@ static inline glm::vec3 CameraRightFromView(const glm::mat4& view)
     return right;
 }
 
+TrailRenderer::Inputs TrailRenderer::CurrentInputs(const ParticlePool& pool, const Camera& camera) const
+{
+    Inputs in;
+    in.version = pool.GetVersion();
+    in.view = camera.getViewMatrix();
+    in.alphaPower = alphaPower;
+    in.baseOpacity = baseOpacity;
+    return in;
+}
+
+void TrailRenderer::Prepare(const ParticlePool& pool, const Camera& camera)
+{
+    const Inputs in = CurrentInputs(pool, camera);
+    if (uploadedValid && uploaded == in) return;
+    if (preparedValid && prepared == in) return;
+    Build(pool, in.view);
+    prepared = in;
+    preparedValid = true;
+}
+
 void TrailRenderer::Render(const ParticlePool& pool, const Camera& camera, const glm::mat4& model)
 {
     if (!shader || vao == 0 || vbo == 0 || ebo == 0) return;
 
+    // Ribbons depend on the pool contents, the camera basis and the opacity knobs only:
+    // when none of them changed (frozen preview, UI-only frame) redraw the last upload.
+    const Inputs in = CurrentInputs(pool, camera);
+    if (uploadedValid && uploaded == in) {
+        Draw(camera, model);
+        return;
+    }
+
+    Prepare(pool, camera); // already done if a task thread got there first
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, cpuVertices.size() * sizeof(TrailVertex), cpuVertices.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // The element buffer is VAO state.
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, cpuIndices.size() * sizeof(std::uint32_t), cpuIndices.data(), GL_DYNAMIC_DRAW);
+    glBindVertexArray(0);
+
+    uploadedIndexCount = cpuIndices.size();
+    uploaded = in;
+    uploadedValid = true;
+    preparedValid = false;
+
+    Draw(camera, model);
+}
+
+void TrailRenderer::Build(const ParticlePool& pool, const glm::mat4& view)
+{
     cpuVertices.clear();
     cpuIndices.clear();
 
-    const glm::mat4 view = camera.getViewMatrix();
     const glm::vec3 camRight = CameraRightFromView(view);
 
     const auto& particles = pool.GetAll();
     cpuVertices.reserve(pool.GetActiveCount() * 8); // heuristic; avoids frequent realloc
     cpuIndices.reserve(pool.GetActiveCount() * 12);
 
-    constexpr std::uint32_t kRestart = 0xFFFFFFFFu;
     std::uint32_t baseVertex = 0;
 
     for (size_t i = 0; i < particles.size(); ++i) {
         const auto& p = particles[i];
         if (!p.active) continue;
-        if (!p.trailEnabled) continue;
         if (p.trailCount < 2) continue;
-        if (p.trailWidth <= 0.0f) continue;
+        const EmitterParams& e = pool.GetEmitterParams(p.paramsIndex);
+        if (!e.trailEnabled) continue;
+        if (e.trailWidth <= 0.0f) continue;
 
         const glm::vec3* buf = pool.GetTrailBuffer(static_cast<int>(i));
 
@@ -100,8 +157,8 @@ void TrailRenderer::Render(const ParticlePool& pool, const Camera& camera, const
         // This is visually stable and cheap; if you want true "segment perpendicular" ribbons,
         // compute per-segment perpendicular using segment direction and camera forward.
 
-        const float falloffPow = std::max(1.0f, p.trailFalloffPow);
-        const float opacity = std::max(0.0f, p.trailOpacity);
+        const float falloffPow = std::max(1.0f, e.trailFalloffPow);
+        const float opacity = std::max(0.0f, e.trailOpacity);
 
         for (int j = 0; j < count; ++j) {
             // Oldest sample index in ring buffer
@@ -118,7 +175,7 @@ void TrailRenderer::Render(const ParticlePool& pool, const Camera& camera, const
             // Width taper (thinner at the tail)
             // Authoring convenience: if trailWidth <= 1, treat it as a fraction of particle size.
             // Otherwise keep it as world-space width.
-            float baseW = p.trailWidth;
+            float baseW = e.trailWidth;
             if (baseW > 0.0f && baseW <= 1.0f) {
                 baseW = (p.size * baseW) * 0.0025f; // heuristic mapping pixels -> world
             }
@@ -141,36 +198,31 @@ void TrailRenderer::Render(const ParticlePool& pool, const Camera& camera, const
         cpuIndices.push_back(kRestart);
         baseVertex += vertCount;
     }
+}
 
-    if (cpuVertices.empty() || cpuIndices.empty()) return;
+void TrailRenderer::Draw(const Camera& camera, const glm::mat4& model)
+{
+    if (uploadedIndexCount == 0) return;
 
     shader->use();
 
-    int width, height;
-    // We only need aspect; caller already sets aspectRatio. Keep this renderer simple.
-    (void)width; (void)height;
-    glm::mat4 proj = camera.getProjectionMatrix(aspectRatio);
-    shader->setMat4("view", view);
-    shader->setMat4("projection", proj);
+    // view / projection live in the shared FrameUniforms block (no-op if unchanged).
+    if (frameUniforms) frameUniforms->Update(camera, aspectRatio);
+    shader->setMat4("model", model);
 
     glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, cpuVertices.size() * sizeof(TrailVertex), cpuVertices.data(), GL_DYNAMIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, cpuIndices.size() * sizeof(std::uint32_t), cpuIndices.data(), GL_DYNAMIC_DRAW);
 
     // Trails should be low opacity and stable: use standard alpha blending.
     glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    if (additiveBlending) glBlendFunc(GL_ONE, GL_ONE);
+    else glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     glEnable(GL_PRIMITIVE_RESTART);
     glPrimitiveRestartIndex(kRestart);
 
-    glDrawElements(GL_TRIANGLE_STRIP, static_cast<GLsizei>(cpuIndices.size()), GL_UNSIGNED_INT, (void*)0);
+    glDrawElements(GL_TRIANGLE_STRIP, static_cast<GLsizei>(uploadedIndexCount), GL_UNSIGNED_INT, (void*)0);
 
     glDisable(GL_PRIMITIVE_RESTART);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 }
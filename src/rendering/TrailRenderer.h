@@ -7,6 +7,7 @@
 
 class Shader;
 class Camera;
+class FrameUniforms;
 class ParticlePool;
 
 // Renders camera-facing ribbon trails using per-particle position history
@@ -19,8 +20,14 @@ public:
     bool initialize();
 
     void SetAspectRatio(float aspect) { aspectRatio = aspect; }
+    // Shared camera UBO (view / projection / camera position), owned by Application.
+    void SetFrameUniforms(FrameUniforms* uniforms) { frameUniforms = uniforms; }
     void Render(const ParticlePool& pool, const Camera& camera, const glm::mat4& model = glm::mat4(1.0f));
 
+    // CPU half of Render(): builds the ribbons without any GL call, so it can run on a task
+    // thread before Render() uploads them. No-op when the inputs are unchanged.
+    void Prepare(const ParticlePool& pool, const Camera& camera);
+
     // Global tuning (kept minimal; per-particle settings come from Particle fields)
     void SetAlphaPower(float p) { alphaPower = p; }
 
@@ -28,6 +35,11 @@ public:
     // renderer-level so you can quickly tune visibility without changing data models.
     void SetBaseOpacity(float o) { baseOpacity = o; }
 
+    // Debug views (overdraw) temporarily swap the program and blend mode.
+    void SetShader(Shader* s) { shader = s; }
+    Shader* GetShader() const { return shader; }
+    void SetAdditiveBlending(bool additive) { additiveBlending = additive; }
+
 private:
     struct TrailVertex {
         glm::vec3 position;
@@ -35,13 +47,39 @@ private:
     };
 
     Shader* shader;
+    FrameUniforms* frameUniforms;
     unsigned int vao;
     unsigned int vbo;
     unsigned int ebo;
     float aspectRatio;
     float alphaPower;
     float baseOpacity;
+    bool additiveBlending;
 
     std::vector<TrailVertex> cpuVertices;
     std::vector<std::uint32_t> cpuIndices;
+
+    // What the ribbons depend on: pool contents, camera basis and the opacity knobs.
+    struct Inputs {
+        std::uint64_t version = 0;
+        glm::mat4 view = glm::mat4(1.0f);
+        float alphaPower = 0.0f;
+        float baseOpacity = 0.0f;
+        bool operator==(const Inputs& o) const
+        {
+            return version == o.version && view == o.view && alphaPower == o.alphaPower && baseOpacity == o.baseOpacity;
+        }
+    };
+    Inputs CurrentInputs(const ParticlePool& pool, const Camera& camera) const;
+
+    // Inputs of the last upload; Render() redraws it as-is while they are unchanged.
+    bool uploadedValid;
+    Inputs uploaded;
+    size_t uploadedIndexCount;
+    // Inputs of the ribbons in cpuVertices / cpuIndices not uploaded yet.
+    bool preparedValid;
+    Inputs prepared;
+
+    void Build(const ParticlePool& pool, const glm::mat4& view);
+    void Draw(const Camera& camera, const glm::mat4& model);
 };
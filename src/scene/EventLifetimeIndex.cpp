@@ -0,0 +1,85 @@
+#include "EventLifetimeIndex.h"
+
+#include <limits>
+
+#include "OccupancyPredictor.h"
+#include "Scene.h"
+#include "../fireworks/template/TemplateLibrary.h"
+
+float EventLifetimeIndex::TemplateLifetime(const FireworkTemplate* t)
+{
+    if (!t) return kMinLifetime;
+    return std::max(kMinLifetime, OccupancyPredictor::ActiveSeconds(*t));
+}
+
+bool EventLifetimeIndex::Refresh(const Scene& scene, const TemplateLibrary& library)
+{
+    // Unchanged scene and templates: nothing to look at.
+    if (scene.GetEditVersion() == sceneVersion && library.GetEditVersion() == libraryVersion) return false;
+    sceneVersion = scene.GetEditVersion();
+    libraryVersion = library.GetEditVersion();
+
+    const EventSchedule& schedule = scene.GetSchedule();
+    const auto& events = scene.GetEvents();
+
+    // Template edits: only the edited templates get a new lifetime.
+    bool lifetimesChanged = false;
+    for (auto& entry : lifetimes) {
+        const FireworkTemplate* t = library.Get(entry.first);
+        const uint64_t version = t ? t->GetBranchesVersion() : 0;
+        if (version == entry.second.version) continue;
+        entry.second.version = version;
+        entry.second.seconds = TemplateLifetime(t);
+        lifetimesChanged = true;
+    }
+
+    bool scheduleChanged = schedule.GetVersion() != scheduleVersion || templateIds.size() != events.size();
+    // Template swaps are plain field writes on the event: compare ids (no sort, no lookup).
+    for (size_t i = 0; i < events.size() && !scheduleChanged; ++i) {
+        scheduleChanged = events[i].templateId != templateIds[i];
+    }
+    if (!scheduleChanged && !lifetimesChanged) return false;
+    scheduleVersion = schedule.GetVersion();
+
+    // Refill in schedule order: already sorted by start, no sort needed.
+    const auto& entries = schedule.GetEntries();
+    intervals.resize(entries.size());
+    positions.resize(entries.size());
+    templateIds.resize(events.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const uint32_t index = entries[i].index;
+        const int templateId = events[index].templateId;
+
+        auto it = lifetimes.find(templateId);
+        if (it == lifetimes.end()) {
+            const FireworkTemplate* t = library.Get(templateId);
+            TemplateLife life;
+            life.version = t ? t->GetBranchesVersion() : 0;
+            life.seconds = TemplateLifetime(t);
+            it = lifetimes.emplace(templateId, life).first;
+        }
+
+        Interval& interval = intervals[i];
+        interval.start = entries[i].time;
+        interval.end = entries[i].time + it->second.seconds;
+        interval.index = index;
+        positions[index] = static_cast<uint32_t>(i);
+        templateIds[index] = templateId;
+    }
+
+    BuildTree();
+    return true;
+}
+
+void EventLifetimeIndex::BuildTree()
+{
+    leaves = 1;
+    while (leaves < intervals.size()) leaves *= 2;
+
+    // Padding leaves never match (every query wants end > from).
+    maxEnd.assign(2 * leaves, -std::numeric_limits<float>::infinity());
+    for (size_t i = 0; i < intervals.size(); ++i) maxEnd[leaves + i] = intervals[i].end;
+    for (size_t node = leaves - 1; node >= 1; --node) {
+        maxEnd[node] = std::max(maxEnd[2 * node], maxEnd[2 * node + 1]);
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class Scene;
+class FireworkTemplate;
+class TemplateLibrary;
+
+// Interval index over the lifetimes of a scene's events: event i is alive on
+// [triggerTime, triggerTime + lifetime of its template).
+//
+// Intervals are stored in the scene schedule's time order with an implicit max-end tree on
+// top, so "alive at t" and "overlapping [a, b)" queries cost O(log n + k log n) for k
+// results instead of a scan of every event.
+//
+// Refresh() costs two version compares when neither the scene nor the library was edited.
+// A schedule edit refills the intervals in O(n) from the already sorted schedule; a template
+// edit only recomputes that template's lifetime.
+class EventLifetimeIndex {
+public:
+    struct Interval {
+        float start;
+        float end;
+        uint32_t index; // into Scene::GetEvents()
+    };
+
+    // Shortest lifetime given to an event, so empty templates still show up.
+    static constexpr float kMinLifetime = 0.05f;
+
+    // Seconds from trigger until the last particle (smoke and recursion included) is gone.
+    static float TemplateLifetime(const FireworkTemplate* t);
+
+    // Brings the index up to date with the scene and its templates. Returns true when it changed.
+    bool Refresh(const Scene& scene, const TemplateLibrary& library);
+
+    size_t Size() const { return intervals.size(); }
+    const std::vector<Interval>& GetIntervals() const { return intervals; }
+
+    // Interval of one event (nullptr if the index is stale for it).
+    const Interval* Find(size_t eventIndex) const
+    {
+        if (eventIndex >= positions.size()) return nullptr;
+        return &intervals[positions[eventIndex]];
+    }
+
+    // fn(eventIndex) for every event alive at t (start <= t < end), in trigger order.
+    template <typename F>
+    size_t ForEachAlive(float t, F&& fn) const
+    {
+        return ForEachOverlapping(t, t, fn);
+    }
+
+    // fn(eventIndex) for every event whose interval meets [from, to] (start <= to, end > from).
+    template <typename F>
+    size_t ForEachOverlapping(float from, float to, F&& fn) const
+    {
+        // Candidates: every interval starting at or before `to`.
+        const auto last = std::upper_bound(intervals.begin(), intervals.end(), to,
+            [](float t, const Interval& i) { return t < i.start; });
+        const size_t count = static_cast<size_t>(last - intervals.begin());
+        if (count == 0) return 0;
+        return Collect(1, 0, leaves, count, from, fn);
+    }
+
+private:
+    struct TemplateLife {
+        uint64_t version = 0;
+        float seconds = 0.0f;
+    };
+
+    // Visits node (covering leaves [lo, hi)) restricted to leaves < count, skipping every
+    // subtree whose intervals all end at or before `from`.
+    template <typename F>
+    size_t Collect(size_t node, size_t lo, size_t hi, size_t count, float from, F& fn) const
+    {
+        if (lo >= count || maxEnd[node] <= from) return 0;
+        if (hi - lo == 1) {
+            fn(static_cast<size_t>(intervals[lo].index));
+            return 1;
+        }
+        const size_t mid = (lo + hi) / 2;
+        return Collect(2 * node, lo, mid, count, from, fn) + Collect(2 * node + 1, mid, hi, count, from, fn);
+    }
+
+    void BuildTree();
+
+    std::vector<Interval> intervals; // by start (schedule order)
+    std::vector<uint32_t> positions; // event index -> slot in intervals
+    std::vector<int> templateIds;    // event index -> template the lifetime was taken from
+    std::vector<float> maxEnd;       // implicit tree, node 1 = root, leaves at [leaves, 2 * leaves)
+    size_t leaves = 0;
+
+    std::unordered_map<int, TemplateLife> lifetimes; // per template id
+    uint64_t scheduleVersion = 0;
+    uint64_t sceneVersion = 0;   // Scene::GetEditVersion() at the last refresh
+    uint64_t libraryVersion = 0; // TemplateLibrary::GetEditVersion() at the last refresh
+};
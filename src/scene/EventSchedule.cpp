@@ -0,0 +1,78 @@
+#include "EventSchedule.h"
+
+#include <atomic>
+
+#include "Scene.h"
+
+uint64_t EventSchedule::NextVersion()
+{
+    // Shared by every schedule: a copied or freshly loaded scene never reuses a version that
+    // a cursor or index of another scene was computed against.
+    static std::atomic<uint64_t> counter{ 0 };
+    return ++counter;
+}
+
+void EventSchedule::Rebuild(const std::vector<FireworkEvent>& events)
+{
+    entries.clear();
+    entries.reserve(events.size());
+    for (size_t i = 0; i < events.size(); ++i) {
+        entries.push_back({ events[i].triggerTime, static_cast<uint32_t>(i) });
+    }
+    std::sort(entries.begin(), entries.end(), Before);
+    version = NextVersion();
+}
+
+void EventSchedule::Insert(uint32_t index, float time)
+{
+    const Entry e{ time, index };
+    entries.insert(std::upper_bound(entries.begin(), entries.end(), e, Before), e);
+    version = NextVersion();
+}
+
+bool EventSchedule::Remove(uint32_t index, float time)
+{
+    const Entry key{ time, index };
+    auto it = std::lower_bound(entries.begin(), entries.end(), key, Before);
+    if (it == entries.end() || it->index != index || it->time != time) return false;
+    entries.erase(it);
+
+    // Indices past the erased event moved down by one; the order is unchanged.
+    for (auto& e : entries) {
+        if (e.index > index) --e.index;
+    }
+    version = NextVersion();
+    return true;
+}
+
+bool EventSchedule::Move(uint32_t index, float oldTime, float newTime)
+{
+    const Entry oldKey{ oldTime, index };
+    auto it = std::lower_bound(entries.begin(), entries.end(), oldKey, Before);
+    if (it == entries.end() || it->index != index || it->time != oldTime) return false;
+    if (oldTime == newTime) return true;
+
+    // Slide the entry to its new place (rotate keeps the others in order).
+    const Entry moved{ newTime, index };
+    if (newTime > oldTime) {
+        auto to = std::upper_bound(it + 1, entries.end(), moved, Before);
+        std::rotate(it, it + 1, to);
+        *(to - 1) = moved;
+    }
+    else {
+        auto to = std::lower_bound(entries.begin(), it, moved, Before);
+        std::rotate(to, it, it + 1);
+        *to = moved;
+    }
+    version = NextVersion();
+    return true;
+}
+
+void EventSchedule::Seek(Cursor& cursor, float time) const
+{
+    auto it = std::upper_bound(entries.begin(), entries.end(), time,
+        [](float t, const Entry& e) { return t < e.time; });
+    cursor.position = static_cast<size_t>(it - entries.begin());
+    cursor.time = time;
+    cursor.version = version;
+}
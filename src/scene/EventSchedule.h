@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct FireworkEvent;
+
+// Time-sorted index of a scene's events, used by playback dispatch.
+//
+// Entries are (triggerTime, event index) pairs ordered by time, ties by index. The Scene
+// keeps it in step with its event list: an add, remove or time edit moves one entry instead
+// of re-sorting the events themselves, so event indices (UI selection) stay stable.
+//
+// A Cursor remembers where the last dispatch stopped. Advancing it over a continuous time
+// range costs O(events fired); a jump (scrub, loop, restart) or an edit of the schedule
+// re-seeks it with a binary search.
+class EventSchedule {
+public:
+    struct Entry {
+        float time;
+        uint32_t index; // into Scene::GetEvents()
+    };
+
+    struct Cursor {
+        size_t position = 0;   // first entry not fired yet
+        float time = 0.0f;     // dispatch time the position is valid for
+        uint64_t version = 0;  // schedule version the position was computed against (0 = none)
+    };
+
+    // Full rebuild, O(n log n).
+    void Rebuild(const std::vector<FireworkEvent>& events);
+
+    // Incremental upkeep, O(log n) search + O(n) shift of the sorted array. Remove and Move
+    // return false when (index, time) is not in the schedule: the caller should Rebuild().
+    void Insert(uint32_t index, float time);            // event appended at index
+    bool Remove(uint32_t index, float time);            // event erased, later indices shift down
+    bool Move(uint32_t index, float oldTime, float newTime);
+
+    size_t Size() const { return entries.size(); }
+    const std::vector<Entry>& GetEntries() const { return entries; }
+    uint64_t GetVersion() const { return version; }
+
+    // Calls fire(eventIndex) for every entry with fromTime < time <= toTime, in time order,
+    // and leaves the cursor at toTime. Returns the number of entries fired.
+    template <typename F>
+    size_t Advance(Cursor& cursor, float fromTime, float toTime, F&& fire) const
+    {
+        if (cursor.version != version || cursor.time != fromTime) Seek(cursor, fromTime);
+
+        size_t fired = 0;
+        while (cursor.position < entries.size() && entries[cursor.position].time <= toTime) {
+            fire(static_cast<size_t>(entries[cursor.position].index));
+            ++cursor.position;
+            ++fired;
+        }
+        // Backwards range: nothing fired, re-seek next time.
+        if (toTime < fromTime) Seek(cursor, toTime);
+        cursor.time = toTime;
+        return fired;
+    }
+
+    // Places the cursor on the first entry strictly after time.
+    void Seek(Cursor& cursor, float time) const;
+
+private:
+    static bool Before(const Entry& a, const Entry& b)
+    {
+        return a.time < b.time || (a.time == b.time && a.index < b.index);
+    }
+
+    // Unique across all schedules (never 0).
+    static uint64_t NextVersion();
+
+    std::vector<Entry> entries;
+    uint64_t version = NextVersion();
+};
@@ -0,0 +1,218 @@
+#include "OccupancyPredictor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <unordered_map>
+
+#include "Scene.h"
+#include "../fireworks/template/TemplateLibrary.h"
+
+namespace {
+
+// Second-order difference array sampled at t = i * bin.
+class RampAccumulator {
+public:
+    RampAccumulator(size_t bins, float binSeconds)
+        : d2(bins + 2, 0.0)
+        , bin(binSeconds)
+    {
+    }
+
+    // value(t) += height for t >= at
+    void Step(float at, double height)
+    {
+        const size_t b = FirstBin(at);
+        if (b >= d2.size() - 1) return;
+        d2[b] += height;
+        d2[b + 1] -= height;
+    }
+
+    // value(t) += slope * (t - at) for t >= at
+    void Ramp(float at, double slope)
+    {
+        const size_t b = FirstBin(at);
+        if (b >= d2.size() - 1) return;
+        // Slope per bin, plus a one-off step so samples are exact at the bin times.
+        const double perBin = slope * static_cast<double>(bin);
+        const double offset = slope * (static_cast<double>(b) * bin - at) - perBin;
+        d2[b] += perBin + offset;
+        d2[b + 1] -= offset;
+    }
+
+    void Integrate(std::vector<float>& out) const
+    {
+        out.resize(d2.size() - 2);
+        double slope = 0.0;
+        double value = 0.0;
+        for (size_t i = 0; i < out.size(); ++i) {
+            slope += d2[i];
+            value += slope;
+            out[i] = static_cast<float>(std::max(0.0, value));
+        }
+    }
+
+private:
+    size_t FirstBin(float t) const
+    {
+        if (t <= 0.0f) return 0;
+        return static_cast<size_t>(std::ceil(t / bin));
+    }
+
+    std::vector<double> d2;
+    float bin;
+};
+
+} // namespace
+
+OccupancyPredictor::OccupancyPredictor(float bin)
+    : binSeconds(bin > 0.0f ? bin : 1.0f / 30.0f)
+{
+}
+
+void OccupancyPredictor::BuildWaves(const FireworkTemplate& t, std::vector<Wave>& out)
+{
+    out.clear();
+
+    const BranchDescriptor& d = t.branchTemplate;
+    const int perBranch = std::max(0, d.particlesPerBranch);
+    const float count = static_cast<float>(t.GetBranchCount()) * static_cast<float>(perBranch);
+    const float life = std::max(0.0f, d.lifetime);
+    if (count <= 0.0f || life <= 0.0f) return;
+
+    // Same pacing as EmissionRecipe: one spawn per interval, interval >= 1/240 s.
+    float spread = 0.0f;
+    if (d.emissionDuration > 0.0f && perBranch > 0) {
+        spread = std::max(1.0f / 240.0f, d.emissionDuration / static_cast<float>(perBranch)) * static_cast<float>(perBranch);
+    }
+
+    Wave primary;
+    primary.count = count;
+    primary.spread = spread;
+    primary.life = life;
+    out.push_back(primary);
+
+    // Death effects, following ParticlePool::Update.
+    const float smoke = std::max(0.0f, std::min(1.0f, d.smokeAmount));
+    if (smoke > 0.0f) {
+        Wave w;
+        w.count = count * static_cast<float>(static_cast<int>(3 + 12 * smoke));
+        w.start = life;
+        w.spread = spread;
+        w.life = 0.8f + 1.6f * smoke;
+        out.push_back(w);
+    }
+
+    const float prob = std::max(0.0f, std::min(1.0f, d.recursionProb));
+    const int depth = std::max(0, std::min(255, d.recursionDepth));
+    float level = count;
+    float start = life;
+    for (int k = 0; k < depth && prob > 0.0f; ++k) {
+        level *= t.GetParticleCost().childrenPerBurst * prob; // bursts fire with probability prob
+        if (level < 0.5f) break;
+        Wave w;
+        w.count = level;
+        w.start = start;
+        w.spread = spread;
+        w.life = 0.6f;
+        out.push_back(w);
+        start += w.life;
+    }
+}
+
+float OccupancyPredictor::ActiveSeconds(const FireworkTemplate& t)
+{
+    std::vector<Wave> waves;
+    BuildWaves(t, waves);
+    float end = 0.0f;
+    for (const Wave& w : waves) end = std::max(end, w.start + w.spread + w.life);
+    return end;
+}
+
+OccupancyPredictor::Result OccupancyPredictor::Analyze(const Scene& scene, const TemplateLibrary& library, size_t poolCapacity) const
+{
+    const auto startClock = std::chrono::steady_clock::now();
+
+    Result r;
+    r.binSeconds = binSeconds;
+    r.capacity = poolCapacity;
+
+    // Waves per template, built once however many events use it.
+    std::unordered_map<int, std::vector<Wave>> waves;
+    float end = std::max(0.0f, scene.GetDuration());
+    for (const auto& e : scene.GetEvents()) {
+        if (!e.enabled) continue;
+        auto it = waves.find(e.templateId);
+        if (it == waves.end()) {
+            it = waves.emplace(e.templateId, std::vector<Wave>()).first;
+            if (const FireworkTemplate* t = library.Get(e.templateId)) BuildWaves(*t, it->second);
+        }
+        for (const Wave& w : it->second) {
+            end = std::max(end, e.triggerTime + w.start + w.spread + w.life);
+        }
+    }
+
+    const size_t bins = static_cast<size_t>(std::ceil(end / binSeconds)) + 1;
+    RampAccumulator acc(bins, binSeconds);
+
+    for (const auto& e : scene.GetEvents()) {
+        if (!e.enabled) continue;
+        // Waves are per template; the event's override only thins them.
+        const float share = std::clamp(e.overrides.countScale, 0.0f, 1.0f);
+        for (const Wave& w : waves[e.templateId]) {
+            const float t0 = std::max(0.0f, e.triggerTime) + w.start;
+            const float count = w.count * share;
+            if (w.spread <= 0.0f) {
+                acc.Step(t0, count);
+                acc.Step(t0 + w.life, -count);
+                continue;
+            }
+            // Emitted at rate count / spread during [t0, t0 + spread], each lives `life`.
+            const double rate = static_cast<double>(count) / w.spread;
+            acc.Ramp(t0, rate);
+            acc.Ramp(t0 + w.spread, -rate);
+            acc.Ramp(t0 + w.life, -rate);
+            acc.Ramp(t0 + w.spread + w.life, rate);
+        }
+    }
+    acc.Integrate(r.occupancy);
+
+    // Global peak + notable local maxima (plateaus count once).
+    for (size_t i = 0; i < r.occupancy.size(); ++i) {
+        if (r.occupancy[i] > r.peakParticles) {
+            r.peakParticles = r.occupancy[i];
+            r.peakTime = static_cast<float>(i) * binSeconds;
+        }
+    }
+    const float threshold = r.peakParticles * kPeakFraction;
+    for (size_t i = 0; i < r.occupancy.size() && r.peakParticles > 0.0f; ++i) {
+        const float v = r.occupancy[i];
+        if (v < threshold) continue;
+        const float prev = (i > 0) ? r.occupancy[i - 1] : 0.0f;
+        if (v <= prev) continue;
+        size_t j = i;
+        while (j + 1 < r.occupancy.size() && r.occupancy[j + 1] == v) ++j;
+        const float next = (j + 1 < r.occupancy.size()) ? r.occupancy[j + 1] : 0.0f;
+        if (v > next) {
+            Peak p;
+            p.time = static_cast<float>(i + j) * 0.5f * binSeconds;
+            p.particles = v;
+            r.peaks.push_back(p);
+        }
+        i = j;
+    }
+    if (r.peaks.size() > kMaxPeaks) {
+        std::partial_sort(r.peaks.begin(), r.peaks.begin() + kMaxPeaks, r.peaks.end(),
+            [](const Peak& a, const Peak& b) { return a.particles > b.particles; });
+        r.peaks.resize(kMaxPeaks);
+        std::sort(r.peaks.begin(), r.peaks.end(), [](const Peak& a, const Peak& b) { return a.time < b.time; });
+    }
+
+    const double wanted = std::ceil(static_cast<double>(r.peakParticles) * (1.0 + kCapacityMargin));
+    const size_t blocks = (static_cast<size_t>(wanted) + kCapacityGranularity - 1) / kCapacityGranularity;
+    r.suggestedCapacity = std::max<size_t>(1, blocks) * kCapacityGranularity;
+    r.exceedsCapacity = poolCapacity > 0 && r.peakParticles > static_cast<float>(poolCapacity);
+
+    r.analyzeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startClock).count();
+    return r;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Scene;
+class FireworkTemplate;
+class TemplateLibrary;
+
+// Estimates the live particle count over a whole show without simulating it.
+//
+// Each template is reduced to a few "waves" (primary emission, smoke, one per recursion
+// level): a count emitted evenly over a spread, each particle living a fixed time. The
+// occupancy of a wave is piecewise linear, i.e. a sum of four ramps (or two steps for a
+// burst), so every event only writes a handful of entries into a second-order difference
+// array. Integrating it twice gives the curve: O(events + bins), milliseconds even for
+// tens of thousands of events.
+//
+// Smoke and recursion use their expected counts (pool death-effect rules), so the curve is
+// an average, not a bound: the ParticleBudget still handles the occasional overshoot.
+class OccupancyPredictor {
+public:
+    struct Peak {
+        float time = 0.0f;       // seconds
+        float particles = 0.0f;  // expected live particles
+    };
+
+    struct Result {
+        float binSeconds = 0.0f;
+        std::vector<float> occupancy; // expected live particles at t = i * binSeconds
+        float peakParticles = 0.0f;
+        float peakTime = 0.0f;
+        std::vector<Peak> peaks;      // notable local maxima, by time
+        size_t capacity = 0;          // pool capacity the curve was checked against
+        size_t suggestedCapacity = 0; // peak + margin, rounded up
+        bool exceedsCapacity = false;
+        double analyzeMs = 0.0;
+    };
+
+    // Local maxima under this share of the global peak are not reported.
+    static constexpr float kPeakFraction = 0.6f;
+    static constexpr size_t kMaxPeaks = 8;
+    // Suggested capacity = peak * (1 + margin), rounded up to kCapacityGranularity.
+    static constexpr float kCapacityMargin = 0.2f;
+    static constexpr size_t kCapacityGranularity = 1024;
+
+    explicit OccupancyPredictor(float binSeconds = 1.0f / 30.0f);
+
+    Result Analyze(const Scene& scene, const TemplateLibrary& library, size_t poolCapacity) const;
+
+    // Seconds from trigger until the template's last expected particle dies (0 if it emits nothing).
+    static float ActiveSeconds(const FireworkTemplate& t);
+
+private:
+    struct Wave {
+        float count = 0.0f;  // particles
+        float start = 0.0f;  // seconds after trigger
+        float spread = 0.0f; // emission duration (0 = burst)
+        float life = 0.0f;   // seconds
+    };
+
+    static void BuildWaves(const FireworkTemplate& t, std::vector<Wave>& out);
+
+    float binSeconds;
+};
@@ -1,21 +1,48 @@
 #include "Scene.h"
 
+#include <atomic>
+
+namespace {
+
+uint64_t NextEditVersion()
+{
+    static std::atomic<uint64_t> counter{ 0 };
+    return ++counter;
+}
+
+} // namespace
+
 Scene::Scene(std::string n)
     : name(std::move(n))
     , durationSeconds(10.0f)
+    , nextEventId(1)
+    , editVersion(NextEditVersion())
+    , stateEditsComplete(false)
 {
 }
 
 void Scene::SetDuration(float seconds)
 {
-    durationSeconds = (seconds < 0.0f) ? 0.0f : seconds;
+    const float d = (seconds < 0.0f) ? 0.0f : seconds;
+    if (d == durationSeconds) return; // set every frame by the timeline slider
+    durationSeconds = d;
+    MarkEdited();
+}
+
+void Scene::MarkEdited()
+{
+    editVersion = NextEditVersion();
 }
 
 size_t Scene::AddEvent(const FireworkEvent& e)
 {
+    GetSchedule(); // bring it up to date before the incremental insert
     events.push_back(e);
-    SortByTime();
-    return events.size() - 1;
+    const size_t index = events.size() - 1;
+    events[index].id = nextEventId++; // a new event, even when e was copied from another one
+    schedule.Insert(static_cast<uint32_t>(index), events[index].triggerTime);
+    MarkEdited();
+    return index;
 }
 
 void Scene::RemoveEvent(size_t index)
@@ -23,7 +50,29 @@ void Scene::RemoveEvent(size_t index)
     if (index >= events.size()) {
         return;
     }
+    GetSchedule();
+    // Removals are always journaled: their instances must go even after an overflow.
+    StateEdit edit;
+    edit.id = events[index].id;
+    edit.removed = true;
+    stateEdits.push_back(edit);
+
+    const bool removed = schedule.Remove(static_cast<uint32_t>(index), events[index].triggerTime);
     events.erase(events.begin() + static_cast<long>(index));
+    if (!removed) schedule.Rebuild(events); // a time was edited behind our back
+    MarkEdited();
+}
+
+void Scene::SetEventTime(size_t index, float seconds)
+{
+    if (index >= events.size()) {
+        return;
+    }
+    GetSchedule();
+    const float old = events[index].triggerTime;
+    events[index].triggerTime = seconds;
+    if (!schedule.Move(static_cast<uint32_t>(index), old, seconds)) schedule.Rebuild(events);
+    MarkEdited();
 }
 
 void Scene::SortByTime()
@@ -31,4 +80,52 @@ void Scene::SortByTime()
     std::stable_sort(events.begin(), events.end(), [](const FireworkEvent& a, const FireworkEvent& b) {
         return a.triggerTime < b.triggerTime;
     });
+    schedule.Rebuild(events);
+    MarkEdited();
+}
+
+const EventSchedule& Scene::GetSchedule() const
+{
+    if (schedule.Size() != events.size()) schedule.Rebuild(events);
+    return schedule;
+}
+
+void Scene::AssignEventIds()
+{
+    for (const auto& e : events) {
+        if (e.id >= nextEventId) nextEventId = e.id + 1;
+    }
+    for (auto& e : events) {
+        if (e.id == 0) e.id = nextEventId++;
+    }
+}
+
+void Scene::MarkEventStateEdited(size_t index)
+{
+    if (index >= events.size()) return;
+    MarkEdited();
+    if (!stateEditsComplete) return;
+    if (stateEdits.size() >= kMaxStateEdits) {
+        stateEditsComplete = false;
+        stateEdits.erase(std::remove_if(stateEdits.begin(), stateEdits.end(),
+                                        [](const StateEdit& e) { return !e.removed; }),
+                         stateEdits.end());
+        return;
+    }
+    const FireworkEvent& e = events[index];
+    StateEdit edit;
+    edit.id = e.id;
+    edit.enabled = e.enabled;
+    edit.muted = e.muted;
+    edit.solo = e.solo;
+    stateEdits.push_back(edit);
+}
+
+bool Scene::TakeStateEdits(std::vector<StateEdit>& out)
+{
+    out.clear();
+    out.swap(stateEdits);
+    const bool complete = stateEditsComplete;
+    stateEditsComplete = true;
+    return complete;
 }
@@ -1,11 +1,15 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
 #include <string>
 #include <vector>
 
 #include <glm/glm.hpp>
 
+#include "EventSchedule.h"
+#include "../fireworks/template/TemplateOverride.h"
+
 // A Scene is an orchestration of firework triggers over time.
 // It is intentionally decoupled from template authoring.
 
@@ -15,6 +19,20 @@ struct FireworkEvent {
     float triggerTime = 0.0f; // seconds on the timeline
     bool enabled = true;
     std::string label;
+
+    // Per-event settings applied at emission time: events share their template (a 2000-cue
+    // show of 10 shells holds 10 templates) and only differ by this small record.
+    TemplateOverride overrides;
+
+    // Identifiant stable (survit aux tris / suppressions), attribué par la Scene.
+    // Les instances lancées par cet événement le portent : l'éditeur peut les tuer ou les
+    // masquer pendant la lecture. 0 = pas encore attribué.
+    uint32_t id = 0;
+
+    // État d'écoute de l'éditeur (non sérialisé). Dès qu'un événement est en solo, seuls
+    // les événements en solo sont rendus.
+    bool muted = false;
+    bool solo = false;
 };
 
 class Scene {
@@ -31,13 +49,55 @@ public:
     const std::vector<FireworkEvent>& GetEvents() const { return events; }
     std::vector<FireworkEvent>& GetEvents() { return events; }
 
-    // Returns index in the internal array.
+    // Returns index in the internal array. Events keep their insertion order (indices stay
+    // valid for the UI); playback reads them in time order through GetSchedule().
     size_t AddEvent(const FireworkEvent& e);
     void RemoveEvent(size_t index);
+    // Moves one event on the timeline and keeps the schedule sorted.
+    void SetEventTime(size_t index, float seconds);
+    // Reorders the event array itself (explicit user action, or after loading).
     void SortByTime();
 
+    // Time-sorted view used by playback. Rebuilt lazily when events were added or removed
+    // through GetEvents(); trigger times must be edited with SetEventTime() to be seen.
+    const EventSchedule& GetSchedule() const;
+
+    // Gives an id to events pushed directly through GetEvents() (e.g. by the loader); scans
+    // every event, AddEvent() does not need it.
+    void AssignEventIds();
+
+    // Changes on every edit of the scene: caches derived from the events (occupancy,
+    // lifetimes) compare it instead of rescanning them. Unique across scenes, so a loaded
+    // scene assigned over this one is never mistaken for it. Fields written through
+    // GetEvents() must be reported with MarkEdited() (or MarkEventStateEdited()).
+    uint64_t GetEditVersion() const { return editVersion; }
+    void MarkEdited();
+
+    // Enabled / muted / solo changes and removals, journaled for the instances already in
+    // flight (playback reads them instead of diffing every event each frame).
+    struct StateEdit {
+        uint32_t id = 0;
+        bool removed = false;
+        bool enabled = true;
+        bool muted = false;
+        bool solo = false;
+    };
+    // Beyond this many pending state edits the journal only keeps removals.
+    static constexpr size_t kMaxStateEdits = 4096;
+
+    // Records the current enabled / muted / solo state of one event edited through GetEvents().
+    void MarkEventStateEdited(size_t index);
+    // Moves the pending edits into out, oldest first. Returns false when state edits were
+    // dropped (new or loaded scene, journal overflow): every event must be rescanned.
+    bool TakeStateEdits(std::vector<StateEdit>& out);
+
 private:
     std::string name;
     float durationSeconds;
     std::vector<FireworkEvent> events;
+    uint32_t nextEventId;
+    mutable EventSchedule schedule;
+    uint64_t editVersion;
+    std::vector<StateEdit> stateEdits;
+    bool stateEditsComplete; // false until the first TakeStateEdits()
 };
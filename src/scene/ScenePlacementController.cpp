@@ -63,6 +63,7 @@ void ScenePlacementController::OnCursorPos(GLFWwindow* window, double x, double
 
     // Keep the event on the ground plane. If you later want full 3D placement, change this.
     events[draggedEvent].position = glm::vec3(hit.x, 0.0f, hit.z);
+    scene.MarkEdited();
 }
 
 int ScenePlacementController::pickEvent(GLFWwindow* window, double mx, double my) const
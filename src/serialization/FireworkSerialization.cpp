@@ -3,6 +3,7 @@
 #include <fstream>
 #include <iomanip>
 #include <memory>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -14,8 +15,8 @@
 
 namespace {
 
-constexpr int kAssetVersion = 1;
-constexpr int kSceneVersion = 1;
+constexpr int kAssetVersion = 2; // 2: branch_budget
+constexpr int kSceneVersion = 2; // 2: per-event overrides
 
 void WriteVec3(std::ostream& out, const glm::vec3& v) {
     out << v.x << ' ' << v.y << ' ' << v.z;
@@ -39,6 +40,72 @@ bool Expect(std::istream& in, const char* token) {
     return t == token;
 }
 
+// Everything but the name: the .fwasset template block, also hashed by HashTemplateContent().
+void WriteTemplateParameters(std::ostream& out, const ::FireworkTemplate& t) {
+    out << "t_zoneAzimuth " << t.zoneAzimuthMin << ' ' << t.zoneAzimuthMax << '\n';
+    out << "t_zoneElevation " << t.zoneElevationMin << ' ' << t.zoneElevationMax << '\n';
+    out << "t_worldRotation ";
+    WriteVec3(out, t.worldRotation);
+    out << '\n';
+
+    // PhysicsProfile
+    out << "phys "
+        << t.physics.gravity << ' '
+        << t.physics.gravityCurve << ' '
+        << t.physics.dragCoefficient << ' '
+        << t.physics.turbulenceStrength << ' '
+        << t.physics.turbulenceFrequency << ' '
+        << t.physics.maxSpeed << ' '
+        << t.physics.maxLifetime << '\n';
+
+    // BranchLayout
+    out << "layout "
+        << t.layout.gridX << ' '
+        << t.layout.gridY << ' '
+        << t.layout.constraintAzimuthMin << ' '
+        << t.layout.constraintAzimuthMax << ' '
+        << t.layout.constraintElevationMin << ' '
+        << t.layout.constraintElevationMax << ' '
+        << (t.layout.staggered ? 1 : 0) << ' '
+        << t.layout.randomness << '\n';
+
+    // ColorScheme
+    out << "colorscheme " << static_cast<int>(t.colorScheme.type) << '\n';
+    out << "cs_uniform "; WriteVec4(out, t.colorScheme.uniformColor); out << '\n';
+    out << "cs_gradientStart "; WriteVec4(out, t.colorScheme.gradientStart); out << '\n';
+    out << "cs_gradientEnd "; WriteVec4(out, t.colorScheme.gradientEnd); out << '\n';
+    out << "cs_palette " << t.colorScheme.palette.size();
+    for (const auto& c : t.colorScheme.palette) {
+        out << ' ' << c.x << ' ' << c.y << ' ' << c.z << ' ' << c.w;
+    }
+    out << '\n';
+    out << "cs_variance " << t.colorScheme.saturationVariance << ' ' << t.colorScheme.brightnessVariance << '\n';
+    out << "cs_fade " << (t.colorScheme.fadeOverTime ? 1 : 0) << ' ' << t.colorScheme.fadeStartRatio << '\n';
+
+    // BranchDescriptor
+    const auto& b = t.branchTemplate;
+    out << "branch "
+        << b.initialSpeed << ' ' << b.speedVariance << ' '
+        << b.damping << ' ' << b.dampingVariance << ' '
+        << b.gravityScale << ' ' << b.updraft << ' '
+        << b.angularSpread << ' '
+        << b.particlesPerBranch << ' '
+        << b.emissionDuration << ' '
+        << b.particleSize << ' ' << b.sizeVariance << ' '
+        << b.lifetime << ' '
+        << b.shapeId << ' '
+        << static_cast<int>(b.visualMode) << ' '
+        << (b.trailEnabled ? 1 : 0) << ' '
+        << b.trailWidth << ' ' << b.trailDuration << ' ' << b.trailOpacity << ' ' << b.trailFalloffPow << ' '
+        << b.frontPortion << ' ' << b.frontSpeedBias << ' ' << b.backSpeedScale << ' '
+        << b.sparkleSpeedJitter << ' ' << b.sparkleSpreadMult << ' '
+        << b.smokeAmount << ' '
+        << b.recursionDepth << ' ' << b.recursionProb << ' '
+        << (b.shouldFade ? 1 : 0) << ' ' << b.fadeStartRatio
+        << '\n';
+    out << "branch_budget " << b.recursionBudget << '\n';
+}
+
 } // namespace
 
 namespace serialization {
@@ -72,69 +139,23 @@ bool SaveFireworkAsset(const fireworks::FireworkAsset& asset, const std::string&
     out << "template_present 1\n";
     out << "t_name " << std::quoted(t->name) << '\n';
 
-    out << "t_zoneAzimuth " << t->zoneAzimuthMin << ' ' << t->zoneAzimuthMax << '\n';
-    out << "t_zoneElevation " << t->zoneElevationMin << ' ' << t->zoneElevationMax << '\n';
-    out << "t_worldRotation ";
-    WriteVec3(out, t->worldRotation);
-    out << '\n';
+    WriteTemplateParameters(out, *t);
 
-    // PhysicsProfile
-    out << "phys "
-        << t->physics.gravity << ' '
-        << t->physics.gravityCurve << ' '
-        << t->physics.dragCoefficient << ' '
-        << t->physics.turbulenceStrength << ' '
-        << t->physics.turbulenceFrequency << ' '
-        << t->physics.maxSpeed << ' '
-        << t->physics.maxLifetime << '\n';
+    return true;
+}
 
-    // BranchLayout
-    out << "layout "
-        << t->layout.gridX << ' '
-        << t->layout.gridY << ' '
-        << t->layout.constraintAzimuthMin << ' '
-        << t->layout.constraintAzimuthMax << ' '
-        << t->layout.constraintElevationMin << ' '
-        << t->layout.constraintElevationMax << ' '
-        << (t->layout.staggered ? 1 : 0) << ' '
-        << t->layout.randomness << '\n';
+uint64_t HashTemplateContent(const ::FireworkTemplate& t) {
+    // Hex floats: every bit of every parameter counts, whatever the stream precision.
+    std::ostringstream out;
+    out << std::hexfloat;
+    WriteTemplateParameters(out, t);
 
-    // ColorScheme
-    out << "colorscheme " << static_cast<int>(t->colorScheme.type) << '\n';
-    out << "cs_uniform "; WriteVec4(out, t->colorScheme.uniformColor); out << '\n';
-    out << "cs_gradientStart "; WriteVec4(out, t->colorScheme.gradientStart); out << '\n';
-    out << "cs_gradientEnd "; WriteVec4(out, t->colorScheme.gradientEnd); out << '\n';
-    out << "cs_palette " << t->colorScheme.palette.size();
-    for (const auto& c : t->colorScheme.palette) {
-        out << ' ' << c.x << ' ' << c.y << ' ' << c.z << ' ' << c.w;
+    uint64_t h = 1469598103934665603ULL; // FNV-1a
+    for (const char c : out.str()) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ULL;
     }
-    out << '\n';
-    out << "cs_variance " << t->colorScheme.saturationVariance << ' ' << t->colorScheme.brightnessVariance << '\n';
-    out << "cs_fade " << (t->colorScheme.fadeOverTime ? 1 : 0) << ' ' << t->colorScheme.fadeStartRatio << '\n';
-
-    // BranchDescriptor
-    const auto& b = t->branchTemplate;
-    out << "branch "
-        << b.initialSpeed << ' ' << b.speedVariance << ' '
-        << b.damping << ' ' << b.dampingVariance << ' '
-        << b.gravityScale << ' ' << b.updraft << ' '
-        << b.angularSpread << ' '
-        << b.particlesPerBranch << ' '
-        << b.emissionDuration << ' '
-        << b.particleSize << ' ' << b.sizeVariance << ' '
-        << b.lifetime << ' '
-        << b.shapeId << ' '
-        << static_cast<int>(b.visualMode) << ' '
-        << (b.trailEnabled ? 1 : 0) << ' '
-        << b.trailWidth << ' ' << b.trailDuration << ' ' << b.trailOpacity << ' ' << b.trailFalloffPow << ' '
-        << b.frontPortion << ' ' << b.frontSpeedBias << ' ' << b.backSpeedScale << ' '
-        << b.sparkleSpeedJitter << ' ' << b.sparkleSpreadMult << ' '
-        << b.smokeAmount << ' '
-        << b.recursionDepth << ' ' << b.recursionProb << ' '
-        << (b.shouldFade ? 1 : 0) << ' ' << b.fadeStartRatio
-        << '\n';
-
-    return true;
+    return h;
 }
 
 std::shared_ptr<fireworks::FireworkAsset> LoadFireworkAsset(const std::string& path) {
@@ -261,6 +282,10 @@ std::shared_ptr<fireworks::FireworkAsset> LoadFireworkAsset(const std::string& p
         b.trailEnabled = (trailEnabled != 0);
         b.shouldFade = (shouldFade != 0);
 
+        if (version >= 2) {
+            if (!Expect(in, "branch_budget") || !(in >> b.recursionBudget)) return nullptr;
+        }
+
         // Derived data.
         t->RegenerateBranches();
     }
@@ -285,7 +310,13 @@ bool SaveScene(const Scene& scene, const std::string& path) {
         out << ' '
             << e.triggerTime << ' '
             << (e.enabled ? 1 : 0) << ' '
-            << std::quoted(e.label)
+            << std::quoted(e.label) << ' ';
+        WriteVec3(out, e.overrides.rotation);
+        out << ' ';
+        WriteVec4(out, e.overrides.tint);
+        out << ' '
+            << e.overrides.scale << ' '
+            << e.overrides.countScale
             << '\n';
     }
     return true;
@@ -323,9 +354,15 @@ std::shared_ptr<Scene> LoadScene(const std::string& path) {
         if (!ReadVec3(in, e.position)) return nullptr;
         if (!(in >> e.triggerTime >> enabled >> std::quoted(e.label))) return nullptr;
         e.enabled = (enabled != 0);
+        if (version >= 2) {
+            if (!ReadVec3(in, e.overrides.rotation)) return nullptr;
+            if (!ReadVec4(in, e.overrides.tint)) return nullptr;
+            if (!(in >> e.overrides.scale >> e.overrides.countScale)) return nullptr;
+        }
         ev.push_back(std::move(e));
     }
 
+    scene->AssignEventIds();
     scene->SortByTime();
     return scene;
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -23,6 +24,10 @@ bool SaveFireworkAsset(const fireworks::FireworkAsset& asset, const std::string&
 // Returns nullptr on failure.
 std::shared_ptr<fireworks::FireworkAsset> LoadFireworkAsset(const std::string& path);
 
+// Stable hash of a template's saved parameters (name excluded): equal for two templates
+// that would simulate the same, across sessions.
+uint64_t HashTemplateContent(const FireworkTemplate& t);
+
 // -----------------------------
 // Scenes (timeline + events)
 // -----------------------------
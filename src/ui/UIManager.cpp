@@ -1,6 +1,9 @@
 #include "UIManager.h"
 
+#include <algorithm>
+
 #include <imgui.h>
+#include <imgui_internal.h>
 
 #include "src/ui/subsystems/ImGuiLayer.h"
 #include "src/ui/subsystems/FileController.h"
@@ -25,6 +28,8 @@ UIManager::UIManager()
     : window(nullptr)
     , initialized(false)
     , showDemoWindow(false)
+    , showProfiler(false)
+    , showOverdraw(false)
     , mode(EditorMode::Template)
 {
 }
@@ -104,10 +109,16 @@ void UIManager::NewFrame()
 }
 
 void UIManager::Render()
+{
+    BuildFrame();
+    DrawFrame();
+}
+
+void UIManager::BuildFrame()
 {
     if (!initialized) return;
 
-    if (menubar) menubar->Render(mode, &showDemoWindow);
+    if (menubar) menubar->Render(mode, &showDemoWindow, &showProfiler, &showOverdraw);
 
     // Important: must run after the menu bar is done.
     if (files) files->UpdateDeferredOpen();
@@ -116,10 +127,28 @@ void UIManager::Render()
     if (panels) panels->Render(mode);
 
     if (showDemoWindow) ImGui::ShowDemoWindow(&showDemoWindow);
+}
+
+void UIManager::DrawFrame()
+{
+    if (!initialized) return;
 
     if (imgui) imgui->RenderDrawData();
 }
 
+bool UIManager::WantsContinuousRedraw() const
+{
+    if (!initialized) return false;
+    return ImGui::IsAnyItemActive() || ImGui::GetIO().WantTextInput;
+}
+
+bool UIManager::HasPendingInput() const
+{
+    if (!initialized) return false;
+    const ImGuiContext* ctx = ImGui::GetCurrentContext();
+    return ctx && !ctx->InputEventsQueue.empty();
+}
+
 void UIManager::CreateTemplatePanels(TemplateLibrary* library)
 {
     templateLibraryCtx = library;
@@ -129,6 +158,11 @@ void UIManager::CreateTemplatePanels(TemplateLibrary* library)
     }
 }
 
+void UIManager::SetPoolCapacity(size_t capacity)
+{
+    if (panels) panels->SetPoolCapacity(capacity);
+}
+
 void UIManager::CreateScenePanels(Scene* scene, Timeline* timeline, TemplateLibrary* library)
 {
     sceneCtx = scene;
@@ -194,8 +228,25 @@ void UIManager::EditTemplateForSceneEvent(int sceneEventIndex)
     auto& events = sceneCtx->GetEvents();
     if (sceneEventIndex < 0 || sceneEventIndex >= static_cast<int>(events.size())) return;
 
-    int tmplId = events[sceneEventIndex].templateId;
-    if (tmplId >= 0) {
+    // Copy-on-write: nothing is copied yet. A template shared with other events (or a
+    // library template) is only copied if the user actually edits it, see
+    // ApplyTemplateCopyOnWrite(). An event's private copy is edited in place.
+    const FireworkEvent& e = events[static_cast<size_t>(sceneEventIndex)];
+    cowEventId = 0;
+    cowTemplateId = -1;
+    cowOriginal.reset();
+
+    const int tmplId = e.templateId;
+    if (const FireworkTemplate* t = templateLibraryCtx->Get(tmplId)) {
+        const bool shared = !templateLibraryCtx->IsEventCopy(tmplId)
+            || std::any_of(events.begin(), events.end(), [&](const FireworkEvent& o) {
+                   return o.id != e.id && o.templateId == tmplId;
+               });
+        if (shared) {
+            cowEventId = e.id;
+            cowTemplateId = tmplId;
+            cowOriginal = std::make_unique<FireworkTemplate>(*t);
+        }
         templateLibraryCtx->SetActiveId(tmplId);
         if (panels) panels->RefreshTemplatePanelsFromActive();
     }
@@ -203,6 +254,41 @@ void UIManager::EditTemplateForSceneEvent(int sceneEventIndex)
     SetMode(EditorMode::Template);
 }
 
+void UIManager::ApplyTemplateCopyOnWrite()
+{
+    if (!cowOriginal) return;
+    if (!templateLibraryCtx || !sceneCtx || templateLibraryCtx->GetActiveId() != cowTemplateId) {
+        // The user moved on without editing: nothing to copy.
+        cowOriginal.reset();
+        return;
+    }
+
+    FireworkTemplate* shared = templateLibraryCtx->Get(cowTemplateId);
+    if (!shared) {
+        cowOriginal.reset();
+        return;
+    }
+    if (!shared->IsDirty()) return;
+
+    // First edit: the edited state becomes the event's copy (still dirty, rebuilt by
+    // UpdateDirtyBranches), the shared template goes back to what it was.
+    auto& events = sceneCtx->GetEvents();
+    auto it = std::find_if(events.begin(), events.end(), [this](const FireworkEvent& o) { return o.id == cowEventId; });
+    if (it != events.end()) {
+        const int copy = templateLibraryCtx->Clone(cowTemplateId, true);
+        if (copy >= 0) {
+            *shared = *cowOriginal;
+            it->templateId = copy;
+            sceneCtx->MarkEdited();
+            templateLibraryCtx->SetActiveId(copy);
+            if (panels) panels->RefreshTemplatePanelsFromActive();
+        }
+    }
+    cowEventId = 0;
+    cowTemplateId = -1;
+    cowOriginal.reset();
+}
+
 void UIManager::PerformFileAction(FileAction action, const std::string& path)
 {
     if (action == FileAction::SaveTemplate) {
@@ -2,6 +2,7 @@
 
 #include <GLFW/glfw3.h>
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -55,16 +56,34 @@ public:
     void Shutdown();
 
     void NewFrame();
-    void Render();
+    void Render(); // BuildFrame() + DrawFrame()
+
+    // Split for the pipelined main loop: BuildFrame() runs the widgets (and therefore every
+    // edit they make) while the simulation thread is idle; DrawFrame() only submits draw data.
+    void BuildFrame();
+    void DrawFrame();
 
     // Panel creation
     void CreateTemplatePanels(class TemplateLibrary* library);
     void CreateScenePanels(class Scene* scene, class Timeline* timeline, class TemplateLibrary* library);
 
+    // Particle pool capacity, checked against the scene's predicted occupancy.
+    void SetPoolCapacity(size_t capacity);
+
     // Mode
     void SetMode(EditorMode m) { mode = m; }
     EditorMode GetMode() const { return mode; }
 
+    // Debug views toggled from the View menu (drawn by Application).
+    bool* GetShowProfilerFlag() { return &showProfiler; }
+    bool* GetShowOverdrawFlag() { return &showOverdraw; }
+
+    // On-demand rendering hints (Application sleeps when nothing changes).
+    // True while a widget is being dragged/edited: the UI must keep redrawing.
+    bool WantsContinuousRedraw() const;
+    // True when ImGui has queued input (keys, chars, ...) not yet consumed by a frame.
+    bool HasPendingInput() const;
+
     // Getters
     ui::panels::TemplatePropertiesPanel* GetTemplatePanel() const;
     ui::panels::LayoutEditorPanel* GetLayoutPanel() const;
@@ -83,6 +102,11 @@ public:
     // Convenience: switch to template editor and focus the template used by a scene event.
     void EditTemplateForSceneEvent(int sceneEventIndex);
 
+    // Copy-on-write of a template opened through EditTemplateForSceneEvent(): on its first
+    // edit (MarkDirty), the edit moves to a private copy for that event and the shared
+    // template is restored. Call once per frame, before TemplateLibrary::UpdateDirtyBranches().
+    void ApplyTemplateCopyOnWrite();
+
 private:
     // Called by subsystems
     void PerformFileAction(FileAction action, const std::string& path);
@@ -94,10 +118,18 @@ private:
     class Scene* sceneCtx = nullptr;
     class Timeline* timelineCtx = nullptr;
 
+    // Pending copy-on-write (see ApplyTemplateCopyOnWrite): pre-edit state of the shared
+    // template, dropped as soon as the user edits or leaves it.
+    uint32_t cowEventId = 0;
+    int cowTemplateId = -1;
+    std::unique_ptr<FireworkTemplate> cowOriginal;
+
     bool initialized;
 
     // UI state
     bool showDemoWindow;
+    bool showProfiler;
+    bool showOverdraw;
     EditorMode mode;
 
     // UI subsystems
@@ -30,11 +30,11 @@ void FireworkListPanel::Render()
 
     if (ImGui::Button("+")) {
         FireworkEvent e;
-        // Each scene event should be editable independently.
-        // So we clone the currently active template instead of referencing it directly.
+        // Events reference the active template; per-event tweaks go through e.overrides and a
+        // private copy is only made when the template itself is edited for this event
+        // (UIManager::EditTemplateForSceneEvent).
         if (library) {
-            int active = library->GetActiveId();
-            e.templateId = (active >= 0) ? library->Clone(active) : -1;
+            e.templateId = library->GetActiveId();
         } else {
             e.templateId = -1;
         }
@@ -31,10 +31,19 @@ void SceneViewPanel::Render()
     auto& e = events[static_cast<size_t>(selectedEvent)];
 
     ImGui::Text("Événement #%d", selectedEvent);
-    ImGui::Checkbox("Actif", &e.enabled);
+    bool stateEdited = ImGui::Checkbox("Actif", &e.enabled);
+    // Écoute pendant la lecture : masque sans toucher à la scène exportée.
+    ImGui::SameLine();
+    stateEdited |= ImGui::Checkbox("Muet", &e.muted);
+    ImGui::SameLine();
+    stateEdited |= ImGui::Checkbox("Solo", &e.solo);
+    if (stateEdited) scene->MarkEventStateEdited(static_cast<size_t>(selectedEvent));
 
-    ImGui::InputFloat("Trigger time (s)", &e.triggerTime, 0.1f, 1.0f, "%.2f");
-    ImGui::DragFloat3("Position", &e.position.x, 0.1f);
+    float triggerTime = e.triggerTime;
+    if (ImGui::InputFloat("Trigger time (s)", &triggerTime, 0.1f, 1.0f, "%.2f")) {
+        scene->SetEventTime(static_cast<size_t>(selectedEvent), triggerTime);
+    }
+    if (ImGui::DragFloat3("Position", &e.position.x, 0.1f)) scene->MarkEdited();
 
     // Template selection by ID
     if (library) {
@@ -43,7 +52,23 @@ void SceneViewPanel::Render()
 
         if (ImGui::Button("Utiliser template actif")) {
             e.templateId = library->GetActiveId();
+            scene->MarkEdited();
+        }
+    }
+
+    // Per-event settings: applied at emission, the template stays shared.
+    if (ImGui::CollapsingHeader("Réglages de l'événement", ImGuiTreeNodeFlags_DefaultOpen)) {
+        TemplateOverride& o = e.overrides;
+        // The particle share changes the predicted occupancy: every tweak is reported.
+        bool edited = ImGui::DragFloat3("Rotation (°)", &o.rotation.x, 1.0f, -180.0f, 180.0f, "%.0f");
+        edited |= ImGui::ColorEdit4("Teinte", &o.tint.x);
+        edited |= ImGui::SliderFloat("Échelle", &o.scale, 0.1f, 3.0f, "%.2f");
+        edited |= ImGui::SliderFloat("Particules", &o.countScale, 0.0f, 1.0f, "%.2f");
+        if (ImGui::Button("Réinitialiser")) {
+            o = TemplateOverride();
+            edited = true;
         }
+        if (edited) scene->MarkEdited();
     }
 }
 
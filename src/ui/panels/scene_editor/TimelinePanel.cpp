@@ -4,6 +4,7 @@
 
 #include "src/scene/Scene.h"
 #include "src/scene/Timeline.h"
+#include "src/fireworks/template/TemplateLibrary.h"
 
 namespace ui {
 namespace panels {
@@ -13,9 +14,46 @@ TimelinePanel::TimelinePanel(Scene* s, Timeline* t, TemplateLibrary* l)
     , timeline(t)
     , library(l)
     , selectedEventIndex(nullptr)
+    , occupancyKey(0)
+    , occupancyValid(false)
+    , showOccupancy(true)
+    , poolCapacity(0)
 {
 }
 
+uint64_t TimelinePanel::ComputeOccupancyKey() const
+{
+    // O(1): scene and template edits each bump their owner's edit version.
+    uint64_t h = 1469598103934665603ULL; // FNV-1a
+    auto mix = [&h](uint64_t v) {
+        for (int b = 0; b < 8; ++b) {
+            h ^= (v >> (8 * b)) & 0xFFu;
+            h *= 1099511628211ULL;
+        }
+    };
+
+    mix(scene->GetEditVersion());
+    mix(library ? library->GetEditVersion() : 0u);
+    mix(static_cast<uint64_t>(poolCapacity));
+    return h;
+}
+
+void TimelinePanel::UpdateOccupancy()
+{
+    if (!showOccupancy || !library) {
+        scrubber.SetOccupancy(nullptr);
+        return;
+    }
+
+    const uint64_t key = ComputeOccupancyKey();
+    if (!occupancyValid || key != occupancyKey) {
+        occupancy = predictor.Analyze(*scene, *library, poolCapacity);
+        occupancyKey = key;
+        occupancyValid = true;
+    }
+    scrubber.SetOccupancy(&occupancy);
+}
+
 void TimelinePanel::FocusEvent(int eventIndex)
 {
     if (!scene || !timeline) return;
@@ -71,6 +109,26 @@ void TimelinePanel::Render()
         if (selectedEventIndex) *selectedEventIndex = -1;
     }
 
+    ImGui::SameLine();
+    ImGui::Checkbox("Occupation", &showOccupancy);
+
+    UpdateOccupancy();
+    if (showOccupancy && occupancyValid) {
+        const ImVec4 color = occupancy.exceedsCapacity ? ImVec4(1.0f, 0.45f, 0.4f, 1.0f) : ImVec4(0.6f, 0.8f, 0.7f, 1.0f);
+        ImGui::TextColored(color, "Pic prévu: %.0f particules à %.1fs (capacité %zu, suggérée %zu) - %.2f ms",
+            occupancy.peakParticles, occupancy.peakTime, occupancy.capacity, occupancy.suggestedCapacity, occupancy.analyzeMs);
+    }
+
+    if (library) {
+        lifetimes.Refresh(*scene, *library);
+        scrubber.SetLifetimes(&lifetimes);
+        const size_t live = lifetimes.ForEachAlive(timeline->GetTime(), [](size_t) {});
+        ImGui::TextDisabled("Cues actives à %.2fs: %zu", timeline->GetTime(), live);
+    }
+    else {
+        scrubber.SetLifetimes(nullptr);
+    }
+
     ImGui::Separator();
 
     // Interactive editor (video-editor-like) for playhead and events.
@@ -4,6 +4,11 @@ class Scene;
 class Timeline;
 class TemplateLibrary;
 
+#include <cstddef>
+#include <cstdint>
+
+#include "src/scene/EventLifetimeIndex.h"
+#include "src/scene/OccupancyPredictor.h"
 #include "src/ui/widgets/TimelineScrubber.h"
 
 namespace ui {
@@ -18,6 +23,8 @@ public:
     void SetTimeline(Timeline* t) { timeline = t; }
     void SetTemplateLibrary(TemplateLibrary* l) { library = l; }
     void SetSelectedEventIndexPtr(int* p) { selectedEventIndex = p; }
+    // Capacity the predicted occupancy is checked against (0 = unknown).
+    void SetPoolCapacity(size_t capacity) { poolCapacity = capacity; }
 
     // Called by external UI (e.g., inspector) to jump to a specific event.
     void FocusEvent(int eventIndex);
@@ -25,11 +32,25 @@ public:
     void Render();
 
 private:
+    // Re-runs the occupancy analysis when events, templates or capacity changed.
+    void UpdateOccupancy();
+    uint64_t ComputeOccupancyKey() const;
+
     Scene* scene;
     Timeline* timeline;
     TemplateLibrary* library;
     int* selectedEventIndex;
     TimelineScrubber scrubber;
+
+    OccupancyPredictor predictor;
+    OccupancyPredictor::Result occupancy;
+    uint64_t occupancyKey;
+    bool occupancyValid;
+    bool showOccupancy;
+    size_t poolCapacity;
+
+    // Event lifetimes: bar lengths, overlaps with the selection, cues live at the playhead.
+    EventLifetimeIndex lifetimes;
 };
 
 } // namespace panels
@@ -5,6 +5,7 @@
 
 #include <imgui.h>
 
+#include "../../../fireworks/particle/ParticlePool.h"
 #include "../../../fireworks/template/BranchDescriptor.h"
 
 namespace ui {
@@ -50,68 +51,77 @@ bool TemplatePropertiesPanel::detectAndNotifyChanges() noexcept
 {
     if (!fireworkTemplate) return false;
 
-    bool changed = false;
+    // Chaque groupe ne recalcule que son étape (voir FireworkTemplate::UpdateBranches).
+    bool layoutChanged = false;
+    bool rotationChanged = false;
+    bool paramsChanged = false;
 
     // Zone
-    changed |= (fireworkTemplateSnapshot.zoneAzimuthMin != fireworkTemplate->zoneAzimuthMin);
-    changed |= (fireworkTemplateSnapshot.zoneAzimuthMax != fireworkTemplate->zoneAzimuthMax);
-    changed |= (fireworkTemplateSnapshot.zoneElevationMin != fireworkTemplate->zoneElevationMin);
-    changed |= (fireworkTemplateSnapshot.zoneElevationMax != fireworkTemplate->zoneElevationMax);
+    layoutChanged |= (fireworkTemplateSnapshot.zoneAzimuthMin != fireworkTemplate->zoneAzimuthMin);
+    layoutChanged |= (fireworkTemplateSnapshot.zoneAzimuthMax != fireworkTemplate->zoneAzimuthMax);
+    layoutChanged |= (fireworkTemplateSnapshot.zoneElevationMin != fireworkTemplate->zoneElevationMin);
+    layoutChanged |= (fireworkTemplateSnapshot.zoneElevationMax != fireworkTemplate->zoneElevationMax);
 
     // Orientation
-    changed |= (fireworkTemplateSnapshot.worldRotation != fireworkTemplate->worldRotation);
+    rotationChanged |= (fireworkTemplateSnapshot.worldRotation != fireworkTemplate->worldRotation);
 
     // Grid
-    changed |= (fireworkTemplateSnapshot.layout.gridX != fireworkTemplate->layout.gridX);
-    changed |= (fireworkTemplateSnapshot.layout.gridY != fireworkTemplate->layout.gridY);
-    changed |= (fireworkTemplateSnapshot.layout.staggered != fireworkTemplate->layout.staggered);
-    changed |= (fireworkTemplateSnapshot.layout.randomness != fireworkTemplate->layout.randomness);
+    layoutChanged |= (fireworkTemplateSnapshot.layout.gridX != fireworkTemplate->layout.gridX);
+    layoutChanged |= (fireworkTemplateSnapshot.layout.gridY != fireworkTemplate->layout.gridY);
+    layoutChanged |= (fireworkTemplateSnapshot.layout.staggered != fireworkTemplate->layout.staggered);
+    layoutChanged |= (fireworkTemplateSnapshot.layout.randomness != fireworkTemplate->layout.randomness);
 
     // Branch physics
-    changed |= (fireworkTemplateSnapshot.branchTemplate.initialSpeed != fireworkTemplate->branchTemplate.initialSpeed);
-    changed |= (fireworkTemplateSnapshot.branchTemplate.speedVariance != fireworkTemplate->branchTemplate.speedVariance);
-    changed |= (fireworkTemplateSnapshot.branchTemplate.damping != fireworkTemplate->branchTemplate.damping);
-    changed |= (fireworkTemplateSnapshot.branchTemplate.dampingVariance != fireworkTemplate->branchTemplate.dampingVariance);
-    changed |= (fireworkTemplateSnapshot.branchTemplate.gravityScale != fireworkTemplate->branchTemplate.gravityScale);
-    changed |= (fireworkTemplateSnapshot.branchTemplate.updraft != fireworkTemplate->branchTemplate.updraft);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.initialSpeed != fireworkTemplate->branchTemplate.initialSpeed);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.speedVariance != fireworkTemplate->branchTemplate.speedVariance);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.damping != fireworkTemplate->branchTemplate.damping);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.dampingVariance != fireworkTemplate->branchTemplate.dampingVariance);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.gravityScale != fireworkTemplate->branchTemplate.gravityScale);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.updraft != fireworkTemplate->branchTemplate.updraft);
 
     // Visual / counts
-    changed |= (fireworkTemplateSnapshot.branchTemplate.particlesPerBranch != fireworkTemplate->branchTemplate.particlesPerBranch);
-    changed |= (fireworkTemplateSnapshot.branchTemplate.emissionDuration != fireworkTemplate->branchTemplate.emissionDuration);
-    changed |= (fireworkTemplateSnapshot.branchTemplate.particleSize != fireworkTemplate->branchTemplate.particleSize);
-    changed |= (fireworkTemplateSnapshot.branchTemplate.sizeVariance != fireworkTemplate->branchTemplate.sizeVariance);
-    changed |= (fireworkTemplateSnapshot.branchTemplate.lifetime != fireworkTemplate->branchTemplate.lifetime);
-    changed |= (fireworkTemplateSnapshot.branchTemplate.shapeId != fireworkTemplate->branchTemplate.shapeId);
-    changed |= (fireworkTemplateSnapshot.branchTemplate.angularSpread != fireworkTemplate->branchTemplate.angularSpread);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.particlesPerBranch != fireworkTemplate->branchTemplate.particlesPerBranch);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.emissionDuration != fireworkTemplate->branchTemplate.emissionDuration);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.particleSize != fireworkTemplate->branchTemplate.particleSize);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.sizeVariance != fireworkTemplate->branchTemplate.sizeVariance);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.lifetime != fireworkTemplate->branchTemplate.lifetime);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.shapeId != fireworkTemplate->branchTemplate.shapeId);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.angularSpread != fireworkTemplate->branchTemplate.angularSpread);
 
     // Fade
-    changed |= (fireworkTemplateSnapshot.branchTemplate.shouldFade != fireworkTemplate->branchTemplate.shouldFade);
-    changed |= (fireworkTemplateSnapshot.branchTemplate.fadeStartRatio != fireworkTemplate->branchTemplate.fadeStartRatio);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.shouldFade != fireworkTemplate->branchTemplate.shouldFade);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.fadeStartRatio != fireworkTemplate->branchTemplate.fadeStartRatio);
 
     // Visual family / trails
-    changed |= (fireworkTemplateSnapshot.branchTemplate.visualMode != fireworkTemplate->branchTemplate.visualMode);
-    changed |= (fireworkTemplateSnapshot.branchTemplate.trailEnabled != fireworkTemplate->branchTemplate.trailEnabled);
-    changed |= (fireworkTemplateSnapshot.branchTemplate.trailWidth != fireworkTemplate->branchTemplate.trailWidth);
-    changed |= (fireworkTemplateSnapshot.branchTemplate.trailDuration != fireworkTemplate->branchTemplate.trailDuration);
-    changed |= (fireworkTemplateSnapshot.branchTemplate.trailOpacity != fireworkTemplate->branchTemplate.trailOpacity);
-    changed |= (fireworkTemplateSnapshot.branchTemplate.trailFalloffPow != fireworkTemplate->branchTemplate.trailFalloffPow);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.visualMode != fireworkTemplate->branchTemplate.visualMode);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.trailEnabled != fireworkTemplate->branchTemplate.trailEnabled);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.trailWidth != fireworkTemplate->branchTemplate.trailWidth);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.trailDuration != fireworkTemplate->branchTemplate.trailDuration);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.trailOpacity != fireworkTemplate->branchTemplate.trailOpacity);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.trailFalloffPow != fireworkTemplate->branchTemplate.trailFalloffPow);
 
     // Front density & sparkle tweaks
-    changed |= (fireworkTemplateSnapshot.branchTemplate.frontPortion != fireworkTemplate->branchTemplate.frontPortion);
-    changed |= (fireworkTemplateSnapshot.branchTemplate.frontSpeedBias != fireworkTemplate->branchTemplate.frontSpeedBias);
-    changed |= (fireworkTemplateSnapshot.branchTemplate.backSpeedScale != fireworkTemplate->branchTemplate.backSpeedScale);
-    changed |= (fireworkTemplateSnapshot.branchTemplate.sparkleSpeedJitter != fireworkTemplate->branchTemplate.sparkleSpeedJitter);
-    changed |= (fireworkTemplateSnapshot.branchTemplate.sparkleSpreadMult != fireworkTemplate->branchTemplate.sparkleSpreadMult);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.frontPortion != fireworkTemplate->branchTemplate.frontPortion);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.frontSpeedBias != fireworkTemplate->branchTemplate.frontSpeedBias);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.backSpeedScale != fireworkTemplate->branchTemplate.backSpeedScale);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.sparkleSpeedJitter != fireworkTemplate->branchTemplate.sparkleSpeedJitter);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.sparkleSpreadMult != fireworkTemplate->branchTemplate.sparkleSpreadMult);
 
     // Extensions (even if runtime not wired yet, UI should be deterministic)
-    changed |= (fireworkTemplateSnapshot.branchTemplate.smokeAmount != fireworkTemplate->branchTemplate.smokeAmount);
-    changed |= (fireworkTemplateSnapshot.branchTemplate.recursionDepth != fireworkTemplate->branchTemplate.recursionDepth);
-    changed |= (fireworkTemplateSnapshot.branchTemplate.recursionProb != fireworkTemplate->branchTemplate.recursionProb);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.smokeAmount != fireworkTemplate->branchTemplate.smokeAmount);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.recursionDepth != fireworkTemplate->branchTemplate.recursionDepth);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.recursionProb != fireworkTemplate->branchTemplate.recursionProb);
+    paramsChanged |= (fireworkTemplateSnapshot.branchTemplate.recursionBudget != fireworkTemplate->branchTemplate.recursionBudget);
 
-    if (!changed) return false;
+    if (!layoutChanged && !rotationChanged && !paramsChanged) return false;
 
     takeSnapshot();
-    fireworkTemplate->RegenerateBranches();
+    uint32_t dirty = 0;
+    if (layoutChanged) dirty |= FireworkTemplate::DirtyLayout;
+    if (rotationChanged) dirty |= FireworkTemplate::DirtyRotation;
+    if (paramsChanged) dirty |= FireworkTemplate::DirtyParams;
+    // Appliqué une fois par frame par TemplateLibrary::UpdateDirtyBranches().
+    fireworkTemplate->MarkDirty(dirty);
 
     if (onChanged) {
         onChanged(*fireworkTemplate);
@@ -272,6 +282,20 @@ void TemplatePropertiesPanel::Render() noexcept
             ImGui::SliderFloat("Smoke amount", &fireworkTemplate->branchTemplate.smokeAmount, 0.0f, 1.0f, "%.2f");
             ImGui::DragInt("Recursion depth", &fireworkTemplate->branchTemplate.recursionDepth, 1.0f, 0, 8);
             ImGui::SliderFloat("Recursion prob", &fireworkTemplate->branchTemplate.recursionProb, 0.0f, 1.0f, "%.2f");
+            ImGui::DragInt("Particle budget", &fireworkTemplate->branchTemplate.recursionBudget, 100.0f, 0, 2000000,
+                fireworkTemplate->branchTemplate.recursionBudget > 0 ? "%d" : "illimité");
+            if (fireworkTemplate->branchTemplate.recursionBudget < 0) fireworkTemplate->branchTemplate.recursionBudget = 0;
+
+            // Coût par obus (version courante des branches)
+            const FireworkTemplate::ParticleCost& cost = fireworkTemplate->GetParticleCost();
+            ImGui::Separator();
+            ImGui::Text("Coût par obus: %.0f attendu / %.0f pire cas", cost.Expected(), cost.WorstCase());
+            ImGui::Text("  primaires %.0f, fumée %.0f, récursion %.0f (pire %.0f)",
+                cost.primaries, cost.smoke, cost.recursionExpected, cost.recursionWorst);
+            if (cost.budgetLimited) {
+                ImGui::TextColored(ImVec4(1.0f, 0.75f, 0.35f, 1.0f), "Budget: %.2f étincelles par gerbe (au lieu de %d)",
+                    cost.childrenPerBurst, ParticlePool::kRecursionChildren);
+            }
 
             ImGui::EndTabItem();
         }
@@ -9,7 +9,7 @@ MenuBar::MenuBar(Callbacks cb)
 {
 }
 
-void MenuBar::Render(EditorMode mode, bool* showDemoWindow)
+void MenuBar::Render(EditorMode mode, bool* showDemoWindow, bool* showProfiler, bool* showOverdraw)
 {
     if (!ImGui::BeginMainMenuBar()) return;
 
@@ -57,6 +57,9 @@ void MenuBar::Render(EditorMode mode, bool* showDemoWindow)
 
     if (ImGui::BeginMenu("View")) {
         if (showDemoWindow) ImGui::MenuItem("Show Demo Window", nullptr, showDemoWindow);
+        if (showProfiler || showOverdraw) ImGui::Separator();
+        if (showProfiler) ImGui::MenuItem("Profiler", nullptr, showProfiler);
+        if (showOverdraw) ImGui::MenuItem("Overdraw Heatmap", nullptr, showOverdraw);
         ImGui::EndMenu();
     }
 
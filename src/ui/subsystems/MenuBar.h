@@ -20,7 +20,8 @@ public:
 
     explicit MenuBar(Callbacks cb);
 
-    void Render(EditorMode currentMode, bool* showDemoWindow);
+    // Debug window toggles are optional (nullptr hides the entry).
+    void Render(EditorMode currentMode, bool* showDemoWindow, bool* showProfiler = nullptr, bool* showOverdraw = nullptr);
 
 private:
     Callbacks callbacks;
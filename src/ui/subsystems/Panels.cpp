@@ -37,6 +37,12 @@ void Panels::SetContexts(TemplateLibrary* library, Scene* scene, Timeline* timel
     timelineCtx = timeline;
 }
 
+void Panels::SetPoolCapacity(size_t capacity)
+{
+    poolCapacity = capacity;
+    if (timelinePanel) timelinePanel->SetPoolCapacity(capacity);
+}
+
 void Panels::CreateTemplatePanels(TemplateLibrary* library)
 {
     templateLibraryCtx = library;
@@ -53,7 +59,7 @@ void Panels::CreateTemplatePanels(TemplateLibrary* library)
     layoutPanel = active ? new ui::panels::LayoutEditorPanel(&active->layout) : nullptr;
     if (layoutPanel && active) {
         layoutPanel->SetOnLayoutChangedCallback([active](const BranchLayout&) {
-            active->RegenerateBranches();
+            active->MarkDirty(FireworkTemplate::DirtyLayout);
         });
     }
 
@@ -61,7 +67,7 @@ void Panels::CreateTemplatePanels(TemplateLibrary* library)
     colorSchemePanel = active ? new ui::panels::ColorSchemePanel(&active->colorScheme) : nullptr;
     if (colorSchemePanel && active) {
         colorSchemePanel->SetOnColorSchemeChangedCallback([active](const ColorScheme&) {
-            active->RegenerateBranches();
+            active->MarkDirty(FireworkTemplate::DirtyColors);
         });
     }
 
@@ -73,13 +79,13 @@ void Panels::CreateTemplatePanels(TemplateLibrary* library)
             delete layoutPanel;
             layoutPanel = a ? new ui::panels::LayoutEditorPanel(&a->layout) : nullptr;
             if (layoutPanel && a) {
-                layoutPanel->SetOnLayoutChangedCallback([a](const BranchLayout&) { a->RegenerateBranches(); });
+                layoutPanel->SetOnLayoutChangedCallback([a](const BranchLayout&) { a->MarkDirty(FireworkTemplate::DirtyLayout); });
             }
 
             delete colorSchemePanel;
             colorSchemePanel = a ? new ui::panels::ColorSchemePanel(&a->colorScheme) : nullptr;
             if (colorSchemePanel && a) {
-                colorSchemePanel->SetOnColorSchemeChangedCallback([a](const ColorScheme&) { a->RegenerateBranches(); });
+                colorSchemePanel->SetOnColorSchemeChangedCallback([a](const ColorScheme&) { a->MarkDirty(FireworkTemplate::DirtyColors); });
             }
         });
     }
@@ -101,6 +107,7 @@ void Panels::CreateScenePanels(Scene* scene, Timeline* timeline, TemplateLibrary
     timelinePanel = new ui::panels::TimelinePanel(scene, timeline, library);
 
     if (timelinePanel) timelinePanel->SetSelectedEventIndexPtr(&selectedSceneEventIndex);
+    if (timelinePanel) timelinePanel->SetPoolCapacity(poolCapacity);
     if (fireworkListPanel) fireworkListPanel->SetSelectedEventIndexPtr(&selectedSceneEventIndex);
 
     if (fireworkListPanel) {
@@ -122,13 +129,13 @@ void Panels::RefreshTemplatePanelsFromActive()
     delete layoutPanel; layoutPanel = nullptr;
     layoutPanel = a ? new ui::panels::LayoutEditorPanel(&a->layout) : nullptr;
     if (layoutPanel && a) {
-        layoutPanel->SetOnLayoutChangedCallback([a](const BranchLayout&) { a->RegenerateBranches(); });
+        layoutPanel->SetOnLayoutChangedCallback([a](const BranchLayout&) { a->MarkDirty(FireworkTemplate::DirtyLayout); });
     }
 
     delete colorSchemePanel; colorSchemePanel = nullptr;
     colorSchemePanel = a ? new ui::panels::ColorSchemePanel(&a->colorScheme) : nullptr;
     if (colorSchemePanel && a) {
-        colorSchemePanel->SetOnColorSchemeChangedCallback([a](const ColorScheme&) { a->RegenerateBranches(); });
+        colorSchemePanel->SetOnColorSchemeChangedCallback([a](const ColorScheme&) { a->MarkDirty(FireworkTemplate::DirtyColors); });
     }
 }
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 #include "src/ui/EditorMode.h"
 
 namespace ui::panels {
@@ -57,6 +59,9 @@ public:
     // Contexts are used for refresh operations.
     void SetContexts(TemplateLibrary* library, Scene* scene, Timeline* timeline);
 
+    // Pool capacity shown against the predicted occupancy (kept across scene panel rebuilds).
+    void SetPoolCapacity(size_t capacity);
+
 private:
     void renderTemplate();
     void renderScene();
@@ -64,6 +69,7 @@ private:
     TemplateLibrary* templateLibraryCtx = nullptr;
     Scene* sceneCtx = nullptr;
     Timeline* timelineCtx = nullptr;
+    size_t poolCapacity = 0;
 
     // Template editor panels
     ui::panels::TemplatePropertiesPanel* templatePanel = nullptr;
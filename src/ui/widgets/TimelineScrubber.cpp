@@ -28,24 +28,11 @@ TimelineScrubber::TimelineScrubber()
     , snapEnabled(true)
     , snapSeconds(0.1f)
     , pendingFocusTimeSeconds(-1.0f)
+    , occupancy(nullptr)
+    , lifetimes(nullptr)
 {
 }
 
-static float EstimateTemplateDurationSeconds(const FireworkTemplate* t)
-{
-    if (!t) return 0.05f;
-
-    float d = 0.0f;
-    d += std::max(0.0f, t->branchTemplate.emissionDuration);
-    d += std::max(0.0f, t->branchTemplate.lifetime);
-
-    if (t->branchTemplate.trailEnabled) {
-        d += std::max(0.0f, t->branchTemplate.trailDuration);
-    }
-
-    return std::max(d, 0.05f);
-}
-
 void TimelineScrubber::RequestFocusTime(float tSeconds)
 {
     pendingFocusTimeSeconds = tSeconds;
@@ -125,6 +112,50 @@ bool TimelineScrubber::Render(Scene* scene, Timeline* timeline, TemplateLibrary*
         dl->AddText(ImVec2(x + 4, p0.y + 2), IM_COL32(150, 160, 180, 255), buf);
     }
 
+    // Predicted occupancy (background): scaled to the pool capacity, or to the peak if higher.
+    if (occupancy && !occupancy->occupancy.empty() && occupancy->peakParticles > 0.0f) {
+        const std::vector<float>& curve = occupancy->occupancy;
+        const float bin = occupancy->binSeconds;
+        const float top = std::max(occupancy->peakParticles, static_cast<float>(occupancy->capacity));
+        const float areaTop = p0.y + headerHeight;
+        const float areaHeight = p1.y - areaTop - 2.0f;
+        auto ValueToY = [&](float v) { return p1.y - 2.0f - areaHeight * (v / top); };
+
+        // One column per 2 px, showing the highest sample under it.
+        const float columnPx = 2.0f;
+        for (float x = p0.x; x < p1.x; x += columnPx) {
+            const float ta = XToTime(x);
+            const float tb = XToTime(x + columnPx);
+            if (tb < 0.0f) continue;
+            size_t a = static_cast<size_t>(std::max(0.0f, ta) / bin);
+            const size_t b = std::min(curve.size(), static_cast<size_t>(std::max(0.0f, tb) / bin) + 1);
+            if (a >= curve.size()) break;
+            float v = 0.0f;
+            for (; a < b; ++a) v = std::max(v, curve[a]);
+            if (v <= 0.0f) continue;
+
+            const bool over = occupancy->capacity > 0 && v > static_cast<float>(occupancy->capacity);
+            dl->AddRectFilled(ImVec2(x, ValueToY(v)), ImVec2(x + columnPx, p1.y - 2.0f),
+                over ? IM_COL32(200, 70, 60, 110) : IM_COL32(70, 130, 110, 90));
+        }
+
+        if (occupancy->capacity > 0) {
+            const float y = ValueToY(static_cast<float>(occupancy->capacity));
+            dl->AddLine(ImVec2(p0.x, y), ImVec2(p1.x, y), IM_COL32(220, 90, 80, 200));
+        }
+
+        for (const auto& peak : occupancy->peaks) {
+            const float x = TimeToX(peak.time);
+            if (x < p0.x || x > p1.x) continue;
+            const float y = ValueToY(peak.particles);
+            dl->AddTriangleFilled(ImVec2(x - 4.0f, y - 8.0f), ImVec2(x + 4.0f, y - 8.0f), ImVec2(x, y - 1.0f),
+                IM_COL32(255, 200, 90, 230));
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "%.0fk", peak.particles / 1000.0f);
+            dl->AddText(ImVec2(x + 5.0f, y - 16.0f), IM_COL32(255, 210, 120, 230), buf);
+        }
+    }
+
     const ImVec2 mouse = ImGui::GetMousePos();
     const bool hovered = ImGui::IsWindowHovered();
 
@@ -162,6 +193,16 @@ bool TimelineScrubber::Render(Scene* scene, Timeline* timeline, TemplateLibrary*
     static int draggingEvent = -1;
     int hoveredEvent = -1;
 
+    // Cues sharing the screen with the selected one: O(log n + k) through the lifetime index.
+    overlapsSelection.assign(events.size(), 0);
+    if (lifetimes && selectedEventIndex && *selectedEventIndex >= 0) {
+        if (const EventLifetimeIndex::Interval* sel = lifetimes->Find(static_cast<size_t>(*selectedEventIndex))) {
+            lifetimes->ForEachOverlapping(sel->start, sel->end, [&](size_t index) {
+                if (index < overlapsSelection.size() && static_cast<int>(index) != *selectedEventIndex) overlapsSelection[index] = 1;
+            });
+        }
+    }
+
     // Rows + events
     for (int i = 0; i < (int)events.size(); ++i) {
         const FireworkEvent& e = events[i];
@@ -177,10 +218,13 @@ bool TimelineScrubber::Render(Scene* scene, Timeline* timeline, TemplateLibrary*
         // Draw row background first
         dl->AddRectFilled(ImVec2(p0.x, rowY0), ImVec2(p1.x, rowY1), rowCol);
 
-        // Segment duration
+        // Segment duration: trigger to last particle (smoke and recursion included)
         float dur = 0.2f;
-        if (library) {
-            dur = EstimateTemplateDurationSeconds(library->Get(e.templateId));
+        if (const EventLifetimeIndex::Interval* interval = lifetimes ? lifetimes->Find(static_cast<size_t>(i)) : nullptr) {
+            dur = interval->end - interval->start;
+        }
+        else if (library) {
+            dur = EventLifetimeIndex::TemplateLifetime(library->Get(e.templateId));
         }
 
         float x0 = TimeToX(e.triggerTime);
@@ -216,9 +260,16 @@ bool TimelineScrubber::Render(Scene* scene, Timeline* timeline, TemplateLibrary*
 
         if (!e.enabled)
             col = IM_COL32(130, 130, 130, 180);
+        else if (e.muted)
+            col = IM_COL32(90, 100, 120, 200);
+        else if (e.solo)
+            col = IM_COL32(255, 210, 110, 230);
 
         dl->AddRectFilled(a, b, col, 3.0f);
-        dl->AddRect(a, b, IM_COL32(0, 0, 0, 180), 3.0f);
+        if (overlapsSelection[static_cast<size_t>(i)])
+            dl->AddRect(a, b, IM_COL32(255, 170, 60, 255), 3.0f, 0, 2.0f);
+        else
+            dl->AddRect(a, b, IM_COL32(0, 0, 0, 180), 3.0f);
 
         const char* name = library ? library->GetName(e.templateId) : nullptr;
         if (!name || !name[0]) name = e.label.c_str();
@@ -264,7 +315,7 @@ bool TimelineScrubber::Render(Scene* scene, Timeline* timeline, TemplateLibrary*
         float t = XToTime(mouse.x);
         t = std::clamp(t, 0.0f, duration);
         if (snapEnabled) t = SnapTo(t, snapSeconds);
-        scene->GetEvents()[draggingEvent].triggerTime = t;
+        scene->SetEventTime(static_cast<size_t>(draggingEvent), t);
         changed = true;
     }
 
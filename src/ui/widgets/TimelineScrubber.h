@@ -1,6 +1,11 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "src/scene/EventLifetimeIndex.h"
+#include "src/scene/OccupancyPredictor.h"
 
 class Scene;
 class Timeline;
@@ -22,6 +27,13 @@ public:
     // Returns true if it changed the timeline time or edited events.
     bool Render(Scene* scene, Timeline* timeline, TemplateLibrary* library, int* selectedEventIndex);
 
+    // Predicted occupancy drawn behind the events (nullptr hides it). Not owned.
+    void SetOccupancy(const OccupancyPredictor::Result* r) { occupancy = r; }
+
+    // Event lifetimes (bar lengths, overlap highlight of the selection). Not owned; must be
+    // refreshed for the scene passed to Render().
+    void SetLifetimes(const EventLifetimeIndex* index) { lifetimes = index; }
+
 private:
     float pixelsPerSecond;
     float scrollSeconds;
@@ -30,4 +42,10 @@ private:
     float snapSeconds;
 
     float pendingFocusTimeSeconds;
+
+    const OccupancyPredictor::Result* occupancy;
+    const EventLifetimeIndex* lifetimes;
+
+    // Per event: 1 if it overlaps the selected event (rebuilt every Render()).
+    std::vector<uint8_t> overlapsSelection;
 };